@@ -0,0 +1,96 @@
+#include "legacy_scheduler.hpp"
+
+#include <andromeda/util/idgen.hpp>
+
+#include <algorithm>
+
+namespace andromeda::bench {
+
+LegacyTaskScheduler::LegacyTaskScheduler(uint32_t num_threads) {
+    auto thread_loop_function = [this](uint32_t thread_index) {
+        while (true) {
+            Task job{};
+            {
+                std::unique_lock lock{task_mutex};
+                cv.wait(lock, [this]() {
+                    return !pending_tasks.empty() || terminate;
+                });
+
+                if (pending_tasks.empty() && terminate) { break; }
+
+                for (auto it = pending_tasks.begin(); it != pending_tasks.end(); ++it) {
+                    bool dependencies_complete = true;
+                    for (thread::task_id dep: it->dependencies) {
+                        if (is_running(dep) || is_pending(dep)) {
+                            dependencies_complete = false;
+                            break;
+                        }
+                    }
+                    if (dependencies_complete) {
+                        job = std::move(*it);
+                        pending_tasks.erase(it);
+                        running_tasks.push_back(job);
+                        break;
+                    }
+                }
+            }
+
+            if (job.function) {
+                job.function(thread_index);
+                {
+                    std::unique_lock lock{task_mutex};
+                    running_tasks.erase(std::remove_if(running_tasks.begin(), running_tasks.end(),
+                                                       [&job](Task const& t) {
+                                                           return job.id == t.id;
+                                                       }), running_tasks.end());
+                }
+                cv.notify_all();
+            }
+        }
+    };
+
+    threads.reserve(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread{thread_loop_function, i});
+    }
+}
+
+LegacyTaskScheduler::~LegacyTaskScheduler() {
+    if (!stopped) {
+        shutdown();
+    }
+}
+
+thread::task_id LegacyTaskScheduler::schedule(std::function<void(uint32_t)> function, std::vector<thread::task_id> dependencies) {
+    thread::task_id id = IDGen<Task, thread::task_id>::next();
+    {
+        std::unique_lock lock{task_mutex};
+        pending_tasks.push_back(Task{
+            .id = id,
+            .function = std::move(function),
+            .dependencies = std::move(dependencies)
+        });
+        cv.notify_one();
+    }
+    return id;
+}
+
+void LegacyTaskScheduler::shutdown() {
+    terminate = true;
+    cv.notify_all();
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+    threads.clear();
+    stopped = true;
+}
+
+bool LegacyTaskScheduler::is_running(thread::task_id task) const {
+    return std::any_of(running_tasks.begin(), running_tasks.end(), [task](Task const& t) { return t.id == task; });
+}
+
+bool LegacyTaskScheduler::is_pending(thread::task_id task) const {
+    return std::any_of(pending_tasks.begin(), pending_tasks.end(), [task](Task const& t) { return t.id == task; });
+}
+
+} // namespace andromeda::bench
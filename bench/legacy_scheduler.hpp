@@ -0,0 +1,48 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace andromeda::bench {
+
+/**
+ * @class LegacyTaskScheduler
+ * @brief The task scheduler as it was before the work-stealing implementation: a single pending task list protected
+ *        by one mutex, scanned linearly by every worker. Only kept as a baseline for the scheduler benchmark.
+ */
+class LegacyTaskScheduler {
+public:
+    explicit LegacyTaskScheduler(uint32_t num_threads);
+
+    ~LegacyTaskScheduler();
+
+    thread::task_id schedule(std::function<void(uint32_t)> function, std::vector<thread::task_id> dependencies = {});
+
+    void shutdown();
+
+private:
+    struct Task {
+        thread::task_id id;
+        std::function<void(uint32_t)> function;
+        std::vector<thread::task_id> dependencies;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<Task> pending_tasks;
+    std::vector<Task> running_tasks;
+    std::mutex task_mutex;
+    std::condition_variable cv;
+    std::atomic<bool> terminate = false;
+    std::atomic<bool> stopped = false;
+
+    bool is_running(thread::task_id task) const;
+    bool is_pending(thread::task_id task) const;
+};
+
+} // namespace andromeda::bench
@@ -0,0 +1,151 @@
+// Stress benchmark for the task scheduler. Runs the same workloads on the work-stealing thread::TaskScheduler and on
+// the previous single-queue implementation, and reports the throughput in tasks per second.
+//
+// Usage: andromeda_scheduler_bench [task_count] [thread_count]
+
+#include <andromeda/app/log.hpp>
+#include <andromeda/thread/scheduler.hpp>
+
+#include "legacy_scheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <vector>
+
+using namespace andromeda;
+
+namespace {
+
+// Small amount of work per task, so the scheduler overhead dominates.
+void busy_work(std::atomic<uint64_t>& sink) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < 64; ++i) {
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    sink.fetch_add(value & 1, std::memory_order_relaxed);
+}
+
+struct Result {
+    std::string name;
+    uint32_t tasks = 0;
+    double seconds = 0.0;
+};
+
+// All tasks are scheduled from the main thread.
+template<typename Scheduler>
+Result independent_tasks(uint32_t threads, uint32_t count) {
+    Scheduler scheduler{threads};
+    std::atomic<uint64_t> sink = 0;
+    std::latch done{count};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        scheduler.schedule([&sink, &done](uint32_t) {
+            busy_work(sink);
+            done.count_down();
+        });
+    }
+    done.wait();
+    auto const end = std::chrono::steady_clock::now();
+    scheduler.shutdown();
+
+    return Result{"independent", count, std::chrono::duration<double>(end - start).count()};
+}
+
+// A single task spawns all other tasks, like an asset loader scheduling a load for every texture it references.
+template<typename Scheduler>
+Result fan_out(uint32_t threads, uint32_t count) {
+    Scheduler scheduler{threads};
+    std::atomic<uint64_t> sink = 0;
+    std::latch done{count};
+
+    auto const start = std::chrono::steady_clock::now();
+    scheduler.schedule([&scheduler, &sink, &done, count](uint32_t) {
+        for (uint32_t i = 0; i < count - 1; ++i) {
+            scheduler.schedule([&sink, &done](uint32_t) {
+                busy_work(sink);
+                done.count_down();
+            });
+        }
+        done.count_down();
+    });
+    done.wait();
+    auto const end = std::chrono::steady_clock::now();
+    scheduler.shutdown();
+
+    return Result{"fan-out", count, std::chrono::duration<double>(end - start).count()};
+}
+
+// Many short chains of dependent tasks.
+template<typename Scheduler>
+Result dependency_chains(uint32_t threads, uint32_t count) {
+    constexpr uint32_t chain_length = 8;
+    uint32_t const chains = count / chain_length;
+
+    Scheduler scheduler{threads};
+    std::atomic<uint64_t> sink = 0;
+    std::latch done{chains * chain_length};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (uint32_t chain = 0; chain < chains; ++chain) {
+        thread::task_id previous = scheduler.schedule([&sink, &done](uint32_t) {
+            busy_work(sink);
+            done.count_down();
+        });
+        for (uint32_t i = 1; i < chain_length; ++i) {
+            previous = scheduler.schedule([&sink, &done](uint32_t) {
+                busy_work(sink);
+                done.count_down();
+            }, {previous});
+        }
+    }
+    done.wait();
+    auto const end = std::chrono::steady_clock::now();
+    scheduler.shutdown();
+
+    return Result{"chains", chains * chain_length, std::chrono::duration<double>(end - start).count()};
+}
+
+template<typename Scheduler>
+std::vector<Result> run_all(uint32_t threads, uint32_t count) {
+    return {
+        independent_tasks<Scheduler>(threads, count),
+        fan_out<Scheduler>(threads, count),
+        dependency_chains<Scheduler>(threads, count)
+    };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Log log{};
+    impl::_global_log_pointer = &log;
+    // Don't spam the benchmark output with scheduler shutdown messages.
+    log.set_output([](LogLevel lvl, std::string_view str) {
+        if (lvl >= LogLevel::Warning) { std::cerr << str << '\n'; }
+    });
+
+    uint32_t const count = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 20000;
+    uint32_t const hardware_threads = std::max(std::thread::hardware_concurrency(), 2u);
+    uint32_t const threads = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : hardware_threads - 1;
+
+    std::cout << fmt::format("Scheduler benchmark: {} tasks per workload, {} worker threads\n\n", count, threads);
+    std::cout << fmt::format("{:<12} {:>18} {:>18} {:>9}\n", "workload", "legacy (tasks/s)", "stealing (tasks/s)", "speedup");
+
+    std::vector<Result> const legacy = run_all<bench::LegacyTaskScheduler>(threads, count);
+    std::vector<Result> const stealing = run_all<thread::TaskScheduler>(threads, count);
+    for (std::size_t i = 0; i < legacy.size(); ++i) {
+        double const legacy_rate = legacy[i].tasks / legacy[i].seconds;
+        double const stealing_rate = stealing[i].tasks / stealing[i].seconds;
+        std::cout << fmt::format("{:<12} {:>18.0f} {:>18.0f} {:>8.1f}x\n",
+                                 legacy[i].name, legacy_rate, stealing_rate, stealing_rate / legacy_rate);
+    }
+
+    log.flush();
+    return 0;
+}
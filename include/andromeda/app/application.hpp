@@ -2,13 +2,18 @@
 
 #include <andromeda/app/wsi.hpp>
 #include <andromeda/app/log.hpp>
+#include <andromeda/app/startup_timer.hpp>
+#include <andromeda/assets/hot_reload.hpp>
+#include <andromeda/ecs/system_scheduler.hpp>
 #include <andromeda/editor/editor.hpp>
 #include <andromeda/graphics/context.hpp>
 #include <andromeda/graphics/renderer.hpp>
 #include <andromeda/thread/scheduler.hpp>
 #include <andromeda/world.hpp>
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace andromeda {
 
@@ -22,7 +27,8 @@ public:
     /**
      * @brief Create an Application instance.
      * @param argc Amount of command-line arguments.
-     * @param argv Command-line arguments.
+     * @param argv Command-line arguments. Supports --main-thread-budget <milliseconds> to set the time per frame
+     *        spent on tasks handed off to the main thread.
     */
     Application(int argc, char** argv);
 
@@ -33,6 +39,8 @@ public:
     int run();
 
 private:
+    // Measures startup time. This is the first member so it is created before anything else.
+    StartupTimer startup;
     // Used for all application logging
     std::unique_ptr<Log> log;
     // Main application window
@@ -43,10 +51,31 @@ private:
     std::unique_ptr<World> world;
     // The task scheduler
     std::unique_ptr<thread::TaskScheduler> scheduler;
+    // Time per frame spent on non-critical main thread tasks, so background work cannot cause frame spikes.
+    std::chrono::microseconds main_thread_budget{2000};
+    // Per-frame systems operating on the world
+    std::unique_ptr<ecs::SystemScheduler> systems;
     // Editor interface
     std::unique_ptr<editor::Editor> editor;
     // The main rendering interface
     std::unique_ptr<gfx::Renderer> renderer;
+    // Entities loaded by load_scene(), until all of their assets are resident.
+    std::vector<Handle<ecs::entity_t>> loading_scenes;
+    // Reloads assets whose files changed on disk.
+    std::unique_ptr<assets::HotReloader> hot_reloader;
+    // Amount of frames between calls to assets::collect_unused().
+    static constexpr uint64_t collect_interval = 60;
+
+    /**
+     * @brief Starts loading the default scene. Entities are imported into the world once they finish loading.
+     */
+    void load_scene();
+
+    /**
+     * @brief Logs once every asset of the default scene finished loading.
+     * @param frame Index of the current frame.
+     */
+    void report_scene_progress(uint64_t frame);
 };
 
 } // namespace andromeda
\ No newline at end of file
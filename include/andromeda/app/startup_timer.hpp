@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace andromeda {
+
+/**
+ * @class StartupTimer
+ * @brief Records how long each phase of application startup takes. Phases may be recorded from any thread, so phases
+ *        running concurrently on the task scheduler show up with overlapping time ranges in the report.
+ */
+class StartupTimer {
+public:
+    using clock = std::chrono::high_resolution_clock;
+
+    /**
+     * @class Scope
+     * @brief Records a phase from its construction until it is destroyed.
+     */
+    class Scope {
+    public:
+        Scope(StartupTimer& timer, std::string name);
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+        ~Scope();
+
+    private:
+        StartupTimer& timer;
+        std::string name;
+        clock::time_point start;
+    };
+
+    /**
+     * @brief Creates the timer. All phases are reported relative to the moment the timer was created.
+     */
+    StartupTimer();
+
+    /**
+     * @brief Start measuring a phase.
+     * @param name Name of the phase, used in the report.
+     * @return A scope object. The phase ends when this object is destroyed.
+     */
+    [[nodiscard]] Scope measure(std::string name);
+
+    /**
+     * @brief Record a phase that has already ended.
+     * @param name Name of the phase.
+     * @param begin Time point at which the phase started.
+     * @param end Time point at which the phase ended.
+     */
+    void record(std::string name, clock::time_point begin, clock::time_point end);
+
+    /**
+     * @brief Marks that the first frame was presented and writes the startup report to the log.
+     *        Only the first call to this function has an effect.
+     */
+    void first_frame();
+
+private:
+    struct Phase {
+        std::string name;
+        // Both in milliseconds since the timer was created.
+        float start = 0.0f;
+        float end = 0.0f;
+    };
+
+    clock::time_point start;
+    std::mutex mutex;
+    std::vector<Phase> phases;
+    bool reported = false;
+};
+
+} // namespace andromeda
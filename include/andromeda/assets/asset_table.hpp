@@ -0,0 +1,280 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+#include <andromeda/util/handle.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace andromeda {
+namespace assets {
+
+/**
+ * @enum Status
+ * @brief Status of an asset. As long as an asset is in the Pending status it cannot be used.
+*/
+enum class Status {
+    Ready,
+    Pending
+};
+
+namespace impl {
+
+/**
+ * @class AssetTable
+ * @brief Generational slot map storing all assets of one type. A handle holds the index of its asset's slot in the lower
+ *        32 bits, and the generation of that slot in the upper 32 bits. Slots are stored in fixed size chunks that never
+ *        move, so find() is an array index and a generation check, without taking a lock.
+ *
+ *        All other functions modify the table and must be called with the table's lock held, see assets::impl::acquire().
+ *        Erased slots are not reused right away, since other threads may still be reading the asset through a pointer
+ *        they got from find(). Instead they are retired, and only reclaimed after end_frame() was called retire_delay
+ *        times.
+ * @tparam T Type of the assets in the table.
+ */
+template<typename T> requires std::default_initializable<T> && std::movable<T>
+class AssetTable {
+public:
+    struct Slot {
+        // Incremented every time the asset in this slot is erased, invalidating all handles to it.
+        std::atomic<uint32_t> generation = 0;
+        std::atomic<Status> status = Status::Pending;
+        // Only written while the status is Pending, so readers that see Status::Ready can read it without a lock.
+        T data{};
+
+        // The fields below require the table's lock.
+        bool occupied = false;
+        thread::task_id load_task_id = static_cast<thread::task_id>(-1);
+        // Group of the load tasks, cancelled when the asset is unloaded before it is ready.
+        std::optional<thread::task_group> load_group;
+        // Path to the asset file, stored as a normalized absolute path.
+        std::filesystem::path path;
+        // Set for assets owned by the asset system, which are unloaded once nothing uses them. Assets stored with
+        // take() are owned by the caller instead.
+        bool collectable = false;
+        // Amount of retain() calls without a matching release().
+        uint32_t retain_count = 0;
+        // When collect_unused() first found the asset unused, reset as soon as it is used again.
+        std::optional<std::chrono::steady_clock::time_point> unused_since;
+    };
+
+    // Amount of end_frame() calls before an erased slot is reused.
+    static constexpr uint64_t retire_delay = 2;
+
+    AssetTable() = default;
+    AssetTable(AssetTable const&) = delete;
+    AssetTable& operator=(AssetTable const&) = delete;
+
+    ~AssetTable() {
+        for (auto& chunk: chunks) {
+            delete[] chunk.load();
+        }
+    }
+
+    /**
+     * @brief Find the slot of an asset. Lock-free, may be called from any thread.
+     * @param handle Handle to the asset.
+     * @return The slot, or nullptr if the handle is null or the asset was erased.
+     */
+    Slot* find(Handle<T> handle) const {
+        if (!handle) { return nullptr; }
+
+        uint64_t const id = handle.get_id();
+        uint32_t const index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+        uint32_t const chunk = index / chunk_size;
+        if (chunk >= max_chunks) { return nullptr; }
+
+        Slot* slots = chunks[chunk].load(std::memory_order_acquire);
+        if (slots == nullptr) { return nullptr; }
+
+        Slot& slot = slots[index % chunk_size];
+        if (slot.generation.load(std::memory_order_acquire) != static_cast<uint32_t>(id >> 32)) { return nullptr; }
+        return &slot;
+    }
+
+    /**
+     * @brief Insert a new asset.
+     * @param status Status of the new asset.
+     * @param asset The asset to store.
+     * @return Handle to the asset, or a null handle if the table is full.
+     */
+    Handle<T> insert(Status status, T asset) {
+        uint32_t const index = allocate_slot();
+        if (index == no_slot) { return Handle<T>::none; }
+
+        Slot& slot = get_slot(index);
+        slot.occupied = true;
+        slot.data = std::move(asset);
+        slot.status.store(status, std::memory_order_release);
+        return Handle<T>::from_id(make_id(index, slot.generation.load(std::memory_order_relaxed)));
+    }
+
+    /**
+     * @brief Look up the handle of the asset with a path.
+     * @param key Normalized path of the asset.
+     * @return The handle, or a null handle if there is no asset with this path.
+     */
+    Handle<T> find_path(std::string const& key) const {
+        auto it = path_index.find(key);
+        if (it == path_index.end()) { return Handle<T>::none; }
+        return it->second;
+    }
+
+    /**
+     * @brief Set the path of an asset, and register it in the path index.
+     * @param handle Handle to the asset.
+     * @param key Normalized path of the asset.
+     */
+    void set_path(Handle<T> handle, std::string key) {
+        Slot* slot = find(handle);
+        if (slot == nullptr) { return; }
+
+        unregister_path(handle);
+        slot->path = key;
+        path_index.insert_or_assign(std::move(key), handle);
+    }
+
+    /**
+     * @brief Remove an asset from the path index, so looking up its path does not find it anymore. The asset keeps its
+     *        path.
+     * @param handle Handle to the asset.
+     */
+    void unregister_path(Handle<T> handle) {
+        Slot* slot = find(handle);
+        if (slot == nullptr || slot->path.empty()) { return; }
+
+        auto it = path_index.find(slot->path.generic_string());
+        if (it != path_index.end() && it->second == handle) {
+            path_index.erase(it);
+        }
+    }
+
+    /**
+     * @brief Erase an asset. Its handles become invalid right away, but the asset itself is only destroyed once its
+     *        slot is reclaimed.
+     * @param handle Handle to the asset.
+     */
+    void erase(Handle<T> handle) {
+        Slot* slot = find(handle);
+        if (slot == nullptr) { return; }
+
+        unregister_path(handle);
+        slot->occupied = false;
+        slot->generation.fetch_add(1, std::memory_order_release);
+        retired.push_back(Retired{.index = static_cast<uint32_t>(handle.get_id() & 0xFFFFFFFF), .frame = frame});
+    }
+
+    /**
+     * @brief Exchange the assets stored in two ready slots, so each handle refers to the other's asset. Unlike every
+     *        other modification this writes data that lock-free readers may be reading, so it must only be called
+     *        between frames, when no reader can be using a pointer obtained from find().
+     * @param lhs Handle to the first asset.
+     * @param rhs Handle to the second asset.
+     * @return true if the assets were exchanged, false if either handle is invalid or its asset is not ready.
+     */
+    bool swap_data(Handle<T> lhs, Handle<T> rhs) {
+        Slot* first = find(lhs);
+        Slot* second = find(rhs);
+        if (first == nullptr || second == nullptr || first == second) { return false; }
+        if (first->status.load(std::memory_order_relaxed) != Status::Ready
+            || second->status.load(std::memory_order_relaxed) != Status::Ready) {
+            return false;
+        }
+
+        using std::swap;
+        swap(first->data, second->data);
+        return true;
+    }
+
+    /**
+     * @brief Get handles to all assets in the table.
+     */
+    std::vector<Handle<T>> handles() const {
+        std::vector<Handle<T>> result;
+        for (uint32_t index = 0; index < slot_count; ++index) {
+            Slot const& slot = get_slot(index);
+            if (slot.occupied) {
+                result.push_back(Handle<T>::from_id(make_id(index, slot.generation.load(std::memory_order_relaxed))));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Mark the end of a frame. Reclaims the slots that were retired long enough ago that no reader can still be
+     *        using them.
+     */
+    void end_frame() {
+        ++frame;
+        while (!retired.empty() && retired.front().frame + retire_delay <= frame) {
+            Slot& slot = get_slot(retired.front().index);
+            slot.data = T{};
+            slot.status.store(Status::Pending, std::memory_order_relaxed);
+            slot.load_task_id = static_cast<thread::task_id>(-1);
+            slot.load_group.reset();
+            slot.path.clear();
+            slot.collectable = false;
+            slot.retain_count = 0;
+            slot.unused_since.reset();
+            free_slots.push_back(retired.front().index);
+            retired.pop_front();
+        }
+    }
+
+private:
+    static constexpr uint32_t no_slot = static_cast<uint32_t>(-1);
+    static constexpr uint32_t chunk_size = 1024;
+    static constexpr uint32_t max_chunks = 1024;
+
+    struct Retired {
+        uint32_t index = 0;
+        uint64_t frame = 0;
+    };
+
+    std::array<std::atomic<Slot*>, max_chunks> chunks{};
+    uint32_t slot_count = 0;
+    std::vector<uint32_t> free_slots;
+    // Erased slots, in the order they were erased.
+    std::deque<Retired> retired;
+    uint64_t frame = 0;
+    // Maps the normalized path of every asset that has one to its handle, so the same file is never loaded twice.
+    std::unordered_map<std::string, Handle<T>> path_index;
+
+    static uint64_t make_id(uint32_t index, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    Slot& get_slot(uint32_t index) const {
+        return chunks[index / chunk_size].load(std::memory_order_relaxed)[index % chunk_size];
+    }
+
+    uint32_t allocate_slot() {
+        if (!free_slots.empty()) {
+            uint32_t const index = free_slots.back();
+            free_slots.pop_back();
+            return index;
+        }
+
+        uint32_t const chunk = slot_count / chunk_size;
+        if (chunk >= max_chunks) { return no_slot; }
+        if (slot_count % chunk_size == 0) {
+            // Release so readers that see the chunk also see its initialized slots.
+            chunks[chunk].store(new Slot[chunk_size], std::memory_order_release);
+        }
+        return slot_count++;
+    }
+};
+
+} // namespace impl
+} // namespace assets
+} // namespace andromeda
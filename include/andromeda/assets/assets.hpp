@@ -1,5 +1,8 @@
 #pragma once
 
+#include <andromeda/assets/asset_table.hpp>
+#include <andromeda/assets/dependency_graph.hpp>
+#include <andromeda/assets/packs.hpp>
 #include <andromeda/util/handle.hpp>
 #include <andromeda/thread/locked_value.hpp>
 #include <andromeda/thread/scheduler.hpp>
@@ -7,12 +10,16 @@
 #include <andromeda/app/log.hpp>
 #include <andromeda/world.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <filesystem>
 #include <mutex>
+#include <optional>
 #include <string_view>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -25,91 +32,113 @@ class Context;
 
 namespace assets {
 
-/**
- * @enum Status 
- * @brief Status of an asset. As long as an asset is in the Pending status it cannot be used.
-*/
-enum class Status {
-    Ready,
-    Pending
-};
-
 // Private storage of the asset system. Do not touch.
 namespace impl {
 
-// Initializer for storage_type
+// Storage of every asset type. Lookups are lock-free, everything else requires data_mutex<T>.
 template<typename T>
-struct delay_storage_init {
-    delay_storage_init(Status status, T data) : status{status}, data{std::move(data)} {}
+AssetTable<T> data;
 
-    Status status;
-    T data;
-};
-
-// Stores a single asset and its status.
 template<typename T>
-struct asset_storage_type {
-    asset_storage_type(delay_storage_init<T>&& init) : status{init.status}, data{std::move(init.data)} {}
-
-    std::atomic<Status> status;
-    T data;
-
-    // Additional information
-    thread::task_id load_task_id = static_cast<thread::task_id>(-1);
-    // Path to the asset file. This will be used to prevent loading the same asset multiple times.
-    // This is stored as an absolute path
-    fs::path path;
-};
+std::mutex data_mutex;
 
+// Incremented every time an asset of type T is replaced by a newer version, see replace().
 template<typename T>
-using container = std::unordered_map<Handle<T>, asset_storage_type<T>>;
+std::atomic<uint64_t> replace_counter = 0;
 
+// Amount of tasks reading assets of type T across frames, see begin_background_read().
 template<typename T>
-container<T> data;
-
-template<typename T>
-std::mutex data_mutex;
+std::atomic<uint32_t> background_readers = 0;
 
 // Global pointers to graphics context and world structure. This is to minimize the amount of parameters given to load() calls
 extern gfx::Context* gfx_context;
 extern World* world;
 
 /**
- * @brief Get thread safe access to the asset storage for asset type T.
+ * @brief Get thread safe access to the asset storage for asset type T. Not needed to look up assets.
  * @tparam T The asset type to get access to.
- * @return A structure holding the container and a locked mutex that will be released on destruction.
+ * @return A structure holding the table and a locked mutex that will be released on destruction.
 */
 template<typename T>
-thread::LockedValue<container<T>> acquire() {
-    return thread::LockedValue<container<T>>{._lock = std::lock_guard{data_mutex<T>}, .value = data<T>};
+thread::LockedValue<AssetTable<T>> acquire() {
+    return thread::LockedValue<AssetTable<T>>{._lock = std::lock_guard{data_mutex<T>}, .value = data<T>};
+}
+
+/**
+ * @brief Normalize a path for use as a key in the path index, so different spellings of the same file compare equal.
+ * @param path Path to normalize.
+ * @return The absolute, lexically normal path in generic format.
+*/
+inline std::string normalize_path(fs::path const& path) {
+    return fs::absolute(path).lexically_normal().generic_string();
 }
 
 /**
- * @brief Inserts a new empty asset in the pending state into the storage.
+ * @brief Inserts a new empty asset in the pending state into the storage. The asset is unloaded by collect_unused()
+ *        once nothing uses it anymore.
  * @tparam T Type of the asset to insert.
- * @param task Task ID of the load task. Defaults to -1 (no task).
- * @return Handle referring to the asset to delete.
+ * @return Handle referring to the new asset.
 */
 template<typename T>
 Handle<T> insert_pending() requires std::default_initializable<T> && std::movable<T> {
-    // Implementation similar to take()
-
     auto[_, storage] = acquire<T>();
-    Handle<T> handle = Handle<T>::next();
-    storage.emplace(handle, delay_storage_init<T>{Status::Pending, T{}});
+    Handle<T> handle = storage.insert(Status::Pending, T{});
+    if (auto* element = storage.find(handle)) {
+        element->collectable = true;
+    }
     return handle;
 }
 
+/**
+ * @brief Looks up the asset loaded from a path, or inserts a new pending asset for that path if there is none. Both
+ *        happen under the same lock, so concurrent requests for the same path always get the same handle.
+ * @tparam T Type of the asset.
+ * @param path Path to the asset file.
+ * @return The handle of the asset, and true if a new pending asset was inserted. The caller must then start loading it.
+*/
+template<typename T>
+std::pair<Handle<T>, bool> find_or_insert_pending(fs::path const& path) requires std::default_initializable<T> && std::movable<T> {
+    std::string key = normalize_path(path);
+
+    auto[_, storage] = acquire<T>();
+    if (Handle<T> existing = storage.find_path(key)) {
+        return {existing, false};
+    }
+
+    Handle<T> handle = storage.insert(Status::Pending, T{});
+    if (auto* element = storage.find(handle)) {
+        element->collectable = true;
+    }
+    storage.set_path(handle, std::move(key));
+    return {handle, static_cast<bool>(handle)};
+}
+
+/**
+ * @brief Removes an asset from the path index, so the next load of its path loads the file again. The asset itself stays
+ *        in the system. Used when unloading, so loads issued while the asset is being freed don't get the old handle.
+ * @tparam T The type of the asset.
+ * @param handle Handle referring to the asset to remove from the index.
+*/
+template<typename T>
+void unregister_path(Handle<T> handle) {
+    auto[_, storage] = acquire<T>();
+    storage.unregister_path(handle);
+}
+
 /**
  * @brief Removes an asset from the system. Note that this does not free its resources, for this
- *		  you must call unload().
+ *		  you must call unload(). The handle becomes invalid right away, but pointers obtained with get() stay valid
+ *		  until the asset's slot is reclaimed a few frames later, see end_frame().
  * @tparam T The type of the asset to delete.
  * @param handle Handle referring to the asset to delete.
 */
 template<typename T>
 void delete_asset(Handle<T> handle) {
-    auto[_, storage] = acquire<T>();
-    storage.erase(handle);
+    {
+        auto[_, storage] = acquire<T>();
+        storage.erase(handle);
+    }
+    dependencies.remove(asset_key(handle));
 }
 
 /**
@@ -117,18 +146,63 @@ void delete_asset(Handle<T> handle) {
  * @tparam T Type of the asset to insert.
  * @param handle Handle of the pending asset.
  * @param asset Asset that will be stored at the handle's location.
+ * @return false if the handle is null or the asset was deleted while it was loading. The caller still owns whatever
+ *         the asset refers to in that case.
 */
 template<typename T>
-void make_ready(Handle<T> handle, T asset) requires std::movable<T> {
+bool make_ready(Handle<T> handle, T asset) requires std::movable<T> {
     if (!handle) {
         LOG_WRITE(LogLevel::Error, "Tried to mark null handle as ready");
-        return;
+        return false;
     }
 
     auto[_, storage] = acquire<T>();
-    asset_storage_type<T>& element = storage.at(handle);
-    element.status = Status::Ready;
-    element.data = std::move(asset);
+    auto* element = storage.find(handle);
+    if (element == nullptr) {
+        LOG_WRITE(LogLevel::Error, "Tried to mark deleted asset as ready");
+        return false;
+    }
+    element->data = std::move(asset);
+    // Release, so lock-free readers that see the new status also see the data.
+    element->status.store(Status::Ready, std::memory_order_release);
+    dependencies.set_state(asset_key(handle), DependencyGraph::State::Ready);
+    return true;
+}
+
+/**
+ * @brief Replaces an asset with a newer version that was loaded into another handle. Afterwards the handle refers to the
+ *        new version, and the other handle to the old version, which must be unloaded once the GPU is done with it.
+ *        Must be called on the main thread between frames, since lock-free readers can't be using the asset while it
+ *        changes, see AssetTable::swap_data().
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset to replace.
+ * @param replacement Handle of the new version. Must be ready.
+ * @return true if the asset was replaced, false if either asset is not ready or was deleted, or if a task announced
+ *         with begin_background_read() is still reading assets of type T.
+*/
+template<typename T>
+bool replace(Handle<T> handle, Handle<T> replacement) {
+    // Background readers don't stop at frame boundaries, so they could see the asset change halfway.
+    if (background_readers<T>.load() != 0) { return false; }
+    {
+        auto[_, storage] = acquire<T>();
+        if (!storage.swap_data(handle, replacement)) { return false; }
+    }
+    // The dependencies belong to the data, so the old version's dependencies leave together with it.
+    dependencies.swap(asset_key(handle), asset_key(replacement));
+    replace_counter<T>.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Marks a pending asset as failed to load. The asset stays pending, but the scenes depending on it can finish
+ *        loading without it, see load_progress().
+ * @tparam T Type of the asset.
+ * @param handle Handle of the pending asset.
+*/
+template<typename T>
+void fail_load(Handle<T> handle) {
+    dependencies.set_state(asset_key(handle), DependencyGraph::State::Failed);
 }
 
 /**
@@ -145,8 +219,9 @@ void set_load_task(Handle<T> handle, thread::task_id task) {
     }
 
     auto[_, storage] = acquire<T>();
-    asset_storage_type<T>& element = storage.at(handle);
-    element.load_task_id = task;
+    if (auto* element = storage.find(handle)) {
+        element->load_task_id = task;
+    }
 }
 
 /**
@@ -163,12 +238,47 @@ thread::task_id get_load_task(Handle<T> handle) {
     }
 
     auto[_, storage] = acquire<T>();
-    asset_storage_type<T>& element = storage.at(handle);
-    return element.load_task_id;
+    auto* element = storage.find(handle);
+    if (element == nullptr) { return static_cast<thread::task_id>(-1); }
+    return element->load_task_id;
+}
+
+/**
+ * @brief Sets the task group the load tasks of an asset are scheduled in, so they can be cancelled with cancel_load().
+ * @tparam T Type of the asset.
+ * @param handle Handle referring to the asset to set the load group of.
+ * @param group Task group of the load tasks.
+*/
+template<typename T>
+void set_load_group(Handle<T> handle, thread::task_group const& group) {
+    if (!handle) {
+        LOG_WRITE(LogLevel::Error, "Tried to set load group of a null handle");
+        return;
+    }
+
+    auto[_, storage] = acquire<T>();
+    if (auto* element = storage.find(handle)) {
+        element->load_group = group;
+    }
 }
 
 /**
- * @brief Sets the path of an asset.
+ * @brief Cancel loading an asset. Load tasks that did not start yet are dropped, a load that is in progress stops
+ *        before uploading anything to the GPU. The asset stays pending. Does nothing if the asset is already ready.
+ * @tparam T Type of the asset.
+ * @param handle Handle referring to the asset to cancel the load of.
+*/
+template<typename T>
+void cancel_load(Handle<T> handle) {
+    auto[_, storage] = acquire<T>();
+    auto* element = storage.find(handle);
+    if (element != nullptr && element->status != Status::Ready && element->load_group) {
+        element->load_group->cancel();
+    }
+}
+
+/**
+ * @brief Sets the path of an asset, and registers it in the path index.
  * @tparam T Type of the asset.
  * @param handle Handle referring to the asset to set the path of.
  * @param path Path of the asset on disk.
@@ -180,19 +290,53 @@ void set_path(Handle<T> handle, fs::path const& path) {
         return;
     }
 
+    std::string key = normalize_path(path);
     auto[_, storage] = acquire<T>();
-    asset_storage_type<T>& element = storage.at(handle);
-    element.path = fs::absolute(path);
+    storage.set_path(handle, std::move(key));
 }
 
 /**
- * @brief Specialize this function for each type T assets need to be loaded.
+ * @brief Specialize this function for each type T assets need to be loaded. Starts loading an asset into a pending
+ *        handle created by find_or_insert_pending().
  * @tparam T Type of the asset to load.
+ * @param handle Handle of the pending asset.
  * @param path Path to the asset file.
- * @return Handle referring to the loaded asset.
+ * @param priority Priority of the load tasks.
+*/
+template<typename T>
+void load_priv(Handle<T> handle, std::string const& path, thread::TaskPriority priority);
+
+/**
+ * @brief Specialize this function for each asset type. Gets the priority an asset of type T is loaded with when it is
+ *        loaded as a dependency of another asset.
+ * @tparam T Type of the dependency.
+ * @param parent Priority of the asset loading the dependency.
 */
 template<typename T>
-Handle<T> load_priv(std::string const& path);
+thread::TaskPriority dependency_priority(thread::TaskPriority parent);
+
+/**
+ * @brief Load an asset another asset depends on, for example a texture of a material. Like load(), but the asset is
+ *        added to the dependencies of the parent, and loaded with a priority derived from the parent's.
+ * @tparam T Type of the asset to load.
+ * @tparam P Type of the parent asset.
+ * @param parent Handle of the asset that depends on the loaded asset.
+ * @param path Path to the asset file.
+ * @return Handle referring to the loaded asset.
+*/
+template<typename T, typename P>
+Handle<T> load_dependency(Handle<P> parent, std::string const& path) {
+    thread::TaskPriority const priority = dependency_priority<T>(dependencies.get_priority(asset_key(parent)));
+    auto[handle, inserted] = find_or_insert_pending<T>(path);
+    if (!handle) { return handle; }
+
+    dependencies.add_dependency(asset_key(parent), asset_key(handle));
+    if (inserted) {
+        dependencies.set_priority(asset_key(handle), priority);
+        load_priv<T>(handle, path, priority);
+    }
+    return handle;
+}
 
 /**
  * @brief The asset system uses a few global pointers to reduce common parameters to load functions
@@ -208,28 +352,25 @@ inline void set_global_pointers(gfx::Context* ctx, World* wrld) {
 
 /**
  * @brief Load an asset. This may happen asynchronously, so always check for availability
- *		  before using the asset.
+ *		  before using the asset. Loading a path that was loaded before returns the existing handle. If a mounted pack
+ *		  contains the path, the asset is loaded from the pack instead of from disk, see mount_pack().
+ *		  The assets it depends on are loaded with a priority derived from this asset's priority, use load_progress() to
+ *		  find out when all of them are ready.
  * @tparam T Type of the asset to load
- * @param ctx Reference to the graphics context.
  * @param path Path to the asset file.
+ * @param priority Priority of the load. Scenes that should be visible soon can be loaded with a higher priority than
+ *        scenes that are only streamed in ahead of time. Has no effect if the asset is already loading.
  * @return Handle referring to the loaded asset.
 */
 template<typename T>
-Handle<T> load(std::string const& path) {
-    // First we look for the asset in the list of already loaded assets by comparing paths.
-    {
-        fs::path path_fs = fs::absolute(path);
-        auto[_, storage] = impl::acquire<T>();
-        for (auto const&[handle, element]: storage) {
-            // Do not compare assets with empty paths (these can be created internally).
-            if (element.path == "") { continue; }
-            // Use equality compare because std::filesystem::equivalent is very expensive (and also errors on invalid paths, which we want to handle later in the pipeline).
-            if (element.path == path_fs) { return handle; }
-        }
+Handle<T> load(std::string const& path, thread::TaskPriority priority = thread::TaskPriority::Normal) {
+    // If the asset was already requested, this returns its handle, even if it is still loading.
+    auto[handle, inserted] = impl::find_or_insert_pending<T>(path);
+    if (inserted) {
+        // Asset wasn't found, we'll call the private load function to actually load it.
+        impl::dependencies.set_priority(impl::asset_key(handle), priority);
+        impl::load_priv<T>(handle, path, priority);
     }
-
-    // Asset wasn't found, we'll call the private load function to actually load it.
-    Handle<T> handle = impl::load_priv<T>(path);
     return handle;
 }
 
@@ -244,7 +385,7 @@ void unload(Handle<T> handle);
 
 /**
  * @brief Consumes an asset object. This will store it inside the asset system and return a handle
- *		  for lookup.
+ *		  for lookup. The caller owns the asset, so it is never unloaded by collect_unused().
  * @tparam T Type of the asset to consume.
  * @param asset Asset to consume.
  * @return Handle referring to the consumed asset.
@@ -253,18 +394,17 @@ template<typename T>
 Handle<T> take(T asset) requires std::movable<T> {
     // Get thread-safe access
     auto[_, storage] = impl::acquire<T>();
-    // Create a handle
-    Handle<T> handle = Handle<T>::next();
     // Store the asset away
-    storage.emplace(handle, impl::delay_storage_init<T>{Status::Ready, std::move(asset)});
+    Handle<T> handle = storage.insert(Status::Ready, std::move(asset));
+    impl::dependencies.set_state(impl::asset_key(handle), impl::DependencyGraph::State::Ready);
     return handle;
 }
 
 /**
- * @brief Query if an asset is in the Ready state.
+ * @brief Query if an asset is in the Ready state. Lock-free, so this is cheap enough to call for every draw.
  * @tparam T Type of the asset.
  * @param handle Handle of the asset to query.
- * @return true if the asset is in the Ready state, false if it is Pending.
+ * @return true if the asset is in the Ready state, false if it is Pending or was deleted.
 */
 template<typename T>
 bool is_ready(Handle<T> handle) {
@@ -273,13 +413,35 @@ bool is_ready(Handle<T> handle) {
         return false;
     }
 
-    auto[_, storage] = impl::acquire<T>();
-    impl::asset_storage_type<T>& element = storage.at(handle);
-    return element.status == Status::Ready;
+    auto const* element = impl::data<T>.find(handle);
+    return element != nullptr && element->status.load(std::memory_order_acquire) == Status::Ready;
+}
+
+/**
+ * @brief Check if a handle still refers to an asset, whether it is loaded or not. Lock-free.
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset to query.
+ * @return false if the handle is null or its asset was unloaded.
+*/
+template<typename T>
+bool is_valid(Handle<T> handle) {
+    return handle && impl::data<T>.find(handle) != nullptr;
+}
+
+/**
+ * @brief Check if an asset failed to load. Such an asset stays pending until it is unloaded, it never becomes ready.
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset to query.
+*/
+template<typename T>
+bool load_failed(Handle<T> handle) {
+    return impl::dependencies.get_state(impl::asset_key(handle)) == impl::DependencyGraph::State::Failed;
 }
 
 /**
- * @brief Get the asset a handle refers to.
+ * @brief Get the asset a handle refers to. Lock-free, so this is cheap enough to call for every draw. The pointer stays
+ *        valid until a few frames after the asset is deleted, so it may be used for the rest of the frame, but should
+ *        not be stored.
  * @tparam T Type of the asset.
  * @param handle Handle of the asset to get.
  * @return Pointer to the asset, or nullptr on failure.
@@ -291,39 +453,89 @@ T* get(Handle<T> handle) {
         return nullptr;
     }
 
-    auto[_, storage] = impl::acquire<T>();
-    try {
-        impl::asset_storage_type<T>& element = storage.at(handle);
-        if (element.status != Status::Ready) {
-            LOG_WRITE(LogLevel::Warning, "Tried to get asset while it is in the pending state.");
-            return nullptr;
-        }
-        return &element.data;
-    }
-    catch (std::out_of_range const& not_found) {
+    auto* element = impl::data<T>.find(handle);
+    if (element == nullptr) {
         LOG_WRITE(LogLevel::Error, "Tried to get asset for invalid handle");
+        return nullptr;
     }
-    return nullptr;
+    if (element->status.load(std::memory_order_acquire) != Status::Ready) {
+        LOG_WRITE(LogLevel::Warning, "Tried to get asset while it is in the pending state.");
+        return nullptr;
+    }
+    return &element->data;
+}
+
+/**
+ * @brief Get the loading progress of an asset and every asset it depends on, directly or indirectly. For an entity, this
+ *        includes the meshes and materials of the entity and its children, and the textures of those materials.
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset.
+ * @return The progress. Note that dependencies are only known once the asset that depends on them was parsed, so the
+ *         total can grow while the asset loads.
+*/
+template<typename T>
+LoadProgress load_progress(Handle<T> handle) {
+    return impl::dependencies.progress(impl::asset_key(handle));
+}
+
+/**
+ * @brief Check if an asset and every asset it depends on are ready, for example to know when a level is fully resident.
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset.
+ * @return true if the asset and all of its dependencies are ready.
+*/
+template<typename T>
+bool scene_ready(Handle<T> handle) {
+    LoadProgress const progress = load_progress(handle);
+    return progress.ready == progress.total;
+}
+
+/**
+ * @brief Announce a task that reads assets of type T while frames go on, like an asynchronous acceleration structure
+ *        build. Assets of type T are not replaced by newer versions until the matching end_background_read(), since
+ *        the task may be reading them at any time. Must be called from the main thread.
+ * @tparam T Type of the assets that are read.
+*/
+template<typename T>
+void begin_background_read() {
+    impl::background_readers<T>.fetch_add(1);
+}
+
+/**
+ * @brief End a read announced with begin_background_read(). May be called from any thread, once the task is done with
+ *        the assets.
+ * @tparam T Type of the assets that were read.
+*/
+template<typename T>
+void end_background_read() {
+    impl::background_readers<T>.fetch_sub(1);
+}
+
+/**
+ * @brief Get how many times an asset of type T was replaced by a newer version, for example by the HotReloader. Code
+ *        caching data derived from assets, like acceleration structures built from meshes, can compare this with the
+ *        value at the time it built its cache to find out the cache is outdated.
+ * @tparam T Type of the assets.
+*/
+template<typename T>
+uint64_t replace_count() {
+    return impl::replace_counter<T>.load(std::memory_order_acquire);
 }
 
 /**
  * @brief Get the absolute path of an asset.
  * @tparam T Type of the asset.
  * @param handle Handle to the asset.
- * @return std::nullopt if no path was set or if the handle was null, the path otherwise.
+ * @return std::nullopt if the handle was null or invalid, the path otherwise.
  */
 template<typename T>
 std::optional<fs::path> get_path(Handle<T> handle) {
     if (!handle) { return std::nullopt; }
 
     auto[_, storage] = impl::acquire<T>();
-    try {
-        impl::asset_storage_type<T>& element = storage.at(handle);
-        return element.path;
-    }
-    catch (std::out_of_range const& not_found) {
-        return std::nullopt;
-    }
+    auto const* element = storage.find(handle);
+    if (element == nullptr) { return std::nullopt; }
+    return element->path;
 }
 
 /**
@@ -334,19 +546,64 @@ template<typename T>
 void unload_all() {
     // We need to collect all handles in a vector first so we can release the lock again, since
     // unload() indirectly tries to lock the asset system again.
-    std::vector<Handle < T>>
-    handles;
+    std::vector<Handle<T>> handles;
     {
         auto[_, storage] = impl::acquire<T>();
-        handles.reserve(storage.size());
-        for (auto&[handle, _]: storage) {
-            handles.push_back(handle);
-        }
+        handles = storage.handles();
     }
     for (auto handle: handles) {
         unload(handle);
     }
 }
 
+/**
+ * @brief Keep an asset loaded while nothing in the world references it, for assets that are used outside of the ECS.
+ *        Every call must be matched by a call to release().
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset to keep loaded.
+*/
+template<typename T>
+void retain(Handle<T> handle) {
+    auto[_, storage] = impl::acquire<T>();
+    if (auto* element = storage.find(handle)) {
+        ++element->retain_count;
+    }
+}
+
+/**
+ * @brief Undo a call to retain(). The asset is unloaded by collect_unused() once nothing else uses it.
+ * @tparam T Type of the asset.
+ * @param handle Handle of the asset to release.
+*/
+template<typename T>
+void release(Handle<T> handle) {
+    auto[_, storage] = impl::acquire<T>();
+    auto* element = storage.find(handle);
+    if (element == nullptr || element->retain_count == 0) {
+        LOG_WRITE(LogLevel::Error, "Tried to release an asset that was not retained");
+        return;
+    }
+    --element->retain_count;
+}
+
+// Time an asset must go unused before collect_unused() unloads it. This is far longer than any frame can be in flight,
+// so the GPU is never still using an asset when it is freed.
+inline constexpr std::chrono::seconds unload_grace_period{10};
+
+/**
+ * @brief Unloads the assets that were not used for unload_grace_period. An asset is in use if a component of an entity
+ *        or blueprint stores its handle, if a material that is in use references it, if it was retained with retain(),
+ *        or if an entity is waiting to be imported from it. Assets that are still loading and assets stored with
+ *        take() are never unloaded. Must be called on the main thread, it does not need to be called every frame.
+ * @param world The world to look for references in.
+*/
+void collect_unused(World& world);
+
+/**
+ * @brief Must be called once at the end of every frame. Reclaims the storage of assets that were deleted a few frames
+ *        ago, once no thread can still be using them.
+*/
+void end_frame();
+
 } // namespace assets
-} // namespace andromeda
\ No newline at end of file
+} // namespace andromeda
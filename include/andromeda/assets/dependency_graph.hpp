@@ -0,0 +1,146 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+#include <andromeda/util/handle.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace andromeda {
+namespace assets {
+
+/**
+ * @struct LoadProgress
+ * @brief Loading progress of an asset and everything it depends on, see load_progress().
+ */
+struct LoadProgress {
+    // Amount of assets in the dependency tree, including the asset itself.
+    uint32_t total = 0;
+    uint32_t ready = 0;
+    // Assets that could not be loaded. These never become ready.
+    uint32_t failed = 0;
+
+    /**
+     * @brief Check if every asset finished loading, whether it succeeded or not.
+     */
+    [[nodiscard]] bool done() const { return ready + failed == total; }
+
+    /**
+     * @brief Get the fraction of assets that finished loading, between 0 and 1.
+     */
+    [[nodiscard]] float fraction() const { return total == 0 ? 1.0f : static_cast<float>(ready + failed) / total; }
+};
+
+namespace impl {
+
+/**
+ * @struct AssetKey
+ * @brief Identifies an asset of any type in the dependency graph.
+ */
+struct AssetKey {
+    // Unique per asset type, see asset_key().
+    void const* type = nullptr;
+    uint64_t id = 0;
+
+    bool operator==(AssetKey const& rhs) const = default;
+};
+
+// Only the address of this is used. Not const, so the linker can't merge the tags of different types.
+template<typename T>
+inline char asset_type_tag = 0;
+
+/**
+ * @brief Get the key of an asset in the dependency graph.
+ * @tparam T Type of the asset.
+ * @param handle Handle to the asset.
+ */
+template<typename T>
+AssetKey asset_key(Handle<T> handle) {
+    return AssetKey{.type = &asset_type_tag<T>, .id = handle.get_id()};
+}
+
+/**
+ * @class DependencyGraph
+ * @brief Tracks which assets were loaded on behalf of which other asset, for example the textures of a material or the
+ *        meshes and materials of an entity. Knows the load state and priority of every asset, so the progress of a whole
+ *        scene can be queried. Thread safe.
+ */
+class DependencyGraph {
+public:
+    enum class State {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    /**
+     * @brief Add an edge from an asset to an asset it depends on.
+     * @param parent The asset that depends on the other asset.
+     * @param child The asset it depends on.
+     */
+    void add_dependency(AssetKey parent, AssetKey child);
+
+    /**
+     * @brief Set the load state of an asset.
+     */
+    void set_state(AssetKey asset, State state);
+
+    /**
+     * @brief Get the load state of an asset. Assets unknown to the graph are pending.
+     */
+    [[nodiscard]] State get_state(AssetKey asset) const;
+
+    /**
+     * @brief Set the priority an asset is loaded with. Dependencies it loads inherit it.
+     */
+    void set_priority(AssetKey asset, thread::TaskPriority priority);
+
+    /**
+     * @brief Get the priority an asset is loaded with. Assets without a priority are loaded in the background.
+     */
+    [[nodiscard]] thread::TaskPriority get_priority(AssetKey asset) const;
+
+    /**
+     * @brief Count the states of an asset and all of its direct and indirect dependencies. Assets shared by multiple
+     *        parents are counted once.
+     */
+    [[nodiscard]] LoadProgress progress(AssetKey root) const;
+
+    /**
+     * @brief Exchange the states and dependencies of two assets, for when their data is exchanged. Priorities and the
+     *        edges from assets depending on them stay in place.
+     */
+    void swap(AssetKey lhs, AssetKey rhs);
+
+    /**
+     * @brief Remove an asset that was deleted. Its own dependencies stay in the graph, since other assets may share them.
+     */
+    void remove(AssetKey asset);
+
+private:
+    struct KeyHash {
+        std::size_t operator()(AssetKey const& key) const {
+            return std::hash<void const*>{}(key.type) ^ std::hash<uint64_t>{}(key.id);
+        }
+    };
+
+    struct Node {
+        State state = State::Pending;
+        thread::TaskPriority priority = thread::TaskPriority::Background;
+        std::vector<AssetKey> dependencies;
+    };
+
+    std::unordered_map<AssetKey, Node, KeyHash> nodes;
+    mutable std::mutex mutex;
+};
+
+// The dependency graph of all assets.
+extern DependencyGraph dependencies;
+
+} // namespace impl
+} // namespace assets
+} // namespace andromeda
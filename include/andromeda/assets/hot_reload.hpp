@@ -0,0 +1,88 @@
+#pragma once
+
+#include <andromeda/ecs/entity.hpp>
+#include <andromeda/graphics/forward.hpp>
+#include <andromeda/util/file_watcher.hpp>
+#include <andromeda/util/handle.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <tuple>
+#include <vector>
+
+namespace andromeda::assets {
+
+/**
+ * @class HotReloader
+ * @brief Reloads assets when their file changes on disk. A changed .tx, .mesh, .mat, .env or .ent file that was
+ *        loaded before is loaded again in the background, into a separate handle. Once the new version is ready it is
+ *        swapped into the existing handle between two frames, so everything using the handle switches to the new
+ *        version at once. The old version is unloaded after retire_frames frames, when the GPU is done with it.
+ *
+ *        Entities that were already imported into the world keep their old meshes and materials, only later imports
+ *        use the new blueprint. Assets in a mounted pack are reloaded from the pack.
+ */
+class HotReloader {
+public:
+    // Frames before a replaced asset is unloaded. More than the renderer ever has in flight.
+    static constexpr uint64_t retire_frames = 8;
+
+    /**
+     * @brief Starts watching directories for changed asset files.
+     * @param directories Directories to watch, including their subdirectories.
+     */
+    explicit HotReloader(std::vector<std::filesystem::path> const& directories);
+
+    /**
+     * @brief Starts reloading assets whose file changed, swaps in the reloads that are ready and unloads old versions
+     *        once they are no longer used. Must be called once per frame on the main thread, while no frame is being
+     *        rendered.
+     * @return true if an asset was replaced, so the scene changed.
+     */
+    bool update();
+
+private:
+    template<typename T>
+    struct Reload {
+        // The asset being replaced.
+        Handle<T> target;
+        // The new version, loaded into a handle of its own.
+        Handle<T> replacement;
+        std::filesystem::path path;
+    };
+
+    template<typename T>
+    struct Retired {
+        // Holds the old version after the swap.
+        Handle<T> handle;
+        uint64_t frame = 0;
+    };
+
+    template<typename T>
+    struct Queue {
+        std::vector<Reload<T>> loading;
+        std::deque<Retired<T>> retired;
+    };
+
+    util::FileWatcher watcher;
+    uint64_t frame = 0;
+    std::tuple<
+        Queue<gfx::Texture>,
+        Queue<gfx::Mesh>,
+        Queue<gfx::Material>,
+        Queue<gfx::Environment>,
+        Queue<ecs::entity_t>
+    > queues;
+
+    template<typename T>
+    Queue<T>& queue() { return std::get<Queue<T>>(queues); }
+
+    template<typename T>
+    void start_reload(std::filesystem::path const& path);
+
+    template<typename T>
+    bool process();
+};
+
+} // namespace andromeda::assets
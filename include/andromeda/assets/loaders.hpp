@@ -1,27 +1,39 @@
 #pragma once
 
 #include <andromeda/graphics/forward.hpp>
+#include <andromeda/thread/coroutine.hpp>
 #include <andromeda/util/handle.hpp>
 #include <andromeda/world.hpp>
 
 
+#include <string>
 #include <string_view>
 
 namespace andromeda {
 
 namespace impl {
 
-void load_texture(gfx::Context& ctx, Handle <gfx::Texture> handle, std::string_view path, uint32_t thread);
+// Texture, mesh and environment loaders are coroutines. They suspend while their GPU upload is queued in the upload
+// service and in progress, so the worker thread can run other tasks in the meantime. Their path is taken by value, since they outlive the caller.
+// When the token is cancelled, the loader stops before uploading anything and leaves the asset pending.
+thread::async_task load_texture(gfx::Context& ctx, Handle <gfx::Texture> handle, std::string path,
+                                thread::cancellation_token token, uint32_t thread);
 
-// Load a 1x1 single color texture in sRGBA8 format
-void load_1x1_texture(gfx::Context& ctx, Handle <gfx::Texture> handle, uint8_t bytes[4], uint32_t thread);
+// Load a 1x1 single color texture in sRGBA8 format. The texture becomes ready once its upload has completed.
+void load_1x1_texture(gfx::Context& ctx, Handle <gfx::Texture> handle, uint8_t bytes[4]);
 
-void load_mesh(gfx::Context& ctx, Handle <gfx::Mesh> handle, std::string_view path, uint32_t thread);
+thread::async_task load_mesh(gfx::Context& ctx, Handle <gfx::Mesh> handle, std::string path,
+                             thread::cancellation_token token, uint32_t thread);
 
-void load_material(gfx::Context& ctx, Handle <gfx::Material> handle, std::string_view path, uint32_t thread);
+// Material and entity loaders are coroutines as well, they suspend while their file is read by the I/O service.
+// When the token is cancelled, they stop after the read, before loading any dependencies or touching the blueprints.
+thread::async_task load_material(gfx::Context& ctx, Handle <gfx::Material> handle, std::string path,
+                                 thread::cancellation_token token, uint32_t thread);
 
-void load_entity(gfx::Context& ctx, World& world, Handle <ecs::entity_t> handle, std::string_view path); // thread parameter not needed
-void load_environment(gfx::Context& ctx, Handle <gfx::Environment> handle, std::string_view path, uint32_t thread);
+thread::async_task load_entity(gfx::Context& ctx, World& world, Handle <ecs::entity_t> handle, std::string path,
+                               thread::cancellation_token token); // thread parameter not needed
+thread::async_task load_environment(gfx::Context& ctx, Handle <gfx::Environment> handle, std::string path,
+                                    thread::cancellation_token token, uint32_t thread);
 
 } // namespace impl
 } // namespace andromeda
\ No newline at end of file
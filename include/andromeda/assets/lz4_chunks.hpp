@@ -0,0 +1,60 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace andromeda::assets {
+
+/**
+ * @struct LZ4ChunkTable
+ * @brief Describes a blob that was compressed as independent LZ4 blocks, so the blocks can be decompressed in parallel.
+ *        Every chunk except the last one decompresses to exactly chunk_size bytes. The compressed chunks are stored
+ *        right after each other. See Asset Formats.md for how the table is stored in asset files.
+ */
+struct LZ4ChunkTable {
+    // Uncompressed size of every chunk except the last one.
+    uint32_t chunk_size = 0;
+    // Compressed size of every chunk, in order.
+    std::vector<uint32_t> compressed_sizes;
+};
+
+// Chunk size used by the asset tools. Large enough to compress well, small enough to split a single texture over
+// every worker.
+static constexpr uint32_t default_lz4_chunk_size = 256 * 1024; // 256 KiB
+
+/**
+ * @brief Compress data as independent LZ4 chunks. Chunks are compressed in parallel.
+ * @param scheduler The task scheduler to compress on.
+ * @param data The data to compress.
+ * @param chunk_size Uncompressed size of each chunk. Must not be zero.
+ * @param table Receives the chunk table of the compressed blob.
+ * @return The compressed blob.
+ */
+std::vector<std::byte> compress_lz4_chunks(thread::TaskScheduler& scheduler, std::span<std::byte const> data,
+                                           uint32_t chunk_size, LZ4ChunkTable& table);
+
+/**
+ * @brief Decompress a chunked LZ4 blob on the calling thread.
+ * @param table The chunk table of the blob.
+ * @param blob The compressed chunks.
+ * @param destination Memory to decompress into. Must be exactly as large as the uncompressed data.
+ * @return true on success, false if the table does not match the blob or destination, or a chunk is corrupt.
+ */
+bool decompress_lz4_chunks(LZ4ChunkTable const& table, std::span<std::byte const> blob, std::span<std::byte> destination);
+
+/**
+ * @brief Decompress a chunked LZ4 blob. Chunks are decompressed in parallel, straight into the destination.
+ * @param scheduler The task scheduler to decompress on.
+ * @param table The chunk table of the blob.
+ * @param blob The compressed chunks.
+ * @param destination Memory to decompress into. Must be exactly as large as the uncompressed data.
+ * @return true on success, false if the table does not match the blob or destination, or a chunk is corrupt.
+ */
+bool decompress_lz4_chunks(thread::TaskScheduler& scheduler, LZ4ChunkTable const& table,
+                           std::span<std::byte const> blob, std::span<std::byte> destination);
+
+} // namespace andromeda::assets
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <andromeda/assets/lz4_chunks.hpp>
+
+#include <assetlib/asset_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace andromeda::assets {
+
+/**
+ * @class MappedAssetFile
+ * @brief Binary asset file (.tx, .mesh, .env) read through a memory mapping. The header and JSON section are parsed in
+ *        place, and the binary blob is decompressed or copied straight from the mapping into its destination, so the
+ *        file contents are never read into an intermediate buffer. See Asset Formats.md for the file layout.
+ *
+ *        Files in a mounted pack are read from the pack instead, see mount_pack().
+ */
+class MappedAssetFile {
+public:
+    /**
+     * @brief Kind of asset a file is expected to hold, which decides the magic number its header must start with.
+     */
+    enum class Type {
+        Texture,
+        Mesh,
+        Environment
+    };
+
+    /**
+     * @brief Creates an invalid file.
+     */
+    MappedAssetFile() = default;
+
+    /**
+     * @brief Maps an asset file, or finds it in a mounted pack, and parses its header.
+     * @param path Path to the asset file.
+     * @param type Kind of asset the file must hold. Files with another magic number or an unsupported version are invalid.
+     */
+    MappedAssetFile(std::string_view path, Type type);
+
+    /**
+     * @brief Check if the file was mapped and has a valid header of the expected type and version.
+     */
+    [[nodiscard]] bool valid() const;
+
+    /**
+     * @brief Get the JSON metadata of the asset.
+     */
+    [[nodiscard]] std::string_view json() const;
+
+    /**
+     * @brief Get the (possibly compressed) binary blob of the asset.
+     */
+    [[nodiscard]] std::span<std::byte const> blob() const;
+
+    /**
+     * @brief Get an asset file with only the metadata of this file, to pass to assetlib's read_XXX_info() functions.
+     *        The binary blob of the returned file is left empty.
+     */
+    [[nodiscard]] assetlib::AssetFile metadata() const;
+
+    /**
+     * @brief Decompress or copy the binary blob into memory on the calling thread.
+     * @param destination Memory to unpack into. Must be exactly as large as the uncompressed blob.
+     * @return true on success, false if the compression mode is unknown or the blob does not match the destination size.
+     */
+    bool unpack(std::span<std::byte> destination) const;
+
+    /**
+     * @brief Decompress or copy the binary blob into memory. Blobs compressed as independent chunks are decompressed in
+     *        parallel, other blobs are unpacked on the calling thread like unpack(destination).
+     * @param scheduler The task scheduler to decompress chunks on.
+     * @param destination Memory to unpack into. Must be exactly as large as the uncompressed blob.
+     * @return true on success, false if the compression mode is unknown or the blob does not match the destination size.
+     */
+    bool unpack(thread::TaskScheduler& scheduler, std::span<std::byte> destination) const;
+
+private:
+    enum class Compression {
+        None,
+        LZ4,
+        LZ4Chunked,
+        Unknown
+    };
+
+    // Keeps the file contents alive. Either the mapping of the file, or the pack it was found in.
+    std::shared_ptr<void const> storage{};
+    std::string_view json_section{};
+    std::span<std::byte const> blob_section{};
+    Compression compression = Compression::Unknown;
+    // Only used for Compression::LZ4Chunked.
+    LZ4ChunkTable chunks{};
+};
+
+} // namespace andromeda::assets
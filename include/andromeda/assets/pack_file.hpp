@@ -0,0 +1,134 @@
+#pragma once
+
+#include <andromeda/util/mapped_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace andromeda::assets {
+
+/**
+ * @enum PackCompression
+ * @brief Compression of a single entry in a pack file.
+ */
+enum class PackCompression : uint32_t {
+    None = 0,
+    LZ4 = 1
+};
+
+// Payloads in a pack file start at a multiple of this, so every entry starts on its own page.
+static constexpr uint64_t pack_alignment = 4096;
+
+/**
+ * @class PackFile
+ * @brief Read-only view of a pack file (.pak), which bundles many asset files into a single file. The pack is memory
+ *        mapped once, entries are found through a hash table stored in the file, so opening an entry does not touch
+ *        the file system. See Asset Formats.md for the file layout.
+ */
+class PackFile {
+public:
+    /**
+     * @struct Entry
+     * @brief An entry in a pack file. Only valid while the pack file is alive.
+     */
+    struct Entry {
+        // Path of the entry, relative to the root directory of the pack.
+        std::string_view path;
+        // Contents of the entry as stored in the pack, possibly compressed.
+        std::span<std::byte const> data;
+        // Size of the contents after unpacking.
+        uint64_t size = 0;
+        PackCompression compression = PackCompression::None;
+    };
+
+    /**
+     * @brief Creates an invalid pack file.
+     */
+    PackFile() = default;
+
+    /**
+     * @brief Maps a pack file and validates its header and table of contents.
+     * @param path Path to the pack file.
+     */
+    explicit PackFile(std::string_view path);
+
+    /**
+     * @brief Check if the pack file was mapped and is valid.
+     */
+    [[nodiscard]] bool valid() const;
+
+    /**
+     * @brief Get the amount of entries in the pack.
+     */
+    [[nodiscard]] std::size_t entry_count() const;
+
+    /**
+     * @brief Look up an entry. Thread safe.
+     * @param path Path of the entry relative to the root directory of the pack, with '/' as separator.
+     * @return The entry, or std::nullopt if the pack does not contain it.
+     */
+    [[nodiscard]] std::optional<Entry> find(std::string_view path) const;
+
+    /**
+     * @brief Decompress or copy the contents of an entry.
+     * @param entry The entry to unpack.
+     * @param destination Memory to unpack into. Must be exactly entry.size bytes.
+     * @return true on success, false if the entry is corrupt.
+     */
+    static bool unpack(Entry const& entry, std::span<std::byte> destination);
+
+private:
+    util::MappedFile file{};
+    uint32_t slot_count = 0;
+    uint32_t entries = 0;
+    std::span<std::byte const> slots{};
+    std::span<std::byte const> strings{};
+};
+
+/**
+ * @class PackWriter
+ * @brief Builds a pack file. Used by the pack tool.
+ */
+class PackWriter {
+public:
+    /**
+     * @brief Add an entry to the pack.
+     * @param path Path of the entry relative to the root directory of the pack, with '/' as separator.
+     * @param data Contents of the entry.
+     * @param compression Requested compression. Entries that LZ4 does not shrink by at least an eighth are stored
+     *        uncompressed anyway, so they can be used straight from the mapping.
+     */
+    void add(std::string path, std::span<std::byte const> data, PackCompression compression);
+
+    /**
+     * @brief Write the pack to disk.
+     * @param path Path of the pack file to write.
+     * @return true on success, false if the file could not be written, an entry has an empty path or two entries have
+     *         the same path.
+     */
+    bool write(std::string_view path) const;
+
+private:
+    struct PendingEntry {
+        std::string path;
+        std::vector<std::byte> data;
+        uint64_t size = 0;
+        PackCompression compression = PackCompression::None;
+    };
+
+    std::vector<PendingEntry> pending;
+};
+
+/**
+ * @brief Hash used for the table of contents of pack files (64-bit FNV-1a).
+ * @param path Path of an entry.
+ * @return The hash of the path.
+ */
+uint64_t hash_pack_path(std::string_view path);
+
+} // namespace andromeda::assets
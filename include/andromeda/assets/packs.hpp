@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace andromeda::assets {
+
+/**
+ * @struct PackedFile
+ * @brief Contents of a file that was found in a mounted pack. The bytes point into the mapping of the pack, or into a
+ *        buffer it was decompressed into, and stay valid as long as this object is alive.
+ */
+struct PackedFile {
+    std::shared_ptr<void const> owner;
+    std::span<std::byte const> data;
+};
+
+/**
+ * @brief Mount a pack file. Loading an asset first looks in mounted packs, packs mounted later take precedence. Files
+ *        that are not in any pack are loaded from disk as usual. Packs stay mounted until the program exits.
+ * @param pack Path to the pack file.
+ * @param root Directory the paths in the pack are relative to.
+ * @return true if the pack was mounted, false if it could not be opened or is invalid.
+ */
+bool mount_pack(std::filesystem::path const& pack, std::filesystem::path const& root);
+
+namespace impl {
+
+/**
+ * @brief Look up a file in the mounted packs, and unpack it if it is compressed. Thread safe.
+ * @param path Path of the file, as passed to load().
+ * @return The contents of the file, or std::nullopt if no mounted pack contains it or unpacking failed.
+ */
+std::optional<PackedFile> find_packed(std::filesystem::path const& path);
+
+} // namespace impl
+
+} // namespace andromeda::assets
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <andromeda/ecs/entity.hpp>
+#include <andromeda/world.hpp>
+
+#include <string_view>
+
+namespace andromeda::assets {
+
+/**
+ * @brief Saves every entity in the world (except the root entity) to a binary scene snapshot. See Asset Formats.md
+ *        for a description of the file layout.
+ * @param world The world to save.
+ * @param path Path of the file to write. Existing files are overwritten.
+ * @return true if the snapshot was written successfully, false otherwise.
+ */
+bool save_scene(World const& world, std::string_view path);
+
+/**
+ * @brief Loads a binary scene snapshot and adds all its entities to the world. Component data is copied
+ *        into the ECS in bulk, and referenced assets are loaded through the asset system.
+ * @param world The world to add the entities to.
+ * @param path Path to the snapshot file.
+ * @param parent Entity the top-level entities of the snapshot will be attached to. Defaults to the root entity.
+ * @return true if the snapshot was loaded successfully, false otherwise.
+ */
+bool load_scene(World& world, std::string_view path, ecs::entity_t parent = 0);
+
+}
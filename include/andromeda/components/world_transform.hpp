@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+
+namespace andromeda {
+
+// Note that this is intentionally not a reflected [[component]]. It is derived from the Transform and Hierarchy
+// components every frame by the transform propagation system, so it is never edited, copied or serialized.
+struct WorldTransform {
+    // Transforms from the entity's local space to world space.
+    glm::mat4 local_to_world = glm::mat4(1.0f);
+};
+
+}
@@ -5,6 +5,11 @@
 #include <andromeda/ecs/component_storage_base.hpp>
 #include <andromeda/ecs/entity.hpp>
 
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
 namespace andromeda::ecs {
 
 // T is the component type
@@ -208,6 +213,18 @@ public:
         return iterator(&components, components.size() - 1);
     }
 
+    // Inserts a component for every entity in the range, where values[i] belongs to entities[i].
+    // This is much faster than calling insert() repeatedly when loading large amounts of entities.
+    void insert_range(std::span<entity_t const> entities, std::vector<T>&& values) {
+        assert(entities.size() == values.size() && "Every entity needs exactly one component");
+        if (components.empty()) {
+            components = std::move(values);
+        } else {
+            components.insert(components.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        }
+        underlying_storage::insert_range(entities);
+    }
+
     template<typename... Args>
     iterator construct(entity_t entity, Args&& ... args) {
         components.push_back(T{std::forward<Args>(args) ...});
@@ -234,6 +251,19 @@ public:
         return const_iterator(&components, it.get_index());
     }
 
+    void erase(entity_t entity) override {
+        underlying_storage::iterator it = underlying_storage::find(entity);
+        if (it == underlying_storage::end()) { return; }
+
+        // The sparse set moves its last value into the erased slot, the components have to do the same.
+        size_t const index = it.get_index();
+        if (index != components.size() - 1) {
+            components[index] = std::move(components.back());
+        }
+        components.pop_back();
+        underlying_storage::erase(entity);
+    }
+
     T& get(entity_t entity) {
         auto it = find(entity);
         assert(it != end() && "Entity not in storage");
@@ -250,6 +280,11 @@ public:
         return components.size();
     }
 
+    // Returns all components in the same order as the entities in dense().
+    std::span<T const> dense_components() const {
+        return components;
+    }
+
 private:
     std::vector<T> components;
 };
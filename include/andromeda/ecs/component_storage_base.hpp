@@ -8,6 +8,22 @@ namespace andromeda::ecs {
 class component_storage_base : public sparse_set<entity_t> {
 public:
     using sparse_set::sparse_set;
+
+    component_storage_base() = default;
+
+    component_storage_base(component_storage_base const&) = default;
+
+    component_storage_base(component_storage_base&&) = default;
+
+    component_storage_base& operator=(component_storage_base const&) = default;
+
+    component_storage_base& operator=(component_storage_base&&) = default;
+
+    // Storages are owned through a pointer to this base.
+    virtual ~component_storage_base() = default;
+
+    // Removes the component of an entity. Does nothing if the entity has no component in this storage.
+    virtual void erase(entity_t entity) = 0;
 };
 
 }
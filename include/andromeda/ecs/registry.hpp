@@ -8,6 +8,7 @@
 #include <cstdint>
 
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace andromeda::ecs {
@@ -28,6 +29,24 @@ public:
 
     entity_t create_entity();
 
+    // Creates count entities with consecutive ids and returns the id of the first one.
+    entity_t create_entities(size_t count);
+
+    // Removes an entity and all of its components. Entity ids are never reused.
+    void destroy_entity(entity_t entity);
+
+    // Removes a range of entities and all of their components. This is much faster than calling destroy_entity()
+    // repeatedly, since the entity list is only traversed once.
+    void destroy_entities(std::span<entity_t const> entities);
+
+    // Adds a component to every entity in the range, where values[i] is added to entities[i].
+    // None of the entities may already have a component of type T.
+    template<typename T>
+    void insert_components(std::span<entity_t const> entities, std::vector<T>&& values) {
+        component_storage<T>& storage = get_or_emplace_storage<T>();
+        storage.insert_range(entities, std::move(values));
+    }
+
     template<typename T, typename... Args>
     T& add_component(entity_t entity, Args&& ... args) {
         component_storage<T>& storage = get_or_emplace_storage<T>();
@@ -82,6 +101,12 @@ public:
 
     std::vector<entity_t> const& get_entities() const;
 
+    // Direct read access to the storage of a component type, for bulk operations such as serialization.
+    template<typename T>
+    component_storage<T> const& get_storage() const {
+        return get_or_emplace_storage<T>();
+    }
+
 private:
     struct storage_data {
         uint64_t type_id = 0;
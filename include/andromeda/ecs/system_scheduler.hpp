@@ -0,0 +1,137 @@
+#pragma once
+
+#include <andromeda/ecs/registry.hpp>
+#include <andromeda/thread/scheduler.hpp>
+#include <andromeda/world.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace andromeda::ecs {
+
+/**
+ * @var using system_function = std::function<void(ecs::registry&, uint32_t)>
+ * @brief Callable type for systems. Takes in the ECS registry of the world and the index of the thread it's running on.
+ *        A system may only access the components it declared in its SystemAccess.
+ */
+using system_function = std::function<void(ecs::registry& /*ecs*/, uint32_t /*thread_index*/)>;
+
+/**
+ * @class SystemAccess
+ * @brief Declares which component types a system reads and writes. Two systems conflict if one of them writes a
+ *        component type the other one reads or writes. Conflicting systems are never executed concurrently.
+ */
+class SystemAccess {
+public:
+    /**
+     * @brief Declare read-only access to a set of component types.
+     * @tparam Cs Component types the system reads.
+     * @return Reference to this object for chaining.
+     */
+    template<typename... Cs>
+    SystemAccess& read() {
+        (add_access<Cs>(reads), ...);
+        return *this;
+    }
+
+    /**
+     * @brief Declare read-write access to a set of component types.
+     * @tparam Cs Component types the system writes.
+     * @return Reference to this object for chaining.
+     */
+    template<typename... Cs>
+    SystemAccess& write() {
+        (add_access<Cs>(writes), ...);
+        return *this;
+    }
+
+    /**
+     * @brief Declare read-only access to a resource that is not a component, such as the world's spatial index.
+     *        Resources are only identified by their type and are used for ordering, no storage is created for them.
+     * @tparam Rs Resource types the system reads.
+     * @return Reference to this object for chaining.
+     */
+    template<typename... Rs>
+    SystemAccess& read_resource() {
+        (reads.push_back(get_component_type_id<Rs>()), ...);
+        return *this;
+    }
+
+    /**
+     * @brief Declare read-write access to a resource that is not a component.
+     * @tparam Rs Resource types the system writes.
+     * @return Reference to this object for chaining.
+     */
+    template<typename... Rs>
+    SystemAccess& write_resource() {
+        (writes.push_back(get_component_type_id<Rs>()), ...);
+        return *this;
+    }
+
+    /**
+     * @brief Check if two systems may not run concurrently.
+     * @param other Access declaration of the other system.
+     * @return true if either system writes a component type the other system accesses.
+     */
+    bool conflicts_with(SystemAccess const& other) const;
+
+    /**
+     * @brief Creates the component storages for every accessed type. Storages are created lazily by the registry,
+     *        so this must be done on a single thread before systems access the registry concurrently.
+     * @param ecs The registry to prepare.
+     */
+    void prepare_storage(ecs::registry& ecs) const;
+
+private:
+    std::vector<uint64_t> reads;
+    std::vector<uint64_t> writes;
+    std::vector<void(*)(ecs::registry&)> prepare_functions;
+
+    template<typename C>
+    void add_access(std::vector<uint64_t>& list) {
+        list.push_back(get_component_type_id<C>());
+        prepare_functions.push_back([](ecs::registry& ecs) {
+            // Creating a view makes sure the storage for this component exists.
+            (void) ecs.view<C>();
+        });
+    }
+};
+
+/**
+ * @class SystemScheduler
+ * @brief Runs all registered per-frame systems. Systems are executed in registration order, except that systems
+ *        that do not conflict with each other are run concurrently on the task scheduler.
+ */
+class SystemScheduler {
+public:
+    /**
+     * @brief Register a new system. A system depends on every earlier registered system it conflicts with.
+     * @param name Name of the system, used for diagnostics.
+     * @param access Declaration of the components this system reads and writes.
+     * @param function The function to execute each frame.
+     */
+    void add_system(std::string name, SystemAccess access, system_function function);
+
+    /**
+     * @brief Run all systems once and wait for them to complete. Must be called on the main thread.
+     *        The world's ECS is locked for the duration of this call.
+     * @param world The world to run the systems on.
+     * @param scheduler The task scheduler to execute systems on.
+     */
+    void run(World& world, thread::TaskScheduler& scheduler);
+
+private:
+    struct System {
+        std::string name;
+        SystemAccess access;
+        system_function function;
+        // Indices of earlier systems that must be completed before this system can run.
+        std::vector<uint32_t> dependencies;
+    };
+
+    std::vector<System> systems;
+};
+
+} // namespace andromeda::ecs
@@ -4,6 +4,7 @@
 #include <andromeda/editor/command_parser.hpp>
 #include <andromeda/editor/widgets/input_text.hpp>
 #include <andromeda/graphics/forward.hpp>
+#include <andromeda/world.hpp>
 
 #include <plib/trie.hpp>
 
@@ -23,8 +24,9 @@ public:
      * @brief Initializes the console widget.
      * @param ctx Reference to the graphics context
      * @param window Reference to the application window.
+     * @param world Reference to the world, used for commands that operate on the scene.
     */
-    Console(gfx::Context& ctx, Window& window);
+    Console(gfx::Context& ctx, Window& window, World& world);
 
     /**
      * @brief The maximum amount of messages that will be stored and displayed in the console.
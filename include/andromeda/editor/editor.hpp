@@ -24,8 +24,9 @@ public:
      *		  was already initialized before calling this.
      * @param ctx Reference to the graphics context.
      * @param window Reference to the application window.
+     * @param world Reference to the world edited by this editor.
     */
-    Editor(gfx::Context& ctx, Window& window);
+    Editor(gfx::Context& ctx, Window& window, World& world);
 
     /**
      * @brief Must be called every frame to update the UI.
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <andromeda/graphics/imgui.hpp>
+#include <andromeda/thread/scheduler.hpp>
+
+#include <array>
 
 namespace andromeda::editor {
 
@@ -14,6 +17,18 @@ private:
     bool visible = true;
 
     float average_frametime = 0.0f;
+
+    // Scheduler counters are collected over an interval, so the utilization shown is recent.
+    static constexpr float scheduler_interval = 1.0f;
+    // File the scheduler timeline is written to.
+    static constexpr char const* trace_path = "scheduler_trace.json";
+    float scheduler_timer = 0.0f;
+    thread::SchedulerStats scheduler_stats{};
+    // Amount of queued tasks, sampled every frame.
+    std::array<float, 240> queue_history{};
+    uint32_t queue_history_offset = 0;
+
+    void display_scheduler(thread::TaskScheduler& scheduler);
 };
 
-}
\ No newline at end of file
+}
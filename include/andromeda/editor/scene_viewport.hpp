@@ -18,8 +18,9 @@ public:
      * @param ctx Reference to the graphics context.
      * @param renderer Reference to the rendering interface.
      * @param world The world the viewport is displaying.
+     * @param selection The selected entity. Clicking on an object in the viewport selects it.
     */
-    SceneViewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world);
+    SceneViewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection);
 
     /**
      * @brief Returns whether the window is visible. This is effectively the result of
@@ -41,7 +42,9 @@ private:
 
     static inline std::array<PerViewportStatic, gfx::MAX_VIEWPORTS> per_viewport{};
 
-    void show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world);
+    void show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection);
+
+    void pick_entity(gfx::Viewport viewport, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection);
 
     void show_menu_bar(gfx::Viewport viewport, gfx::Renderer& renderer);
 
@@ -13,7 +13,7 @@ public:
         ph::ImageView sky_view;
     };
 
-    AtmosphereRendering(gfx::Context& ctx, VkSampleCountFlagBits samples, float sample_ratio);
+    AtmosphereRendering(gfx::Context& ctx, gfx::PipelineBatch& pipelines, VkSampleCountFlagBits samples, float sample_ratio);
     ~AtmosphereRendering();
 
     ph::Pass lut_update_pass(gfx::Viewport const& vp, ph::InFlightContext& ifc, gfx::SceneDescription const& scene);
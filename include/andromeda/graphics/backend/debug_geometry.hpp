@@ -56,10 +56,11 @@ private:
     } vp[gfx::MAX_VIEWPORTS];
 
     /**
-     * @brief Initialize the debug drawer. This will create pipelines for the debug draw system.
+     * @brief Initialize the debug drawer. This will add the pipelines for the debug draw system to a pipeline batch.
      * @param ctx Reference to the graphics context.
+     * @param pipelines Batch to add the pipelines to.
      */
-    static void initialize(gfx::Context& ctx);
+    static void initialize(gfx::Context& ctx, gfx::PipelineBatch& pipelines);
 
     /**
      * @brief Clear draw list for a viewport.
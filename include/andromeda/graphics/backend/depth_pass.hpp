@@ -7,23 +7,25 @@
 namespace andromeda::gfx::backend {
 
 /**
- * @brief Creates a pipeline with name 'depth_only' that can be used to only render depth.
+ * @brief Adds a pipeline with name 'depth_only' that can be used to only render depth to a pipeline batch.
  * @param ctx Reference to the graphics context.
+ * @param pipelines Batch to add the pipeline to.
  * @param samples Number of MSAA samples.
  * @param sample_ratio Ratio used for MSAA shading.
  */
-void create_depth_only_pipeline(gfx::Context& ctx, VkSampleCountFlagBits samples, float sample_ratio);
+void create_depth_only_pipeline(gfx::Context& ctx, gfx::PipelineBatch& pipelines, VkSampleCountFlagBits samples, float sample_ratio);
 
 /**
  * @brief Build a depth-only renderpass object and return it.
  * @param ctx Reference to the graphics context.
  * @param ifc Reference to an InFlightContext used to allocate scratch memory.
  * @param target Name of the depth attachment to render to.
+ * @param viewport Viewport to render. Only draws visible in this viewport are rendered.
  * @param scene Scene to render.
  * @param camera BufferSlice with camera data.
  * @param transforms BufferSlice with transform data.
  * @return ph::Pass object describing the depth pass.
  */
-ph::Pass build_depth_pass(gfx::Context& ctx, ph::InFlightContext& ifc, std::string_view target, gfx::SceneDescription const& scene, ph::BufferSlice camera, ph::BufferSlice transforms);
+ph::Pass build_depth_pass(gfx::Context& ctx, ph::InFlightContext& ifc, std::string_view target, gfx::Viewport const& viewport, gfx::SceneDescription const& scene, ph::BufferSlice camera, ph::BufferSlice transforms);
 
 }
\ No newline at end of file
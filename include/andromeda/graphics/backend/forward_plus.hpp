@@ -13,7 +13,13 @@ namespace andromeda::gfx::backend {
  */
 class ForwardPlusRenderer : public RendererBackend {
 public:
-    explicit ForwardPlusRenderer(gfx::Context& ctx);
+    /**
+     * @brief Creates the Forward+ backend. Pipelines are not created immediately, but added to a batch.
+     *        The backend may only be used after this batch is finished.
+     * @param ctx Reference to the graphics context.
+     * @param pipelines Batch to add all pipelines used by this backend to.
+     */
+    ForwardPlusRenderer(gfx::Context& ctx, gfx::PipelineBatch& pipelines);
 
     ~ForwardPlusRenderer() override;
 
@@ -60,7 +66,7 @@ private:
 
     // This structure owns buffers and storage images shared by the pipeline.
     struct RenderData {
-        explicit inline RenderData(gfx::Context& ctx) : accel_structure(ctx), atmosphere(ctx, msaa_samples, msaa_sample_ratio) {}
+        inline RenderData(gfx::Context& ctx, gfx::PipelineBatch& pipelines) : accel_structure(ctx), atmosphere(ctx, pipelines, msaa_samples, msaa_sample_ratio) {}
 
         // Per-viewport render data, indexed by viewport ID.
         struct PerViewport {
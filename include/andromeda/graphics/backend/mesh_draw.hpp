@@ -25,6 +25,16 @@ namespace andromeda::gfx::backend {
  */
 void for_each_ready_mesh(gfx::SceneDescription const& scene, std::function<void(SceneDescription::Draw const&, gfx::Mesh const&, uint32_t)> const& callback);
 
+/**
+ * @brief Executes a certain function for each mesh that is ready to draw and visible in a viewport.
+ *        SceneDescription::cull_viewport() must have been called for this viewport.
+ *        This does not check readiness of materials.
+ * @param scene Scene to render
+ * @param viewport Viewport to render. Only draws visible from this viewport's camera are executed.
+ * @param callback Function to call for each ready mesh. The first parameter is the draw being executed, the second is a reference to a ready mesh, the third is the draw index.
+ */
+void for_each_ready_mesh(gfx::SceneDescription const& scene, gfx::Viewport const& viewport, std::function<void(SceneDescription::Draw const&, gfx::Mesh const&, uint32_t)> const& callback);
+
 /**
  * @brief Binds mesh vertex and index buffers and records a drawcall.
  * @param cmd Command buffer to record to.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <andromeda/graphics/context.hpp>
+#include <andromeda/graphics/pipeline_batch.hpp>
 #include <andromeda/graphics/scene_description.hpp>
 #include <andromeda/graphics/viewport.hpp>
 #include <andromeda/graphics/performance_counters.hpp>
@@ -99,17 +99,18 @@ private:
     // When a BLAS update is done, the result is stored here.
     BLAS updated_blas{};
 
-    // Signals that the BLAS update is completed
-    std::atomic<bool> blas_update_done = false;
-
-    // These must be deleted before checking blas_update_done and reassigning the new BLAS.
+    // These must be deleted before checking blas_update_task and reassigning the new BLAS.
     std::vector<BLAS> blas_deletion_queue{};
 
     // Protects access to the BLAS deletion queue
     std::mutex queue_mutex{};
 
-    // This exists to make sure we don't start two BLAS updates at the same time.
-    thread::task_id blas_update_task = -1;
+    // The BLAS update task. Valid while an update is busy or its result has not been swapped in yet, which also makes
+    // sure we don't start two BLAS updates at the same time.
+    thread::task_handle blas_update_task{};
+
+    // Value of assets::replace_count<gfx::Mesh>() when the last BLAS update started.
+    uint64_t blas_mesh_replace_count = 0;
 
     // Immediately destroy a TLAS
     void destroy(TLAS& tlas);
@@ -5,12 +5,13 @@
 namespace andromeda::gfx::backend {
 
 /**
- * @brief Creates a named pipeline in ctx with name 'skybox' used to render skyboxes with render_skybox().
+ * @brief Adds a pipeline with name 'skybox' used to render skyboxes with render_skybox() to a pipeline batch.
  * @param ctx Reference to the graphics context.
+ * @param pipelines Batch to add the pipeline to.
  * @param samples Number of MSAA samples.
  * @param sample_ratio Ratio used for MSAA shading.
  */
-void create_skybox_pipeline(gfx::Context& ctx, VkSampleCountFlagBits samples, float sample_ratio);
+void create_skybox_pipeline(gfx::Context& ctx, gfx::PipelineBatch& pipelines, VkSampleCountFlagBits samples, float sample_ratio);
 
 /**
  * @brief Record commands to render a skybox to a given command buffer.
@@ -5,17 +5,19 @@
 namespace andromeda::gfx::backend {
 
 /**
- * @brief Creates pipelines for the luminance histogram calculation.
+ * @brief Adds pipelines for the luminance histogram calculation to a pipeline batch.
  *        This will create two compute pipelines, 'luminance_accumulate' and 'luminance_average'
  * @param ctx Reference to the graphics context.
+ * @param pipelines Batch to add the pipelines to.
  */
-void create_luminance_histogram_pipelines(gfx::Context& ctx);
+void create_luminance_histogram_pipelines(gfx::Context& ctx, gfx::PipelineBatch& pipelines);
 
 /**
- * @brief Creates a named pipeline for the tonemapping pass with name 'tonemap'.
+ * @brief Adds a pipeline for the tonemapping pass with name 'tonemap' to a pipeline batch.
  * @param ctx Reference to the graphics context.
+ * @param pipelines Batch to add the pipeline to.
  */
-void create_tonemapping_pipeline(gfx::Context& ctx);
+void create_tonemapping_pipeline(gfx::Context& ctx, gfx::PipelineBatch& pipelines);
 
 /**
  * @brief Builds a compute-only pass that will calculate the average luminance in the scene and store it in the GPU buffer 'average'.
@@ -10,6 +10,8 @@
 #include <andromeda/graphics/texture.hpp>
 #include <andromeda/graphics/material.hpp>
 #include <andromeda/graphics/environment.hpp>
+#include <andromeda/graphics/upload_service.hpp>
+#include <andromeda/thread/io_service.hpp>
 #include <andromeda/thread/scheduler.hpp>
 #include <andromeda/util/handle.hpp>
 
@@ -41,15 +43,28 @@ public:
 
     inline thread::TaskScheduler& get_scheduler() { return scheduler; }
 
+    /**
+     * @brief Get the I/O service that loaders read asset files with.
+     */
+    inline thread::IOService& get_io_service() { return io_service; }
+
+    /**
+     * @brief Get the upload service, which batches all CPU to GPU uploads of the loaders into one transfer submission
+     *        per frame.
+     */
+    inline UploadService& get_upload_service() { return upload_service; }
+
 private:
     Context(ph::AppSettings settings, Window& window, thread::TaskScheduler& scheduler);
 
     thread::TaskScheduler& scheduler;
     Window& window;
+    thread::IOService io_service;
+    UploadService upload_service;
 
     // load_priv() needs access to the request_XXX() functions.
     template<typename T>
-    friend Handle<T> assets::impl::load_priv(std::string const&);
+    friend void assets::impl::load_priv(Handle<T>, std::string const&, thread::TaskPriority);
 
     // So does unload()
     template<typename T>
@@ -57,46 +72,50 @@ private:
 
     /**
      * @brief Request a texture to be loaded. This will be done asynchronously.
+     * @param handle Handle of the pending texture in the asset system to load into.
      * @param path Path to the texture file.
-     * @return A handle referring to the texture in the asset system.
+     * @param priority Priority of the load tasks.
     */
-    Handle<gfx::Texture> request_texture(std::string const& path);
+    void request_texture(Handle<gfx::Texture> handle, std::string const& path, thread::TaskPriority priority);
 
     /**
      * @brief Request a mesh to be loaded. This will be done asynchronously.
+     * @param handle Handle of the pending mesh in the asset system to load into.
      * @param path Path to the mesh file
-     * @return A handle referring to the mesh in the asset system
+     * @param priority Priority of the load tasks.
     */
-    Handle<gfx::Mesh> request_mesh(std::string const& path);
+    void request_mesh(Handle<gfx::Mesh> handle, std::string const& path, thread::TaskPriority priority);
 
     /**
      * @brief Request a material to be loaded. This will be done asynchronously.
+     * @param handle Handle of the pending material in the asset system to load into.
      * @param path Path to the material file.
-     * @return A handle referring to the material in the asset system.
+     * @param priority Priority of the load tasks.
     */
-    Handle<gfx::Material> request_material(std::string const& path);
+    void request_material(Handle<gfx::Material> handle, std::string const& path, thread::TaskPriority priority);
 
     /**
      * @brief Request an environment to be loaded asynchronously.
+     * @param handle Handle of the pending environment in the asset system to load into.
      * @param path Path to the environment (.env) file.
-     * @return A handle referring to the environment in the asset system
+     * @param priority Priority of the load tasks.
      */
-    Handle<gfx::Environment> request_environment(std::string const& path);
+    void request_environment(Handle<gfx::Environment> handle, std::string const& path, thread::TaskPriority priority);
 
     /**
-     * @brief Frees a texture. This will be done asynchronously.
+     * @brief Frees a texture. This will be done asynchronously on the main thread, once the texture has finished loading.
      * @param handle A handle referring to the texture to free
     */
     void free_texture(Handle<gfx::Texture> handle);
 
     /**
-     * @brief Frees a mesh. This will be done asynchronously.
+     * @brief Frees a mesh. This will be done asynchronously on the main thread, once the mesh has finished loading.
      * @param handle A handle referring to the mesh to free.
     */
     void free_mesh(Handle<gfx::Mesh> handle);
 
     /**
-     * @brief Free an environment asynchronously.
+     * @brief Free an environment asynchronously on the main thread, once the environment has finished loading.
      * @param handle A handle referring to the environment to free.
      */
     void free_environment(Handle<gfx::Environment> handle);
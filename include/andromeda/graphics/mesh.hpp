@@ -1,5 +1,7 @@
 #pragma once
 
+#include <andromeda/math/bounds.hpp>
+
 #include <phobos/buffer.hpp>
 
 namespace andromeda {
@@ -11,6 +13,9 @@ struct Mesh {
 
     uint32_t num_vertices = 0;
     uint32_t num_indices = 0;
+
+    // Bounding box of all vertices, in model space.
+    math::AABB bounds{};
 };
 
 } // namespace gfx
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <andromeda/graphics/context.hpp>
+#include <andromeda/thread/scheduler.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <variant>
+#include <vector>
+
+namespace andromeda::gfx {
+
+/**
+ * @class PipelineBatch
+ * @brief Collects pipelines to be created at startup. Loading shader code and reflecting it is the expensive part of
+ *        creating a pipeline, so the create infos are built concurrently on the task scheduler. Registering the
+ *        resulting pipelines with the context is done on the main thread in finish().
+ */
+class PipelineBatch {
+public:
+    /**
+     * @var using graphics_builder = std::function<ph::PipelineCreateInfo()>
+     * @brief Function building a graphics pipeline create info. Must not register anything with the context.
+     */
+    using graphics_builder = std::function<ph::PipelineCreateInfo()>;
+
+    /**
+     * @var using compute_builder = std::function<ph::ComputePipelineCreateInfo()>
+     * @brief Function building a compute pipeline create info. Must not register anything with the context.
+     */
+    using compute_builder = std::function<ph::ComputePipelineCreateInfo()>;
+
+    PipelineBatch() = default;
+    PipelineBatch(PipelineBatch const&) = delete;
+    PipelineBatch& operator=(PipelineBatch const&) = delete;
+
+    /**
+     * @brief Waits for any builds that are still running. The built pipelines are discarded if finish() was not called.
+     */
+    ~PipelineBatch();
+
+    /**
+     * @brief Add a graphics pipeline to the batch. May only be called before compile().
+     * @param builder Function building the create info.
+     */
+    void add(graphics_builder builder);
+
+    /**
+     * @brief Add a compute pipeline to the batch. May only be called before compile().
+     * @param builder Function building the create info.
+     */
+    void add(compute_builder builder);
+
+    /**
+     * @brief Start building all pipelines in the batch. Every pipeline is built in a separate task.
+     * @param scheduler The task scheduler to run the builds on.
+     */
+    void compile(thread::TaskScheduler& scheduler);
+
+    /**
+     * @brief Wait for all builds to complete and register the pipelines with the context. Must be called on the main thread.
+     *        If compile() was never called the pipelines are built on the calling thread.
+     * @param ctx Reference to the graphics context.
+     */
+    void finish(gfx::Context& ctx);
+
+    /**
+     * @brief Get the amount of pipelines in the batch.
+     */
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::variant<graphics_builder, compute_builder> builder;
+        std::variant<std::monostate, ph::PipelineCreateInfo, ph::ComputePipelineCreateInfo> result;
+    };
+
+    std::vector<Entry> entries;
+    // Completes when every build has completed. Only valid after compile().
+    thread::task_handle done{};
+
+    static void build(Entry& entry);
+};
+
+} // namespace andromeda::gfx
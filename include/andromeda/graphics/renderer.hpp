@@ -1,11 +1,13 @@
 #pragma once
 
 #include <andromeda/app/wsi.hpp>
+#include <andromeda/ecs/system_scheduler.hpp>
 #include <andromeda/graphics/backend/renderer_backend.hpp>
 #include <andromeda/graphics/backend/debug_geometry.hpp>
 #include <andromeda/graphics/context.hpp>
 #include <andromeda/graphics/scene_description.hpp>
 #include <andromeda/graphics/viewport.hpp>
+#include <andromeda/math/bounds.hpp>
 #include <andromeda/world.hpp>
 
 #include <array>
@@ -34,12 +36,26 @@ public:
     void shutdown(gfx::Context& ctx);
 
     /**
-     * @brief Render a single frame. Must be called on the main thread.
+     * @brief Registers the systems that extract render data from the world. These systems fill the scene description
+     *        that is rendered in render_frame().
+     * @param systems Reference to the system scheduler.
+     * @param world Reference to the world the systems will run on. Used to access the spatial index.
+     */
+    void register_systems(ecs::SystemScheduler& systems, World const& world);
+
+    /**
+     * @brief Prepares the scene description for a new frame. Must be called on the main thread before running
+     *        the systems registered in register_systems().
+     * @param dirty Whether the scene was modified since last frame
+     */
+    void begin_frame(bool dirty);
+
+    /**
+     * @brief Render a single frame. Must be called on the main thread, after the systems for this frame have completed.
      * @param ctx Reference to the graphics context.
      * @param world Reference to the world to render.
-     * @param dirty Whether the scene was modified since last frame
     */
-    void render_frame(gfx::Context& ctx, World const& world, bool dirty);
+    void render_frame(gfx::Context& ctx, World const& world);
 
     /**
      * @brief Creates a new viewport with given size.
@@ -86,6 +102,15 @@ public:
     */
     std::vector<std::string> get_debug_views(gfx::Viewport viewport);
 
+    /**
+     * @brief Computes a world space ray through a point on a viewport, using the camera of the last rendered frame.
+     * @param viewport The viewport to cast the ray from. Must have a camera.
+     * @param x Horizontal position on the viewport, from 0 (left) to 1 (right).
+     * @param y Vertical position on the viewport, from 0 (top) to 1 (bottom).
+     * @return Ray starting at the near plane with a normalized direction.
+     */
+    math::Ray get_camera_ray(gfx::Viewport const& viewport, float x, float y) const;
+
 private:
     std::unique_ptr<backend::RendererBackend> impl{};
     SceneDescription scene;
@@ -99,7 +124,7 @@ private:
     };
     std::array<ViewportData, gfx::MAX_VIEWPORTS> viewports{};
 
-    void fill_scene_description(World const& world);
+    void fill_scene_description(gfx::Context& ctx, World const& world);
 };
 
 } // namespace gfx
@@ -8,7 +8,9 @@
 #include <andromeda/ecs/registry.hpp>
 #include <andromeda/graphics/forward.hpp>
 #include <andromeda/graphics/viewport.hpp>
+#include <andromeda/math/bvh.hpp>
 #include <andromeda/thread/locked_value.hpp>
+#include <andromeda/thread/scheduler.hpp>
 #include <andromeda/util/handle.hpp>
 
 #include <phobos/image.hpp>
@@ -61,6 +63,11 @@ public:
          * @brief Whether this draw occludes light and this casts a shadow.
          */
         bool occluder = true;
+
+        /**
+         * @brief Entity this draw was created from. Used to match draws with results from the spatial index.
+         */
+        ecs::entity_t entity = ecs::no_entity;
     };
 
 
@@ -142,8 +149,9 @@ public:
      * @param material Handle to the material to draw this mesh with.
      * @param occluder Whether this mesh should occlude light and thus cast a shadow TODO: Move this to material settings?
      * @param transform Transformation matrix.
+     * @param entity The entity this draw belongs to.
     */
-    void add_draw(Handle<gfx::Mesh> mesh, Handle<gfx::Material> material, bool occluder, glm::mat4 const& transform);
+    void add_draw(Handle<gfx::Mesh> mesh, Handle<gfx::Material> material, bool occluder, glm::mat4 const& transform, ecs::entity_t entity);
 
     /**
      * @brief Register a material. All used materials must be added through this function.
@@ -173,6 +181,15 @@ public:
     */
     void add_viewport(gfx::Viewport const& vp, thread::LockedValue<const ecs::registry> const& ecs, ecs::entity_t camera);
 
+    /**
+     * @brief Determines which draws are visible from a viewport's camera. Must be called after all draws were added and
+     *        after the viewport was added with add_viewport().
+     * @param vp Viewport to cull draws for.
+     * @param bvh The world's spatial index. Draws whose entity is not in the spatial index are culled.
+     * @param scheduler Task scheduler used to sort the visible draws. Different viewports may be culled concurrently.
+     */
+    void cull_viewport(gfx::Viewport const& vp, math::BVH const& bvh, thread::TaskScheduler& scheduler);
+
     /**
      * @brief Sets the default albedo texture. This will be used as a placeholder if no albedo texture was loaded.
      * @param handle Handle to the default albedo texture to use. This may not be a null handle.
@@ -237,6 +254,14 @@ public:
      */
     std::span<glm::mat4 const> get_draw_transforms() const;
 
+    /**
+     * @brief Get the indices of all draws that are visible in a viewport, in increasing order.
+     *        Only valid after calling cull_viewport() for this viewport.
+     * @param vp Viewport to get visible draws for.
+     * @return Span over the indices of all visible draws.
+     */
+    std::span<uint32_t const> get_visible_draws(gfx::Viewport const& vp) const;
+
     /**
      * @brief Get information for a camera associated with a certain viewport.s
      * @param vp Viewport to get the camera info for.
@@ -292,6 +317,15 @@ private:
      *        so we can upload it to the GPU buffer in a single memcpy()
      */
     std::vector<glm::mat4> draw_transforms;
+    /**
+     * @brief Maps entity IDs to indices in the draws vector. Entity IDs are allocated sequentially, so a flat array
+     *        is used instead of a hash map. Entries of entities without a draw are set to no_draw.
+     */
+    std::vector<uint32_t> entity_draws;
+    static constexpr uint32_t no_draw = static_cast<uint32_t>(-1);
+
+    // Indices of visible draws for each viewport, filled by cull_viewport()
+    std::array<std::vector<uint32_t>, gfx::MAX_VIEWPORTS> visible_draws;
 
     // Each camera is indexed by a viewport index.
     std::array<CameraInfo, gfx::MAX_VIEWPORTS> cameras;
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <phobos/context.hpp>
+
+#include <andromeda/thread/coroutine.hpp>
+#include <andromeda/thread/inline_function.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace andromeda::gfx {
+
+/**
+ * @class UploadService
+ * @brief Batches CPU to GPU uploads. Owns a large persistently mapped staging buffer that is used as a ring. Loaders
+ *        write their data into staging memory from allocate(), then queue the commands copying it to its destination
+ *        with upload() or submit(). Once per frame, flush() records every queued upload into a single command buffer
+ *        and submits it to the transfer queue. When that submission has completed, its staging memory is reused and the
+ *        uploads are completed.
+ *
+ *        Uploads that don't fit in the ring get their own staging buffer, which is destroyed when their batch completes.
+ */
+class UploadService {
+public:
+    /**
+     * @struct Staging
+     * @brief Staging memory for a single upload.
+     */
+    struct Staging {
+        // Mapped memory to write the data to.
+        std::byte* memory = nullptr;
+        // The same memory, as a slice of the staging buffer. Use this as the source of the copy commands.
+        ph::BufferSlice slice{};
+
+        /**
+         * @brief Get a part of the staging memory as a slice, for uploads that copy to multiple destinations.
+         * @param offset Offset from the start of the staging memory.
+         * @param size Size of the slice in bytes.
+         */
+        ph::BufferSlice sub_slice(VkDeviceSize offset, VkDeviceSize size) const {
+            return buffer.slice(base + offset, size);
+        }
+
+    private:
+        friend class UploadService;
+
+        // The buffer this memory is in, and the offset of the memory in it.
+        ph::RawBuffer buffer{};
+        VkDeviceSize base = 0;
+        // Index of the allocation in the ring, only valid if the buffer is not dedicated.
+        uint64_t allocation = 0;
+        // Separate staging buffer, for uploads that don't fit in the ring.
+        bool dedicated = false;
+    };
+
+    /**
+     * @var using record_function = thread::inline_function<void(ph::CommandBuffer&)>
+     * @brief Records the commands for an upload. Called on the main thread during flush(), so it must capture everything
+     *        it needs by value.
+     */
+    using record_function = thread::inline_function<void(ph::CommandBuffer& /*cmd*/)>;
+
+    /**
+     * @var using completion_function = thread::inline_function<void()>
+     * @brief Called on the main thread once the commands of an upload have completed on the GPU.
+     */
+    using completion_function = thread::inline_function<void()>;
+
+    /**
+     * @class Awaiter
+     * @brief Awaiter suspending an async_task until an upload has completed. Obtained from UploadService::upload().
+     */
+    class Awaiter {
+    public:
+        Awaiter(UploadService& service, Staging staging, record_function record);
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<thread::async_task::promise_type> coroutine);
+        void await_resume() const noexcept {}
+
+    private:
+        UploadService& service;
+        Staging staging;
+        record_function record;
+    };
+
+    // Size of the staging ring.
+    static constexpr VkDeviceSize ring_size = 64 * 1024 * 1024; // 64 MiB
+
+    /**
+     * @brief Creates the staging ring.
+     * @param ctx The graphics context.
+     */
+    explicit UploadService(ph::Context& ctx);
+
+    UploadService(UploadService const&) = delete;
+    UploadService& operator=(UploadService const&) = delete;
+
+    /**
+     * @brief Waits for all submitted uploads to complete and destroys the staging ring. Completion callbacks are not
+     *        called anymore, so coroutines still waiting on an upload never resume. Drain the service with wait_all()
+     *        before shutting down the scheduler.
+     */
+    ~UploadService();
+
+    /**
+     * @brief Allocate staging memory. Thread safe. Every allocation must be passed to upload(), submit() or discard(),
+     *        or its part of the ring is never reused.
+     * @param size Size of the allocation in bytes.
+     * @param alignment Required alignment of the allocation's offset in the staging buffer. Does not have to be a power
+     *        of two, so it can be a multiple of the texel size of a format.
+     * @return The staging memory.
+     */
+    Staging allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    /**
+     * @brief Queue an upload and get an awaiter that resumes the calling coroutine once it has completed.
+     *        Usage: co_await uploads.upload(staging, [=](ph::CommandBuffer& cmd) { ... });
+     * @param staging The staging memory of the upload.
+     * @param record Records the copy commands.
+     * @return An awaiter for the upload.
+     */
+    Awaiter upload(Staging staging, record_function record);
+
+    /**
+     * @brief Queue an upload. Thread safe.
+     * @param staging The staging memory of the upload.
+     * @param record Records the copy commands.
+     * @param on_complete Called on the main thread once the upload has completed.
+     */
+    void submit(Staging staging, record_function record, completion_function on_complete);
+
+    /**
+     * @brief Give back staging memory without uploading anything, for example when unpacking data into it failed. Thread
+     *        safe.
+     * @param staging The staging memory to free.
+     */
+    void discard(Staging staging);
+
+    /**
+     * @brief Complete the batches that have finished, then submit all queued uploads in a single batch. Must be called
+     *        from the main thread, typically once per frame.
+     */
+    void flush();
+
+    /**
+     * @brief Submit all queued uploads and wait until every submitted batch has completed, running its completion
+     *        callbacks. Uploads queued by coroutines that are resumed by this are not waited for, so call this until
+     *        is_idle() returns true to drain the service completely. Must be called from the main thread.
+     */
+    void wait_all();
+
+    /**
+     * @brief Check if no uploads are queued or in flight. Must be called from the main thread.
+     */
+    [[nodiscard]] bool is_idle();
+
+private:
+    struct Upload {
+        Staging staging;
+        record_function record;
+        completion_function on_complete;
+    };
+
+    struct Batch {
+        ph::CommandBuffer cmd;
+        VkFence fence = nullptr;
+        std::vector<Upload> uploads;
+    };
+
+    struct Allocation {
+        // Position in the ring right after this allocation.
+        uint64_t end = 0;
+        bool completed = false;
+    };
+
+    // Command buffers are recorded on the main thread, which uses command pool 0.
+    static constexpr uint32_t main_thread = 0;
+
+    ph::Context& ctx;
+    ph::RawBuffer ring{};
+    std::byte* ring_memory = nullptr;
+
+    // Positions only ever increase, the offset in the ring is the position modulo ring_size. Everything from tail up to
+    // head may be in use.
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    // Allocations that were not completed yet, in order. The front has index first_allocation.
+    std::deque<Allocation> allocations;
+    uint64_t first_allocation = 0;
+    // Uploads waiting for the next flush().
+    std::vector<Upload> queued;
+    // Protects everything above.
+    std::mutex mutex;
+
+    // Submitted batches, in submission order. Only accessed on the main thread.
+    std::deque<Batch> in_flight;
+
+    // Free the command buffer, fence and staging memory of a batch that has completed.
+    void retire(Batch& batch);
+    void release(Staging& staging);
+};
+
+} // namespace andromeda::gfx
@@ -0,0 +1,130 @@
+#pragma once
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <array>
+#include <limits>
+#include <optional>
+
+namespace andromeda::math {
+
+/**
+ * @struct AABB
+ * @brief Axis-aligned bounding box. A default constructed AABB is empty, merging anything into it yields the other box.
+ */
+struct AABB {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    /**
+     * @brief Check if this box contains any points.
+     * @return true if min <= max on every axis.
+     */
+    bool valid() const;
+
+    /**
+     * @brief Get the surface area of the box. This is used as the cost metric for the surface area heuristic.
+     * @return Surface area of the box, or zero if the box is empty.
+     */
+    float surface_area() const;
+
+    glm::vec3 center() const;
+    glm::vec3 extents() const;
+};
+
+/**
+ * @struct Sphere
+ * @brief Bounding sphere with a center and a radius.
+ */
+struct Sphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+/**
+ * @struct Ray
+ * @brief Half-line starting at an origin. The direction does not have to be normalized, but distances returned by
+ *        ray queries are in units of the direction vector's length.
+ */
+struct Ray {
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+};
+
+/**
+ * @struct Frustum
+ * @brief View frustum stored as six planes with normals pointing inwards. A point p is inside a plane if
+ *        dot(plane.xyz, p) + plane.w >= 0.
+ */
+struct Frustum {
+    // Left, right, bottom, top, near, far.
+    std::array<glm::vec4, 6> planes{};
+
+    /**
+     * @brief Extracts the frustum planes from a projection-view matrix. Expects a zero to one depth range, like all
+     *        projection matrices in andromeda.
+     * @param proj_view Projection * view matrix.
+     * @return The frustum in world space.
+     */
+    static Frustum from_matrix(glm::mat4 const& proj_view);
+};
+
+/**
+ * @brief Result of intersecting a box with a frustum.
+ */
+enum class Containment {
+    Outside,
+    Intersects,
+    Inside
+};
+
+/**
+ * @brief Creates the smallest box enclosing both boxes.
+ */
+AABB merge(AABB const& lhs, AABB const& rhs);
+
+/**
+ * @brief Grow a box by a fixed margin on every side.
+ */
+AABB expand(AABB const& box, float margin);
+
+/**
+ * @brief Computes the world space bounding box of a transformed box. The result encloses all eight transformed corners.
+ * @param box Box in local space.
+ * @param transform Local to world matrix.
+ * @return Axis-aligned box in world space.
+ */
+AABB transform_aabb(AABB const& box, glm::mat4 const& transform);
+
+/**
+ * @brief Check if the inner box lies completely inside the outer box.
+ */
+bool contains(AABB const& outer, AABB const& inner);
+
+bool overlaps(AABB const& lhs, AABB const& rhs);
+
+bool overlaps(AABB const& box, Sphere const& sphere);
+
+/**
+ * @brief Classify a box against a frustum.
+ * @return Containment::Inside if the box is fully inside all planes, Containment::Outside if it is fully
+ *         outside any plane and Containment::Intersects otherwise. This test is conservative: boxes near the corners
+ *         of the frustum may be reported as intersecting when they are not.
+ */
+Containment classify(Frustum const& frustum, AABB const& box);
+
+/**
+ * @brief Intersect a ray with a box.
+ * @param ray The ray to test.
+ * @param inv_direction Component-wise inverse of the ray direction.
+ * @param box The box to test against.
+ * @return Distance along the ray to the first intersection, or std::nullopt if there is no intersection.
+ *         Returns 0 if the ray starts inside the box.
+ */
+std::optional<float> intersect(Ray const& ray, glm::vec3 const& inv_direction, AABB const& box);
+
+} // namespace andromeda::math
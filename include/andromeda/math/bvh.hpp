@@ -0,0 +1,315 @@
+#pragma once
+
+#include <andromeda/ecs/entity.hpp>
+#include <andromeda/math/bounds.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace andromeda::math {
+
+/**
+ * @class BVH
+ * @brief Dynamic bounding volume hierarchy over entity bounds. Leaves store a slightly enlarged ('fat') box, so that
+ *        small movements do not require changes to the tree. Insertions pick a sibling using the surface area
+ *        heuristic, and every node on the path back to the root is refit and rotated when that lowers the total
+ *        surface area of the tree. This keeps the tree balanced without ever rebuilding it.
+ */
+class BVH {
+public:
+    /**
+     * @struct RayHit
+     * @brief Result of a ray query.
+     */
+    struct RayHit {
+        ecs::entity_t entity = ecs::no_entity;
+        // Distance along the ray to the entry point of the entity's bounding box.
+        float distance = 0.0f;
+    };
+
+    /**
+     * @brief Creates an empty BVH.
+     * @param margin Amount to enlarge leaf boxes by on every side. Larger values make updates cheaper for moving
+     *               objects, at the cost of looser queries.
+     */
+    explicit BVH(float margin = 0.1f);
+
+    /**
+     * @brief Add an entity to the tree. If the entity is already present this is equivalent to update().
+     * @param entity The entity to insert.
+     * @param bounds World space bounds of the entity.
+     */
+    void insert(ecs::entity_t entity, AABB const& bounds);
+
+    /**
+     * @brief Remove an entity from the tree. Does nothing if the entity is not present.
+     * @param entity The entity to remove.
+     */
+    void remove(ecs::entity_t entity);
+
+    /**
+     * @brief Update the bounds of an entity, inserting it if it is not yet present.
+     *        This is cheap if the new bounds still fit inside the enlarged box stored in the tree.
+     * @param entity The entity to update.
+     * @param bounds New world space bounds of the entity.
+     * @return true if the tree was modified.
+     */
+    bool update(ecs::entity_t entity, AABB const& bounds);
+
+    /**
+     * @brief Check if an entity is stored in the tree.
+     */
+    bool contains(ecs::entity_t entity) const;
+
+    /**
+     * @brief Remove all entities from the tree.
+     */
+    void clear();
+
+    /**
+     * @brief Get the amount of entities stored in the tree.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the enlarged bounds stored for an entity.
+     * @param entity Entity to get the bounds of. Must be present in the tree.
+     */
+    AABB const& get_bounds(ecs::entity_t entity) const;
+
+    /**
+     * @brief Get the height of the tree. An empty tree has height zero, a tree with one entity has height one.
+     */
+    int32_t height() const;
+
+    /**
+     * @brief Call a function for every entity whose bounds overlap a box.
+     * @param box Query box.
+     * @param callback Function taking an ecs::entity_t.
+     */
+    template<typename F>
+    void query(AABB const& box, F&& callback) const {
+        traverse([&box](AABB const& bounds) { return overlaps(bounds, box); }, callback);
+    }
+
+    /**
+     * @brief Call a function for every entity whose bounds overlap a sphere.
+     * @param sphere Query sphere.
+     * @param callback Function taking an ecs::entity_t.
+     */
+    template<typename F>
+    void query(Sphere const& sphere, F&& callback) const {
+        traverse([&sphere](AABB const& bounds) { return overlaps(bounds, sphere); }, callback);
+    }
+
+    /**
+     * @brief Check if the bounds of any entity overlap a box. Stops at the first overlapping entity.
+     * @param box Query box.
+     */
+    bool any_overlap(AABB const& box) const;
+
+    /**
+     * @brief Check if the bounds of any entity overlap a sphere. Stops at the first overlapping entity.
+     * @param sphere Query sphere.
+     */
+    bool any_overlap(Sphere const& sphere) const;
+
+    /**
+     * @brief Call a function for every entity whose bounds are (partially) inside a frustum. Subtrees fully inside
+     *        the frustum are reported without testing their children.
+     * @param frustum Query frustum.
+     * @param callback Function taking an ecs::entity_t.
+     */
+    template<typename F>
+    void query(Frustum const& frustum, F&& callback) const {
+        if (root == null_node) { return; }
+        std::vector<int32_t> stack{};
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t const index = stack.back();
+            stack.pop_back();
+            Node const& node = nodes[index];
+
+            Containment const result = classify(frustum, node.bounds);
+            if (result == Containment::Outside) { continue; }
+            if (result == Containment::Inside) {
+                report_subtree(index, callback);
+            } else if (node.is_leaf()) {
+                callback(node.entity);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    /**
+     * @brief Call a function for every entity whose bounds are hit by a ray.
+     * @param ray Query ray.
+     * @param max_distance Ignore hits further than this distance.
+     * @param callback Function taking an ecs::entity_t and the hit distance.
+     */
+    template<typename F>
+    void query(Ray const& ray, float max_distance, F&& callback) const {
+        glm::vec3 const inv_direction = 1.0f / ray.direction;
+        for_each_ray_hit(ray, inv_direction, max_distance, [&callback](ecs::entity_t entity, float distance) {
+            callback(entity, distance);
+            return false;
+        });
+    }
+
+    /**
+     * @brief Find the entity whose bounds are hit first by a ray.
+     * @param ray Query ray.
+     * @param max_distance Ignore hits further than this distance.
+     * @return The closest hit, or std::nullopt if nothing was hit.
+     */
+    std::optional<RayHit> raycast(Ray const& ray, float max_distance = std::numeric_limits<float>::max()) const;
+
+    /**
+     * @brief Call a function for every entity in the tree.
+     * @param callback Function taking an ecs::entity_t and its (enlarged) AABB.
+     */
+    template<typename F>
+    void for_each(F&& callback) const {
+        for (auto const& [entity, index]: leaves) {
+            callback(entity, nodes[index].bounds);
+        }
+    }
+
+private:
+    static constexpr int32_t null_node = -1;
+
+    struct Node {
+        AABB bounds{};
+        int32_t parent = null_node;
+        int32_t left = null_node;
+        int32_t right = null_node;
+        // Leaves have height 0. Free nodes have height -1.
+        int32_t height = 0;
+        ecs::entity_t entity = ecs::no_entity;
+
+        bool is_leaf() const {
+            return left == null_node;
+        }
+    };
+
+    float margin;
+    int32_t root = null_node;
+    // Node pool. Free nodes are chained through their parent index.
+    std::vector<Node> nodes;
+    int32_t free_list = null_node;
+    std::unordered_map<ecs::entity_t, int32_t> leaves;
+
+    int32_t allocate_node();
+    void free_node(int32_t index);
+
+    void insert_leaf(int32_t leaf);
+    void remove_leaf(int32_t leaf);
+    int32_t find_best_sibling(AABB const& bounds) const;
+    // Refits and rotates every node from index up to the root.
+    void refit_ancestors(int32_t index);
+    void rotate(int32_t index);
+
+    template<typename Overlap, typename F>
+    void traverse(Overlap&& test, F&& callback) const {
+        if (root == null_node) { return; }
+        std::vector<int32_t> stack{};
+        stack.push_back(root);
+        while (!stack.empty()) {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!test(node.bounds)) { continue; }
+            if (node.is_leaf()) {
+                callback(node.entity);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    // Like traverse(), but returns true as soon as a leaf passes the test.
+    template<typename Overlap>
+    bool find_leaf(Overlap&& test) const {
+        if (root == null_node) { return false; }
+        std::vector<int32_t> stack{};
+        stack.push_back(root);
+        while (!stack.empty()) {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!test(node.bounds)) { continue; }
+            if (node.is_leaf()) { return true; }
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+        return false;
+    }
+
+    template<typename F>
+    void report_subtree(int32_t index, F& callback) const {
+        std::vector<int32_t> stack{};
+        stack.push_back(index);
+        while (!stack.empty()) {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+            if (node.is_leaf()) {
+                callback(node.entity);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    // Visits every leaf hit by the ray, nearest subtrees first. The callback returns a bool, if it returns true
+    // the hit distance becomes the new maximum distance.
+    template<typename F>
+    void for_each_ray_hit(Ray const& ray, glm::vec3 const& inv_direction, float max_distance, F&& callback) const {
+        if (root == null_node) { return; }
+        struct Entry {
+            int32_t index;
+            float distance;
+        };
+        std::vector<Entry> stack{};
+        if (auto t = intersect(ray, inv_direction, nodes[root].bounds); t && *t <= max_distance) {
+            stack.push_back({root, *t});
+        }
+        while (!stack.empty()) {
+            Entry const entry = stack.back();
+            stack.pop_back();
+            // The maximum distance may have shrunk since this entry was pushed.
+            if (entry.distance > max_distance) { continue; }
+
+            Node const& node = nodes[entry.index];
+            if (node.is_leaf()) {
+                if (callback(node.entity, entry.distance)) { max_distance = entry.distance; }
+                continue;
+            }
+
+            auto t_left = intersect(ray, inv_direction, nodes[node.left].bounds);
+            auto t_right = intersect(ray, inv_direction, nodes[node.right].bounds);
+            bool const hit_left = t_left && *t_left <= max_distance;
+            bool const hit_right = t_right && *t_right <= max_distance;
+            // Push the furthest child first so the nearest one is visited first.
+            if (hit_left && hit_right) {
+                if (*t_left < *t_right) {
+                    stack.push_back({node.right, *t_right});
+                    stack.push_back({node.left, *t_left});
+                } else {
+                    stack.push_back({node.left, *t_left});
+                    stack.push_back({node.right, *t_right});
+                }
+            } else if (hit_left) {
+                stack.push_back({node.left, *t_left});
+            } else if (hit_right) {
+                stack.push_back({node.right, *t_right});
+            }
+        }
+    }
+};
+
+} // namespace andromeda::math
@@ -12,6 +12,10 @@
 
 #include <unordered_map>
 
+namespace andromeda {
+struct Transform;
+}
+
 namespace glm {
 /**
  * @brief Construct a rotation matrix around multiple euler angles
@@ -34,6 +38,22 @@ namespace andromeda::math {
 */
 glm::mat4 local_to_world(ecs::entity_t ent, thread::LockedValue<ecs::registry const> const& ecs, std::unordered_map<ecs::entity_t, glm::mat4>& lookup);
 
+/**
+ * @brief Computes the transform matrix of an entity's local space to its parent's space.
+ * @param transform Transform component of the entity.
+ * @return A matrix applying the translation, rotation and scale of the transform.
+ */
+glm::mat4 local_transform(Transform const& transform);
+
+/**
+ * @brief Updates the WorldTransform component of an entity and all its children by applying parent transforms.
+ *        Entities without a WorldTransform component are skipped, but their children are still updated.
+ * @param ecs ECS registry. Only the Transform, Hierarchy and WorldTransform components are accessed.
+ * @param root Entity to start propagating from.
+ * @param parent_transform Local to world matrix of the parent of the root entity.
+ */
+void propagate_transforms(ecs::registry& ecs, ecs::entity_t root, glm::mat4 const& parent_transform = glm::mat4(1.0f));
+
 /**
  * @brief Convert a set of euler angles defining a rotation to a direction vector relative to the default forward vector (0, 0, -1)
  * @param euler Euler angles with a given rotation (in degrees).
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace andromeda {
+namespace thread {
+
+/**
+ * @var using coroutine_function = std::function<async_task(uint32_t)>
+ * @brief Callable creating a coroutine. Takes in a single uint32_t parameter with the index of the worker thread the
+ *        coroutine will run on.
+*/
+class async_task;
+using coroutine_function = std::function<async_task(uint32_t /*thread_index*/)>;
+
+/**
+ * @struct coroutine_state
+ * @brief Everything needed to start and resume a coroutine. spawn() allocates it once, the task starting the coroutine
+ *        only holds a pointer to it, and the promise takes it over once the coroutine is started.
+ */
+struct coroutine_state {
+    TaskScheduler* scheduler = nullptr;
+    // Worker thread the coroutine runs on, known once it is started.
+    uint32_t thread = 0;
+    // Priority of the tasks starting and resuming the coroutine.
+    TaskPriority priority = TaskPriority::Normal;
+    // Event signalled when the coroutine completes.
+    task_handle completion{};
+    // Used in error messages.
+    std::string description;
+    // Only used to start the coroutine.
+    coroutine_function function;
+    cancellation_token token{};
+};
+
+/**
+ * @class async_task
+ * @brief Return type for coroutines running on the task scheduler. A coroutine is started with spawn(). It always
+ *        resumes on the worker thread it was started on, so it can keep using per-thread resources, like command
+ *        buffers allocated with that thread's index, across suspension points. While it is suspended, the worker
+ *        thread is free to run other tasks.
+ *
+ *        Inside the coroutine, co_await a task_handle to suspend until that task has completed. Other awaitables,
+ *        such as the GPU fence awaiter in gfx::Context, resume the coroutine through promise_type::resume_after().
+ *
+ *        Note that the coroutine may outlive the function that spawned it, so parameters should be passed by value.
+ */
+class async_task {
+public:
+    class promise_type {
+    public:
+        promise_type() = default;
+        // Signals the completion event of the coroutine.
+        ~promise_type();
+
+        async_task get_return_object() noexcept;
+
+        // Coroutines are started by spawn(), once we know which thread they run on.
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        // The coroutine frame destroys itself once the coroutine returns.
+        std::suspend_never final_suspend() const noexcept { return {}; }
+
+        void return_void() const noexcept {}
+        void unhandled_exception();
+
+        /**
+         * @brief Schedule the coroutine to be resumed on its worker thread. May only be called while the coroutine is
+         *        suspended, typically from an awaiter's await_suspend().
+         * @param dependencies The coroutine resumes once these tasks have completed.
+         */
+        void resume_after(dependency_list dependencies = {});
+
+    private:
+        friend class async_task;
+
+        std::unique_ptr<coroutine_state> state;
+    };
+
+    async_task() = default;
+    async_task(async_task const&) = delete;
+    async_task(async_task&& rhs) noexcept;
+    async_task& operator=(async_task const&) = delete;
+    async_task& operator=(async_task&& rhs) noexcept;
+    // Destroys the coroutine if it was never started.
+    ~async_task();
+
+    /**
+     * @brief Run the coroutine on the calling worker thread until its first suspension point.
+     *        After this call, the coroutine owns itself and this object is empty.
+     * @param state Scheduler, priority, completion event and description of the coroutine. Owned by the coroutine
+     *        from now on.
+     * @param thread_index Index of the calling worker thread. The coroutine always resumes on this thread.
+     */
+    void start(std::unique_ptr<coroutine_state> state, uint32_t thread_index);
+
+private:
+    explicit async_task(std::coroutine_handle<promise_type> coroutine);
+
+    std::coroutine_handle<promise_type> coroutine{};
+};
+
+/**
+ * @brief Start a coroutine on a worker thread of the scheduler.
+ * @param scheduler The task scheduler to run the coroutine on.
+ * @param function Function creating the coroutine. Called on the worker thread the coroutine will run on.
+ * @param description Description of the coroutine, used when reporting exceptions.
+ * @param priority Priority of the task starting the coroutine, and of every task resuming it.
+ * @param token If this token is cancelled before the coroutine starts, it is never created. Once started, a coroutine
+ *        always runs to completion, so it should check the token itself to stop early.
+ * @return A handle that completes when the coroutine has returned. Can be used as a task dependency.
+*/
+task_handle spawn(TaskScheduler& scheduler, coroutine_function function, std::string description,
+                  TaskPriority priority = TaskPriority::Normal, cancellation_token token = {});
+
+/**
+ * @class task_awaiter
+ * @brief Awaiter to suspend an async_task until a task has completed. Obtained by using co_await on a task_handle.
+ */
+class task_awaiter {
+public:
+    explicit task_awaiter(task_handle task);
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<async_task::promise_type> coroutine) const;
+    void await_resume() const noexcept {}
+
+private:
+    task_handle task;
+};
+
+task_awaiter operator co_await(task_handle task);
+
+} // namespace thread
+} // namespace andromeda
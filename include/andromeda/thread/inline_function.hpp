@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace andromeda {
+namespace thread {
+
+template<typename Signature, std::size_t Capacity = 64>
+class inline_function;
+
+/**
+ * @class inline_function
+ * @brief Move-only replacement for std::function that stores callables of up to Capacity bytes inside the object itself,
+ *        so wrapping a small lambda never allocates. Larger callables, or callables that may throw while being moved,
+ *        are stored on the heap instead.
+ * @tparam R Return type of the function.
+ * @tparam Args Argument types of the function.
+ * @tparam Capacity Size of the inline buffer in bytes.
+ */
+template<typename R, typename... Args, std::size_t Capacity>
+class inline_function<R(Args...), Capacity> {
+public:
+    inline_function() = default;
+
+    inline_function(std::nullptr_t) noexcept {}
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, inline_function>
+                                                     && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+    inline_function(F&& function) {
+        using Callable = std::decay_t<F>;
+        if constexpr (stored_inline<Callable>) {
+            ::new (static_cast<void*>(&storage)) Callable(std::forward<F>(function));
+        } else {
+            ::new (static_cast<void*>(&storage)) Callable*(new Callable(std::forward<F>(function)));
+        }
+        ops = &operations<Callable>;
+    }
+
+    inline_function(inline_function&& rhs) noexcept {
+        move_from(rhs);
+    }
+
+    inline_function& operator=(inline_function&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            move_from(rhs);
+        }
+        return *this;
+    }
+
+    inline_function& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    inline_function(inline_function const&) = delete;
+    inline_function& operator=(inline_function const&) = delete;
+
+    ~inline_function() {
+        reset();
+    }
+
+    R operator()(Args... args) {
+        return ops->invoke(&storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    /**
+     * @brief Destroy the stored callable, leaving the function empty.
+     */
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(&storage);
+            ops = nullptr;
+        }
+    }
+
+    // Whether a callable of this type is stored inside the object, so wrapping it does not allocate.
+    template<typename Callable>
+    static constexpr bool stored_inline = sizeof(Callable) <= Capacity
+                                          && alignof(Callable) <= alignof(std::max_align_t)
+                                          && std::is_nothrow_move_constructible_v<Callable>;
+
+private:
+    struct Operations {
+        R (*invoke)(void* storage, Args&&... args);
+        // Move constructs the callable into dst and destroys the one in src.
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename Callable>
+    static Callable& get(void* storage) {
+        if constexpr (stored_inline<Callable>) {
+            return *std::launder(static_cast<Callable*>(storage));
+        } else {
+            return **std::launder(static_cast<Callable**>(storage));
+        }
+    }
+
+    template<typename Callable>
+    static constexpr Operations operations = {
+        [](void* storage, Args&&... args) -> R {
+            return std::invoke(get<Callable>(storage), std::forward<Args>(args)...);
+        },
+        [](void* dst, void* src) noexcept {
+            if constexpr (stored_inline<Callable>) {
+                Callable& callable = get<Callable>(src);
+                ::new (dst) Callable(std::move(callable));
+                callable.~Callable();
+            } else {
+                // Only the pointer moves, the callable itself stays where it is.
+                ::new (dst) Callable*(&get<Callable>(src));
+            }
+        },
+        [](void* storage) noexcept {
+            if constexpr (stored_inline<Callable>) {
+                get<Callable>(storage).~Callable();
+            } else {
+                delete &get<Callable>(storage);
+            }
+        }
+    };
+
+    alignas(std::max_align_t) std::byte storage[Capacity];
+    Operations const* ops = nullptr;
+
+    void move_from(inline_function& rhs) noexcept {
+        if (rhs.ops) {
+            rhs.ops->move(&storage, &rhs.storage);
+            ops = std::exchange(rhs.ops, nullptr);
+        }
+    }
+};
+
+} // namespace thread
+} // namespace andromeda
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <andromeda/thread/coroutine.hpp>
+#include <andromeda/thread/inline_function.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace andromeda {
+namespace thread {
+
+/**
+ * @struct FileContents
+ * @brief Result of reading a file with the IOService.
+ */
+struct FileContents {
+    bool success = false;
+    std::vector<std::byte> data;
+};
+
+/**
+ * @class IOService
+ * @brief Reads files asynchronously, without blocking a thread per read. On Linux, reads are submitted to an io_uring
+ *        instance owned by a single background thread, which keeps many reads for many files in flight at once. Large
+ *        files are split into chunks that are read in parallel. On other platforms, or if io_uring is not available,
+ *        every read is a blocking task on the scheduler's I/O threads instead.
+ */
+class IOService {
+public:
+    /**
+     * @var using read_callback = inline_function<void(FileContents)>
+     * @brief Called once a read has completed. May be called on the io_uring thread, so it should only hand off work,
+     *        for example by scheduling a task.
+     */
+    using read_callback = inline_function<void(FileContents /*contents*/)>;
+
+    /**
+     * @class Awaiter
+     * @brief Awaiter suspending an async_task until a file has been read. Obtained from IOService::read(). co_await
+     *        evaluates to the FileContents of the read.
+     */
+    class Awaiter {
+    public:
+        Awaiter(IOService& service, std::string path);
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<async_task::promise_type> coroutine);
+        FileContents await_resume() noexcept { return std::move(contents); }
+
+    private:
+        IOService& service;
+        std::string path;
+        FileContents contents{};
+    };
+
+    class Backend;
+
+    /**
+     * @brief Starts the I/O backend.
+     * @param scheduler Scheduler used by the fallback backend.
+     */
+    explicit IOService(TaskScheduler& scheduler);
+
+    IOService(IOService const&) = delete;
+    IOService& operator=(IOService const&) = delete;
+
+    /**
+     * @brief Waits for reads that are in progress to finish. Their callbacks, and those of reads that did not start yet,
+     *        are not called.
+     */
+    ~IOService();
+
+    /**
+     * @brief Read a whole file asynchronously. Thread safe.
+     * @param path Path to the file.
+     * @param on_complete Called with the contents of the file once it has been read.
+     */
+    void read_file(std::string path, read_callback on_complete);
+
+    /**
+     * @brief Get an awaiter to read a file inside an async_task. The coroutine resumes on its own worker thread.
+     *        Usage: thread::FileContents file = co_await io.read(path);
+     * @param path Path to the file.
+     */
+    Awaiter read(std::string path);
+
+    /**
+     * @brief Get the name of the backend in use, for logging.
+     */
+    char const* backend_name() const;
+
+private:
+    std::unique_ptr<Backend> backend;
+};
+
+} // namespace thread
+} // namespace andromeda
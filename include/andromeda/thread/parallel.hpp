@@ -0,0 +1,118 @@
+#pragma once
+
+#include <andromeda/thread/scheduler.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace andromeda {
+namespace thread {
+
+/**
+ * @var using range_function = std::function<void(std::size_t, std::size_t)>
+ * @brief Callable type for the body of a parallel loop. Takes the half-open range of indices [begin, end) to process.
+*/
+using range_function = std::function<void(std::size_t /*begin*/, std::size_t /*end*/)>;
+
+/**
+ * @brief Get the grain size used for a loop over a number of elements when no grain size is given. This creates a few
+ *        chunks per thread, so threads that finish early can pick up the remaining work.
+ * @param scheduler The task scheduler the loop will run on.
+ * @param count The amount of elements in the loop.
+ * @return The amount of elements per chunk, at least one.
+*/
+std::size_t default_grain_size(TaskScheduler const& scheduler, std::size_t count);
+
+/**
+ * @brief Run a loop body over the range [0, count) in parallel. The range is split into chunks of grain elements, which
+ *        are processed by the worker threads and by the calling thread. Returns once every chunk was processed.
+ *        Calls may be nested, since worker threads waiting for the loop keep executing other tasks.
+ * @param scheduler The task scheduler to run the loop on.
+ * @param count The amount of elements in the loop.
+ * @param grain The amount of elements per chunk. When zero, default_grain_size() is used.
+ * @param function Called once for every chunk. Since chunks may also run on the calling thread, this does not receive
+ *        a thread index, so it should not use per-thread resources. Must not throw.
+*/
+void parallel_for(TaskScheduler& scheduler, std::size_t count, std::size_t grain, range_function const& function);
+
+/**
+ * @brief Reduce the range [0, count) in parallel. Every chunk is mapped to a partial result, the partial results are
+ *        then combined on the calling thread in increasing order of their chunks, so the result is deterministic.
+ * @param scheduler The task scheduler to run the reduction on.
+ * @param count The amount of elements in the range.
+ * @param grain The amount of elements per chunk. When zero, default_grain_size() is used.
+ * @param identity Identity value of the combine function. Also the result for an empty range.
+ * @param map Callable with signature T(std::size_t begin, std::size_t end), reducing a single chunk.
+ * @param combine Callable with signature T(T const&, T const&), combining two partial results.
+ * @return The combined result.
+*/
+template<typename T, typename Map, typename Combine>
+T parallel_reduce(TaskScheduler& scheduler, std::size_t count, std::size_t grain, T identity, Map&& map, Combine&& combine) {
+    if (grain == 0) {
+        grain = default_grain_size(scheduler, count);
+    }
+
+    std::size_t const chunks = (count + grain - 1) / grain;
+    std::vector<T> partials(chunks, identity);
+    parallel_for(scheduler, chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t chunk = first; chunk < last; ++chunk) {
+            std::size_t const begin = chunk * grain;
+            partials[chunk] = map(begin, std::min(begin + grain, count));
+        }
+    });
+
+    T result = std::move(identity);
+    for (T const& partial: partials) {
+        result = combine(result, partial);
+    }
+    return result;
+}
+
+/**
+ * @brief Sort a range in parallel. The range is split into one block per thread, the blocks are sorted concurrently
+ *        and then merged pairwise. Small ranges are sorted on the calling thread. Like std::sort, this is not stable.
+ * @param scheduler The task scheduler to run the sort on.
+ * @param first Iterator to the first element of the range.
+ * @param last Iterator past the last element of the range.
+ * @param compare Comparison function object, defaults to std::less.
+*/
+template<typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(TaskScheduler& scheduler, RandomIt first, RandomIt last, Compare compare = {}) {
+    // Below this many elements per block the sort is faster than the overhead of splitting it up.
+    constexpr std::size_t min_block_size = 4096;
+
+    std::size_t const count = static_cast<std::size_t>(std::distance(first, last));
+    std::size_t const blocks = std::min<std::size_t>(count / min_block_size, scheduler.thread_count() + 1);
+    if (blocks <= 1) {
+        std::sort(first, last, compare);
+        return;
+    }
+
+    std::size_t const block_size = (count + blocks - 1) / blocks;
+    parallel_for(scheduler, blocks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t block = begin; block < end; ++block) {
+            std::size_t const lo = std::min(block * block_size, count);
+            std::size_t const hi = std::min(lo + block_size, count);
+            std::sort(first + lo, first + hi, compare);
+        }
+    });
+
+    // Every pass merges pairs of sorted runs, doubling the run length until the whole range is one run.
+    for (std::size_t width = block_size; width < count; width *= 2) {
+        std::size_t const merges = (count + 2 * width - 1) / (2 * width);
+        parallel_for(scheduler, merges, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t merge = begin; merge < end; ++merge) {
+                std::size_t const lo = merge * 2 * width;
+                std::size_t const mid = std::min(lo + width, count);
+                std::size_t const hi = std::min(lo + 2 * width, count);
+                std::inplace_merge(first + lo, first + mid, first + hi, compare);
+            }
+        });
+    }
+}
+
+} // namespace thread
+} // namespace andromeda
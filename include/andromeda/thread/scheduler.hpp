@@ -1,34 +1,192 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
-#include <functional>
+#include <deque>
+#include <initializer_list>
 #include <mutex>
-#include <queue>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#include <andromeda/thread/inline_function.hpp>
+#include <andromeda/thread/task_group.hpp>
+#include <andromeda/thread/work_stealing_deque.hpp>
+
 
 namespace andromeda {
 namespace thread {
 
 /**
- * @var using task_id = uint32_t 
- * @brief Unique identifier type to represent tasks.
+ * @var using task_id = uint64_t
+ * @brief Unique identifier type to represent tasks. The lower 32 bits are the index of the task's slot in the scheduler,
+ *        the upper 32 bits are the generation of that slot. Slots are reused, but the generation changes every time a
+ *        task completes, so the id of a completed task never refers to a newer task.
 */
-using task_id = uint32_t;
+using task_id = uint64_t;
 
 /**
- * @var using task_function =  std::function<void(uint32_t)>
+ * @var using task_function = inline_function<void(uint32_t)>
  * @brief Callable type for tasks. Takes in a single uint32_t parameter with the index of the
- *		  thread it's running on.
+ *		  thread it's running on. Small lambdas are stored inline, so scheduling them does not allocate.
 */
-using task_function = std::function<void(uint32_t /*thread_index*/)>;
+using task_function = inline_function<void(uint32_t /*thread_index*/)>;
+
+/**
+ * @class dependency_list
+ * @brief Non-owning view of the task ids a new task depends on. Can be created from a braced list of ids, or from a
+ *        vector, so passing dependencies never copies them into a new allocation. The ids must stay alive until the
+ *        task is scheduled, which is always the case for a temporary passed directly to a schedule function.
+ */
+class dependency_list {
+public:
+    dependency_list() = default;
+    dependency_list(std::initializer_list<task_id> dependencies) : ids(dependencies.begin(), dependencies.size()) {}
+    dependency_list(std::vector<task_id> const& dependencies) : ids(dependencies) {}
+    dependency_list(std::span<task_id const> dependencies) : ids(dependencies) {}
+
+    auto begin() const { return ids.begin(); }
+    auto end() const { return ids.end(); }
+    std::size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+private:
+    std::span<task_id const> ids{};
+};
+
+class TaskScheduler;
+
+/**
+ * @enum TaskPriority
+ * @brief Priority of a task. Workers always run the highest priority task they can find. Priorities only affect the
+ *        order in which ready tasks are picked, a running task is never interrupted.
+ */
+enum class TaskPriority : uint32_t {
+    // Work the current frame is waiting on, such as systems and BLAS rebuilds.
+    FrameCritical = 0,
+    Normal,
+    // Work nobody is waiting on right now, such as streaming in assets and freeing resources.
+    Background,
+    MAX_ENUM_VALUE
+};
+
+/**
+ * @enum JobStatus
+ * @brief Returned by a main thread job after every step, to indicate whether it has more work to do.
+ */
+enum class JobStatus {
+    Done,
+    // The job is resumed in a later frame.
+    Continue
+};
+
+/**
+ * @var using main_job_function = inline_function<JobStatus(std::chrono::steady_clock::time_point)>
+ * @brief Callable type for resumable main thread jobs. Takes in the time at which the main thread's budget for this
+ *        frame runs out. A job should do work in small steps until the deadline has passed, then return
+ *        JobStatus::Continue to be resumed next frame, or JobStatus::Done once it has finished.
+*/
+using main_job_function = inline_function<JobStatus(std::chrono::steady_clock::time_point /*deadline*/)>;
+
+/**
+ * @struct SchedulerStats
+ * @brief Snapshot of the counters of a TaskScheduler, covering the time since the counters were last reset.
+ */
+struct SchedulerStats {
+    struct Thread {
+        // "worker N", "main" or "io N".
+        std::string name;
+        // Amount of tasks this thread has run.
+        uint64_t tasks = 0;
+        // Time spent running tasks. Time a task spends sleeping in wait() counts as idle time.
+        std::chrono::nanoseconds busy{};
+        // Time spent looking for work or sleeping. Always zero for the main thread, which does other work in between.
+        std::chrono::nanoseconds idle{};
+    };
+
+    // Indexed by the thread index passed to tasks.
+    std::vector<Thread> threads;
+    // Time covered by these stats.
+    std::chrono::nanoseconds elapsed{};
+    // Time between a task becoming ready to run and the task starting. For tasks without dependencies, this is the
+    // time since the task was scheduled. A high latency means tasks are starved of threads.
+    std::chrono::nanoseconds average_latency{};
+    std::chrono::nanoseconds max_latency{};
+    // Amount of tasks that are ready to run, but not started yet.
+    uint32_t queued = 0;
+    // Amount of tasks that are scheduled, but not completed yet.
+    uint32_t outstanding = 0;
+    // Amount of tasks that were dropped because their group was cancelled.
+    uint64_t cancelled = 0;
+};
+
+/**
+ * @class task_handle
+ * @brief Refers to a task scheduled on a TaskScheduler. Handles are cheap to copy and can be used to wait for the task,
+ *        or to schedule work that runs after it. A default constructed handle refers to no task and is always done.
+ *        Handles convert to task_id, so they can be passed anywhere a task id is expected.
+ */
+class task_handle {
+public:
+    task_handle() = default;
+    task_handle(TaskScheduler* scheduler, task_id id);
+
+    /**
+     * @brief Get the id of the task.
+     */
+    task_id id() const;
+
+    /**
+     * @brief Check if this handle refers to a task. Note that this is still true after the task has completed.
+     */
+    bool valid() const;
+
+    /**
+     * @brief Check if the task has completed. Always true for invalid handles.
+     */
+    bool done() const;
+
+    /**
+     * @brief Wait until the task has completed. When called from a worker thread of the scheduler, the calling thread
+     *        runs other tasks while it waits. Other threads block until the task completes.
+     */
+    void wait() const;
+
+    /**
+     * @brief Schedule a continuation that runs after this task has completed.
+     * @param function A callable function with the task to execute.
+     * @param priority Priority of the continuation.
+     * @return A handle to the continuation. If this handle is invalid, the returned handle is invalid too.
+     */
+    task_handle then(task_function function, TaskPriority priority = TaskPriority::Normal) const;
+
+    operator task_id() const;
+
+private:
+    TaskScheduler* scheduler = nullptr;
+    task_id task = static_cast<task_id>(-1);
+};
 
 /**
  * @class TaskScheduler 
  * @brief Thread pool over N threads used to schedule asynchronous tasks.
+ *        Every worker thread owns a lock-free work-stealing deque. Tasks scheduled from a worker thread are pushed to
+ *        that worker's deque, tasks scheduled from any other thread go to a shared injection queue. Idle workers steal
+ *        from the other workers' deques, and only go to sleep when no work can be found anywhere. Sleeping workers are
+ *        woken up one at a time when new work becomes available. Every priority level has its own set of queues.
+ *
+ *        Besides the workers, the scheduler owns a small pool of I/O threads for tasks that block on the disk, so those
+ *        don't occupy a worker, and a queue of tasks that must run on the main thread.
+ *
+ *        Tasks running on a worker receive the index of that worker, in [0, thread_count()). Tasks on the main thread
+ *        receive main_thread_index(), and tasks on an I/O thread an index above that. Per-thread resources such as
+ *        command pools only exist for workers, so tasks on the main or I/O threads must not use them.
 */
 class TaskScheduler {
 public:
@@ -38,8 +196,10 @@ public:
      * @brief Initialize the task scheduler.
      * @param num_threads The amount of concurrent threads. Recommended value is the amount of
      *		  available hardware threads given by std::thread::hardware_concurrency().
+     * @param num_io_threads The amount of threads for blocking I/O tasks. These mostly sleep, so they are not
+     *        included in num_threads.
     */
-    TaskScheduler(uint32_t num_threads);
+    TaskScheduler(uint32_t num_threads, uint32_t num_io_threads = 0);
 
     ~TaskScheduler();
 
@@ -47,9 +207,100 @@ public:
      * @brief Schedule a task with a number of dependencies.
      * @param function A callable function with the task to execute.
      * @param dependencies A list of task identifiers with the dependencies of this task.
-     * @return A unique identifier representing the task.
+     * @param priority Priority of the task.
+     * @param name Name of the task, shown in the timeline when recording a trace.
+     * @param token The task is dropped if this token is cancelled before the task starts.
+     * @return A handle to the task. The handle is invalid if the task could not be scheduled.
+    */
+    task_handle schedule(task_function function, dependency_list dependencies = {},
+                         TaskPriority priority = TaskPriority::Normal, std::string_view name = {},
+                         cancellation_token token = {});
+
+    /**
+     * @brief Schedule a task that must run on a specific worker thread, for example because it uses resources owned by
+     *        that thread. The task is never stolen by other workers.
+     * @param thread_index Index of the worker thread to run the task on.
+     * @param function A callable function with the task to execute.
+     * @param dependencies A list of task identifiers with the dependencies of this task.
+     * @param priority Priority of the task.
+     * @param name Name of the task, shown in the timeline when recording a trace.
+     * @param token The task is dropped if this token is cancelled before the task starts.
+     * @return A handle to the task. The handle is invalid if the task could not be scheduled.
+    */
+    task_handle schedule_on(uint32_t thread_index, task_function function, dependency_list dependencies = {},
+                            TaskPriority priority = TaskPriority::Normal, std::string_view name = {},
+                            cancellation_token token = {});
+
+    /**
+     * @brief Schedule a task that blocks on file I/O. These run on the I/O threads, in the order they became ready.
+     *        If there are no I/O threads, the task runs on a worker with background priority instead.
+     * @param function A callable function with the task to execute.
+     * @param dependencies A list of task identifiers with the dependencies of this task.
+     * @param name Name of the task, shown in the timeline when recording a trace.
+     * @param token The task is dropped if this token is cancelled before the task starts.
+     * @return A handle to the task. The handle is invalid if the task could not be scheduled.
+    */
+    task_handle schedule_io(task_function function, dependency_list dependencies = {}, std::string_view name = {},
+                            cancellation_token token = {});
+
+    /**
+     * @brief Schedule a task that must run on the main thread. These tasks run when the main thread calls
+     *        run_main_thread_tasks(), so the main thread must never wait for them.
+     * @param function A callable function with the task to execute.
+     * @param dependencies A list of task identifiers with the dependencies of this task.
+     * @param priority Priority of the task. Frame critical tasks run every frame, other tasks only while the main
+     *        thread's budget lasts.
+     * @param name Name of the task, shown in the timeline when recording a trace.
+     * @param token The task is dropped if this token is cancelled before the task starts.
+     * @return A handle to the task. The handle is invalid if the task could not be scheduled.
+    */
+    task_handle schedule_main(task_function function, dependency_list dependencies = {},
+                              TaskPriority priority = TaskPriority::Normal, std::string_view name = {},
+                              cancellation_token token = {});
+
+    /**
+     * @brief Schedule a resumable job on the main thread. The job is called once per frame with the deadline of the
+     *        frame's budget, until it returns JobStatus::Done. Use this for work that is too heavy for a single frame.
+     * @param job The job to run.
+     * @param dependencies A list of task identifiers with the dependencies of this job.
+     * @param priority Priority of every step of the job.
+     * @param name Name of the job, shown in the timeline when recording a trace.
+     * @param token If this token is cancelled, the job is not resumed anymore and completes right away.
+     * @return A handle that completes once the job is done. The handle is invalid if the job could not be scheduled.
+    */
+    task_handle schedule_main_job(main_job_function job, dependency_list dependencies = {},
+                                  TaskPriority priority = TaskPriority::Background, std::string_view name = {},
+                                  cancellation_token token = {});
+
+    /**
+     * @brief Run the main thread tasks that are ready, highest priority first. Must be called from the main thread,
+     *        typically once per frame. Frame critical tasks always run. Other tasks only start while the budget has
+     *        not run out, the rest is left for the next call. At least one of them runs per call, so they can't starve.
+     *        Tasks that become ready during this call are not run until the next call.
+     * @param budget Time the main thread may spend on tasks that are not frame critical. Unlimited by default.
+     * @return The amount of tasks that were run.
     */
-    task_id schedule(task_function function, std::vector<task_id> dependencies = {});
+    uint32_t run_main_thread_tasks(std::chrono::microseconds budget = std::chrono::microseconds::max());
+
+    /**
+     * @brief Create an event. An event is a task without a function that only completes once signal_event() is called,
+     *        so it can be used to make tasks depend on work that is not a single task, such as a coroutine.
+     * @return A handle to the event. The handle is invalid if the event could not be created.
+    */
+    task_handle create_event();
+
+    /**
+     * @brief Signal an event created with create_event(), completing it. Must be called exactly once for every event.
+     * @param event The id of the event to signal.
+    */
+    void signal_event(task_id event);
+
+    /**
+     * @brief Create a task that completes once all given tasks have completed.
+     * @param tasks The tasks to wait for. Invalid handles are ignored.
+     * @return A handle to the combined task.
+    */
+    task_handle when_all(std::vector<task_handle> const& tasks);
 
     /**
      * @brief Check if a task is currently running.
@@ -66,35 +317,259 @@ public:
     bool is_pending(task_id task);
 
     /**
-     * @brief Shuts down the task scheduler. Waits for all tasks to be completed.
+     * @brief Check if a task has completed.
+     * @param task The id of the task to check.
+     * @return true if the task has completed, or if the id does not refer to a task.
+    */
+    bool is_complete(task_id task);
+
+    /**
+     * @brief Wait until a task has completed. Worker threads of this scheduler execute other tasks while waiting,
+     *        so tasks can wait on each other without starving the thread pool. Any other thread blocks.
+     * @param task The id of the task to wait for.
+    */
+    void wait(task_id task);
+
+    /**
+     * @brief Get the amount of worker threads.
+     */
+    uint32_t thread_count() const;
+
+    /**
+     * @brief Get the thread index passed to tasks running on the main thread. Equal to thread_count().
+     */
+    uint32_t main_thread_index() const;
+
+    /**
+     * @brief Get a snapshot of the scheduler's counters.
+     */
+    SchedulerStats stats() const;
+
+    /**
+     * @brief Get the amount of tasks that are ready to run, but not started yet. Cheaper than calling stats().
+     */
+    uint32_t queue_depth() const;
+
+    /**
+     * @brief Reset all counters, so the next stats() call only covers the time after this call.
+     */
+    void reset_stats();
+
+    /**
+     * @brief Start recording a timeline of every task that runs, for export with end_trace(). While recording, the
+     *        names given to tasks are stored as well.
+     */
+    void begin_trace();
+
+    /**
+     * @brief Stop recording the timeline and write it to a file in the Chrome trace event format, which can be opened
+     *        in chrome://tracing or https://ui.perfetto.dev.
+     * @param path Path of the file to write.
+     * @return true if the file was written.
+     */
+    bool end_trace(std::string_view path);
+
+    /**
+     * @brief Check if a timeline is being recorded.
+     */
+    bool is_tracing() const;
+
+    /**
+     * @brief Shuts down the task scheduler. Waits for all tasks to be completed. Must be called from the main thread,
+     *        since main thread tasks are run while waiting.
     */
     void shutdown();
 
 private:
+    using clock = std::chrono::steady_clock;
+
+    enum class TaskState : uint32_t {
+        Free,
+        Pending,
+        Running
+    };
+
     struct Task {
-        task_id id;
         task_function function;
-        std::vector<task_id> dependencies;
+        // Incremented every time a task in this slot completes.
+        std::atomic<uint32_t> generation = 0;
+        std::atomic<TaskState> state = TaskState::Free;
+        // Amount of dependencies that have not completed yet. The task is queued when this reaches zero.
+        std::atomic<uint32_t> remaining_dependencies = 0;
+        // Slot indices of tasks depending on this task. Protected by mutex. Only cleared when the task completes, so
+        // the allocation is reused by later tasks in the same slot.
+        std::vector<uint32_t> dependents;
+        std::mutex mutex;
+        // Index of the worker this task must run on, or one of the special values below.
+        uint32_t affinity = any_thread;
+        TaskPriority priority = TaskPriority::Normal;
+        // Time at which the task was queued, used to measure how long ready tasks wait for a thread.
+        clock::time_point ready_at{};
+        // Only stored while recording a trace, so naming tasks does not cost an allocation otherwise.
+        std::string name;
+        // The task is dropped instead of run if this is cancelled.
+        cancellation_token token{};
+    };
+
+    // A task in the recorded timeline. Times are relative to the start of the trace.
+    struct TraceEvent {
+        std::string name;
+        std::chrono::nanoseconds start{};
+        std::chrono::nanoseconds duration{};
+        std::chrono::nanoseconds latency{};
+        // Amount of queued tasks when this task started.
+        uint32_t queued = 0;
     };
 
-    // The thread pool
-    std::vector<std::thread> threads;
-    // All tasks pending execution.
-    std::vector<Task> pending_tasks;
-    // All tasks currently executing
-    std::vector<Task> running_tasks;
-    // Mutex protecting the above vectors.
-    mutable std::mutex task_mutex;
-    // This condition variable will be used to notify the threads that a new task is available.
-    std::condition_variable cv;
+    // Counters for a single thread. Only written by that thread, except when they are reset.
+    struct ThreadStats {
+        std::atomic<uint64_t> tasks = 0;
+        std::atomic<uint64_t> busy_ns = 0;
+        std::atomic<uint64_t> idle_ns = 0;
+        // Start of the current idle period, or zero while the thread is not idle. Lets stats() include it.
+        std::atomic<clock::rep> idle_since = 0;
+        // Nesting depth of run_task(). Tasks run inside wait() are already part of the outer task's busy time.
+        uint32_t depth = 0;
+        clock::time_point outer_start{};
+        uint64_t outer_idle_ns = 0;
+        // Recorded timeline. The lock is only contended while the trace is being written.
+        std::vector<TraceEvent> trace;
+        std::mutex trace_mutex;
+    };
+
+    static constexpr uint32_t no_slot = static_cast<uint32_t>(-1);
+    // Special values for Task::affinity
+    static constexpr uint32_t any_thread = static_cast<uint32_t>(-1);
+    static constexpr uint32_t io_thread = static_cast<uint32_t>(-2);
+    static constexpr uint32_t main_thread = static_cast<uint32_t>(-3);
+
+    static constexpr uint32_t priority_count = static_cast<uint32_t>(TaskPriority::MAX_ENUM_VALUE);
+    // Tasks are stored in fixed size chunks so they never move while other threads access them.
+    static constexpr uint32_t chunk_size = 1024;
+    static constexpr uint32_t max_chunks = 1024;
+
+    struct Worker {
+        // One deque for every priority level.
+        std::array<WorkStealingDeque<uint32_t>, priority_count> queues;
+        std::thread thread;
+        // State for picking steal victims.
+        uint32_t random_state = 0;
+        // Tasks that may only run on this worker. These can be pushed from any thread, so they don't go in the deque.
+        std::array<std::deque<uint32_t>, priority_count> pinned;
+        std::mutex pinned_mutex;
+        // Total amount of pinned tasks over all priorities.
+        std::atomic<uint32_t> pinned_size = 0;
+    };
+
+    // The thread pool. Workers are never moved, since other threads steal from their queues.
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Tasks scheduled from outside the thread pool, one queue for every priority level.
+    std::array<std::deque<uint32_t>, priority_count> injection_queues;
+    std::mutex injection_mutex;
+    // Total size of the injection queues, so workers can check them without taking the lock.
+    std::atomic<uint32_t> injection_size = 0;
+
+    // The I/O threads and their queue. I/O threads simply sleep on io_cv when there is no work.
+    std::vector<std::thread> io_threads;
+    std::deque<uint32_t> io_queue;
+    std::mutex io_mutex;
+    std::condition_variable io_cv;
+
+    // Tasks waiting for run_main_thread_tasks(), one queue for every priority level.
+    std::array<std::deque<uint32_t>, priority_count> main_queues;
+    std::mutex main_mutex;
+    // End of the budget in the current run_main_thread_tasks() call. Only used on the main thread.
+    clock::time_point main_deadline = clock::time_point::max();
+
+    // State of a job scheduled with schedule_main_job(). Every step of the job is a separate main thread task.
+    struct MainJob {
+        main_job_function function;
+        // Event signalled when the job is done.
+        task_handle completion{};
+        TaskPriority priority = TaskPriority::Background;
+        std::string name;
+        cancellation_token token{};
+    };
+
+    // Task slot table. Chunks are allocated on demand and only freed when the scheduler is destroyed.
+    std::array<std::atomic<Task*>, max_chunks> chunks{};
+    std::atomic<uint32_t> chunk_count = 0;
+    // Indices of unused slots.
+    std::vector<uint32_t> free_slots;
+    // Mutex protecting free_slots and chunk allocation.
+    std::mutex slot_mutex;
+
+    // Idle workers wait on this condition variable.
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<uint32_t> sleeping = 0;
+    // Amount of threads inside wait(). Every completed task notifies waiting threads while this is non-zero.
+    std::atomic<uint32_t> waiting = 0;
+    // Threads outside the pool wait on this condition variable. They can't use sleep_cv, since they would swallow
+    // notifications meant for idle workers.
+    std::mutex wait_mutex;
+    std::condition_variable wait_cv;
+    // Amount of tasks that are scheduled but not yet completed.
+    std::atomic<uint32_t> outstanding = 0;
+
+    // Indexed by thread index, so this covers the workers, the main thread and the I/O threads.
+    std::vector<std::unique_ptr<ThreadStats>> thread_stats;
+    // Amount of tasks that are ready to run, but not started yet.
+    std::atomic<uint32_t> queued = 0;
+    // Sum and maximum of the time between scheduling and starting a task.
+    std::atomic<uint64_t> latency_total_ns = 0;
+    std::atomic<uint64_t> latency_max_ns = 0;
+    std::atomic<uint64_t> cancelled = 0;
+    std::atomic<clock::rep> stats_start{};
+    std::atomic<bool> tracing = false;
+    std::atomic<clock::rep> trace_start{};
+
     // Flag that will indicate to the threads that the pool should be terminated
-    std::atomic<bool> terminate;
+    std::atomic<bool> terminate = false;
     // Flag indicating that the thread pool is stopped.
-    std::atomic<bool> stopped;
+    std::atomic<bool> stopped = false;
+
+    void worker_loop(uint32_t thread_index);
+    void io_loop(uint32_t thread_index);
+    // Finds a task to run, starting at the highest priority. For each priority, the worker first looks at its pinned
+    // tasks, then its own queue, then the injection queue, then the other workers.
+    // Returns the slot index of the task, or no_slot if there is no work.
+    uint32_t find_task(uint32_t thread_index);
+    uint32_t pop_pinned(uint32_t thread_index, uint32_t priority);
+    uint32_t pop_injected(uint32_t priority);
+    uint32_t steal(uint32_t thread_index, uint32_t priority);
+    // Returns true if there is work the given worker can run.
+    bool has_work(uint32_t thread_index) const;
+
+    // External dependencies are not tasks, they are removed with signal_event().
+    task_handle schedule_task(task_function function, dependency_list dependencies, uint32_t affinity,
+                              TaskPriority priority, std::string_view name, cancellation_token token,
+                              uint32_t external_dependencies = 0);
 
-    bool is_running(task_id task, std::unique_lock<std::mutex>& lock);
+    // Runs a task, or drops it if it was cancelled, and then completes it.
+    void run_task(uint32_t slot, uint32_t thread_index);
+    // Calls the function of a task and records its stats.
+    void execute(Task& task, uint32_t thread_index, uint32_t queue_depth);
+    // Runs a step of a main thread job, and schedules the next step if the job is not done.
+    void run_main_job(std::unique_ptr<MainJob> job);
+    // Mark the start and end of a period in which a thread has no task to run.
+    clock::time_point begin_idle(uint32_t thread_index);
+    void end_idle(uint32_t thread_index, clock::time_point since);
+    // Pushes a task whose dependencies are complete to a queue and wakes up a worker.
+    void enqueue(uint32_t slot);
+    void wake_one();
+    void wake_all();
+    // Wakes up all threads inside wait().
+    void notify_waiting();
 
-    bool is_pending(task_id task, std::unique_lock<std::mutex>& lock);
+    uint32_t allocate_slot();
+    void free_slot(uint32_t slot);
+    Task& get_task(uint32_t slot);
+    // Returns the task referred to by an id, or nullptr if the id is out of range.
+    Task* lookup(task_id task);
+    // Returns true if the task referred to by an id is in a given state. Always false for completed tasks.
+    bool has_state(task_id task, TaskState state);
 };
 
 } // namespace thread
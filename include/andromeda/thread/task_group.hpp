@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace andromeda {
+namespace thread {
+
+/**
+ * @class cancellation_token
+ * @brief Read-only view of the cancellation state of a task_group. Tasks scheduled with a token are dropped without
+ *        running if the group is cancelled before they start. Running tasks can check the token themselves and stop
+ *        early. A default constructed token is never cancelled.
+ */
+class cancellation_token {
+public:
+    cancellation_token() = default;
+
+    /**
+     * @brief Check if the group this token belongs to was cancelled.
+     */
+    bool cancelled() const {
+        return state != nullptr && state->load(std::memory_order_acquire);
+    }
+
+private:
+    friend class task_group;
+
+    explicit cancellation_token(std::shared_ptr<std::atomic<bool> const> state) : state(std::move(state)) {}
+
+    std::shared_ptr<std::atomic<bool> const> state{};
+};
+
+/**
+ * @class task_group
+ * @brief Group of tasks that can be cancelled together. Pass the group's token() when scheduling tasks to add them to
+ *        the group. Copies of a task_group refer to the same group.
+ */
+class task_group {
+public:
+    task_group() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    /**
+     * @brief Get a token to schedule tasks in this group with.
+     */
+    cancellation_token token() const {
+        return cancellation_token{state};
+    }
+
+    /**
+     * @brief Cancel all tasks in the group. Tasks that did not start yet are dropped, running tasks are not interrupted.
+     *        Cancelling a group can not be undone.
+     */
+    void cancel() {
+        state->store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check if the group was cancelled.
+     */
+    bool cancelled() const {
+        return state->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+} // namespace thread
+} // namespace andromeda
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace andromeda::thread {
+
+/**
+ * @class WorkStealingDeque
+ * @brief Lock-free single-producer, multi-consumer deque. The owning thread pushes and pops items at the bottom, other
+ *        threads steal items from the top. Implementation of the Chase-Lev deque, with the memory orderings from
+ *        N. M. Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models" (2013).
+ * @tparam T Item type. Items are stored in atomics, so this should be a small trivially copyable type such as a pointer.
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque item type must be trivially copyable");
+
+    /**
+     * @brief Creates an empty deque.
+     * @param capacity Initial capacity, must be a power of two. The deque grows when it is full.
+     */
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        buffers.push_back(std::make_unique<Buffer>(capacity));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+    /**
+     * @brief Push an item to the bottom of the deque. May only be called by the owning thread.
+     */
+    void push(T item) {
+        int64_t const b = bottom.load(std::memory_order_relaxed);
+        int64_t const t = top.load(std::memory_order_acquire);
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+        if (b - t > buf->capacity - 1) {
+            buf = grow(buf, b, t);
+        }
+        buf->put(b, item);
+        // Release so thieves that see the new bottom also see the item, and anything written before pushing it.
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pop an item from the bottom of the deque. May only be called by the owning thread.
+     * @return The most recently pushed item, or std::nullopt if the deque is empty.
+     */
+    std::optional<T> pop() {
+        int64_t const b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Deque was empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T item = buf->get(b);
+        if (t == b) {
+            // This is the last item, so we race against thieves for it.
+            bool const won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) { return std::nullopt; }
+        }
+        return item;
+    }
+
+    /**
+     * @brief Steal an item from the top of the deque. May be called from any thread.
+     * @return The oldest item in the deque, or std::nullopt if the deque is empty or another thread won the race for it.
+     */
+    std::optional<T> steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t const b = bottom.load(std::memory_order_acquire);
+        if (t >= b) { return std::nullopt; }
+
+        Buffer* buf = buffer.load(std::memory_order_acquire);
+        T item = buf->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return item;
+    }
+
+    /**
+     * @brief Check if the deque is empty. The result may be outdated immediately when called from a non-owning thread.
+     */
+    bool empty() const {
+        int64_t const t = top.load(std::memory_order_relaxed);
+        int64_t const b = bottom.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+private:
+    struct Buffer {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> data;
+
+        explicit Buffer(int64_t capacity) : capacity(capacity), mask(capacity - 1), data(new std::atomic<T>[capacity]) {}
+
+        T get(int64_t index) const {
+            return data[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T item) {
+            data[index & mask].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    // Top and bottom are written by different threads, so keep them on separate cache lines.
+    alignas(64) std::atomic<int64_t> top = 0;
+    alignas(64) std::atomic<int64_t> bottom = 0;
+    alignas(64) std::atomic<Buffer*> buffer = nullptr;
+    // All buffers ever allocated. Thieves may still be reading from an old buffer after the deque has grown, so they
+    // are only freed when the deque is destroyed. Only accessed by the owning thread.
+    std::vector<std::unique_ptr<Buffer>> buffers;
+
+    Buffer* grow(Buffer* old, int64_t b, int64_t t) {
+        auto bigger = std::make_unique<Buffer>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Buffer* result = bigger.get();
+        buffers.push_back(std::move(bigger));
+        buffer.store(result, std::memory_order_release);
+        return result;
+    }
+};
+
+} // namespace andromeda::thread
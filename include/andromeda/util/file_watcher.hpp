@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace andromeda::util {
+
+/**
+ * @class FileWatcher
+ * @brief Watches directories, including all of their subdirectories, for files that are written to. Uses inotify on
+ *        Linux. Other platforms compare the modification time of every file instead, at most once per poll_interval.
+ */
+class FileWatcher {
+public:
+    // Minimum time between two scans of the watched directories on platforms without inotify.
+    static constexpr std::chrono::seconds poll_interval{1};
+
+    /**
+     * @brief Creates a watcher that does not watch anything.
+     */
+    FileWatcher() = default;
+
+    /**
+     * @brief Starts watching directories.
+     * @param directories Directories to watch. Directories that do not exist are skipped.
+     */
+    explicit FileWatcher(std::vector<std::filesystem::path> const& directories);
+
+    FileWatcher(FileWatcher const&) = delete;
+
+    FileWatcher& operator=(FileWatcher const&) = delete;
+
+    ~FileWatcher();
+
+    /**
+     * @brief Check if the watcher is watching any directory.
+     */
+    [[nodiscard]] bool valid() const;
+
+    /**
+     * @brief Get the files that were written to since the last call. Never blocks. A file that was written to multiple
+     *        times is reported once. Newly created subdirectories are watched as well.
+     * @return Paths of the changed files.
+     */
+    std::vector<std::filesystem::path> poll();
+
+private:
+#ifdef __linux__
+    int fd = -1;
+    // Maps inotify watch descriptors to the directory they watch.
+    std::unordered_map<int, std::filesystem::path> watches;
+
+    void add_watches(std::filesystem::path const& directory);
+#else
+    std::vector<std::filesystem::path> roots;
+    std::unordered_map<std::string, std::filesystem::file_time_type> write_times;
+    std::chrono::steady_clock::time_point last_scan{};
+
+    void scan(std::vector<std::filesystem::path>* changed);
+#endif
+};
+
+} // namespace andromeda::util
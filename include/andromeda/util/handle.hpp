@@ -1,9 +1,8 @@
 #pragma once
 
-#include <andromeda/util/idgen.hpp>
-
 #include <cstdint>
 #include <functional>
+#include <type_traits>
 
 namespace andromeda {
 
@@ -57,11 +56,12 @@ struct Handle {
     }
 
     /**
-     * @brief Get the next availble handle of this type.
-     * @return A unique handle of the given type.
+     * @brief Create a handle from an id returned by get_id().
+     * @param id The id of the handle.
+     * @return A handle with the given id.
     */
-    static Handle next() {
-        return Handle{IDGen<T, uint64_t>::next()};
+    static Handle from_id(uint64_t id) {
+        return Handle{id};
     }
 
     uint64_t get_id() const { return id; }
@@ -77,6 +77,17 @@ private:
 template<typename T>
 Handle<T> Handle<T>::none = Handle<T>{static_cast<uint64_t>(-1)};
 
+/**
+ * @brief Checks if a type is a handle. Used to find the handle fields of components through reflection.
+ */
+template<typename T>
+struct is_handle : std::false_type {};
+
+template<typename T>
+struct is_handle<Handle<T>> : std::true_type {
+    using asset_type = T;
+};
+
 }
 
 namespace std {
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace andromeda::util {
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of an entire file. The mapping is released when this object is destroyed.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Creates an empty mapping.
+     */
+    MappedFile() = default;
+
+    /**
+     * @brief Maps a file into memory.
+     * @param path Path to the file to map.
+     */
+    explicit MappedFile(std::string_view path);
+
+    MappedFile(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept;
+
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    ~MappedFile();
+
+    /**
+     * @brief Check if the file was successfully mapped.
+     * @return true if the mapping is valid. Note that empty files can not be mapped.
+     */
+    [[nodiscard]] bool valid() const;
+
+    /**
+     * @brief Get the mapped file contents.
+     * @return Span over the contents of the file. Empty if the mapping is invalid.
+     */
+    [[nodiscard]] std::span<std::byte const> data() const;
+
+    /**
+     * @brief Get the size of the mapped file.
+     * @return Size of the file in bytes.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    std::byte const* memory = nullptr;
+    std::size_t file_size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+    void release();
+};
+
+} // namespace andromeda::util
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
 #include <vector>
 #include <type_traits>
 #include <cassert>
@@ -122,6 +124,8 @@ public:
         if (value >= reverse.size()) { return end(); }
         // If a value is in the set, the direct and reverse values point at each other
         T index = reverse[value];
+        // The reverse entry of an erased value can point past the end of the direct list.
+        if (index >= direct.size()) { return end(); }
         T direct_val = direct[index];
 
         if (direct_val == value) {
@@ -146,6 +150,38 @@ public:
         return iterator(&direct, index);
     }
 
+    // Inserts a range of values at once. None of these values may already be in the set.
+    void insert_range(std::span<T const> values) {
+        if (values.empty()) { return; }
+
+        direct.reserve(direct.size() + values.size());
+        // Resize the reverse vector only once for the entire range.
+        assure_capacity(*std::max_element(values.begin(), values.end()) + 1);
+        for (T value: values) {
+            assert(find(value) == end() && "sparse_set cannot have duplicate values.");
+            reverse[value] = direct.size();
+            direct.push_back(value);
+        }
+    }
+
+    // Removes a value by moving the last value into its place, so this changes the order of the values.
+    // Returns false if the value was not in the set.
+    bool erase(T value) {
+        iterator it = find(value);
+        if (it == end()) { return false; }
+
+        T const last = direct.back();
+        direct[it.get_index()] = last;
+        reverse[last] = it.get_index();
+        direct.pop_back();
+        return true;
+    }
+
+    // Returns all values in the set, in insertion order unless values were erased.
+    std::span<T const> dense() const {
+        return direct;
+    }
+
     void clear() {
         reverse.clear();
         direct.clear();
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <andromeda/ecs/registry.hpp>
+#include <andromeda/math/bvh.hpp>
 #include <andromeda/thread/locked_value.hpp>
+#include <andromeda/util/handle.hpp>
+
+#include <functional>
+#include <vector>
 
 namespace andromeda {
 
@@ -46,6 +51,28 @@ public:
      */
     thread::LockedValue<ecs::registry const> blueprints() const;
 
+    /**
+     * @brief Get access to the spatial index. This stores the world space bounds of every entity with a MeshRenderer
+     *        whose mesh is loaded, and can be used for culling, picking and other spatial queries.
+     * @return A thread-safe structure holding the spatial index and a lock.
+     */
+    thread::LockedValue<math::BVH> spatial_index();
+
+    /**
+     * @brief Get access to the spatial index. This stores the world space bounds of every entity with a MeshRenderer
+     *        whose mesh is loaded, and can be used for culling, picking and other spatial queries.
+     * @return A thread-safe structure holding the spatial index and a lock.
+     */
+    thread::LockedValue<math::BVH const> spatial_index() const;
+
+    /**
+     * @brief Updates the spatial index with the current bounds of every mesh, and removes entities that were destroyed
+     *        or no longer have a ready mesh. Must be called after world transforms are updated. The caller must have access to the ECS, which is passed in directly to allow calling this
+     *        from a system.
+     * @param ecs The world's ECS registry. Only the Hierarchy, WorldTransform and MeshRenderer components are accessed.
+     */
+    void update_spatial_index(ecs::registry const& ecs);
+
     /**
      * @brief Creates a new entity with all necessary components
      * @param parent The parent entity. Default value is the root entity.
@@ -84,12 +111,65 @@ public:
      */
     ecs::entity_t import_entity(ecs::entity_t entity, ecs::entity_t parent = 0);
 
+    /**
+     * @brief Imports a blueprint entity as soon as it is done loading. The import happens in the next call to
+     *        process_pending_imports() after the blueprint is ready. If the blueprint fails to load or is unloaded
+     *        first, the import is dropped and on_import is never called.
+     * @param blueprint Handle to the blueprint entity asset.
+     * @param parent Optionally a handle to the parent in the new entity system.
+     * @param on_import Optional function called with the root of the imported entity.
+     */
+    void import_when_ready(Handle<ecs::entity_t> blueprint, ecs::entity_t parent = 0, std::function<void(ecs::entity_t)> on_import = {});
+
+    /**
+     * @brief Imports all entities queued with import_when_ready() whose blueprint finished loading.
+     *        Must be called on the main thread, while no systems are running.
+     * @return true if any entity was imported.
+     */
+    bool process_pending_imports();
+
+    /**
+     * @brief Get the blueprint entity assets that are waiting to be imported with import_when_ready().
+     * @return Handles to the blueprint assets.
+     */
+    std::vector<Handle<ecs::entity_t>> pending_import_blueprints();
+
+    /**
+     * @brief Destroys a blueprint entity and all of its children, after detaching it from the blueprint hierarchy.
+     *        Called when the entity asset it was loaded from is unloaded, so the blueprint no longer keeps its meshes
+     *        and materials loaded. Entities imported from the blueprint are not affected.
+     * @param blueprint Root of the blueprint hierarchy.
+     */
+    void release_blueprint(ecs::entity_t blueprint);
+
+    /**
+     * @brief Moves a hierarchy of entities from a staging registry into the blueprint entities. Entities in the staging
+     *        registry must be numbered from zero, which is the case for any registry that never imported entities.
+     *        Every staging entity needs a Hierarchy component. Transform and Name components are added if missing.
+     *        This allows building large hierarchies without locking the blueprints, the only lock taken is for the final merge.
+     * @param staging The staging registry.
+     * @param staging_root Root entity of the hierarchy in the staging registry.
+     * @param parent Blueprint entity to attach the hierarchy to. Default value is the blueprint root.
+     * @return The blueprint entity the staging root was mapped to.
+     */
+    ecs::entity_t merge_blueprints(ecs::registry const& staging, ecs::entity_t staging_root, ecs::entity_t parent = 0);
+
 private:
     mutable std::mutex mutex;
     mutable std::mutex blueprint_mutex;
+    mutable std::mutex spatial_mutex;
+    std::mutex import_mutex;
 
     ecs::registry entities;
     ecs::registry blueprint_entities;
+    math::BVH bvh;
+
+    struct PendingImport {
+        Handle<ecs::entity_t> blueprint;
+        ecs::entity_t parent = 0;
+        std::function<void(ecs::entity_t)> on_import;
+    };
+    std::vector<PendingImport> pending_imports;
     ecs::entity_t root_entity = 0;
     ecs::entity_t blueprint_root = 0;
 
@@ -0,0 +1,83 @@
+// Packs a directory of asset files into a single pack file (.pak), see Asset Formats.md.
+// Usage: andromeda_packer [--store] <output.pak> <root directory> [directory...]
+// Every file in the given directories (or in the whole root directory if none are given) is added to the pack, under
+// its path relative to the root directory. The engine mounts packs in its data/ directory with data/ as root, so a
+// pack of the Sponza scene is created with: andromeda_packer data/sponza.pak data sponza
+
+#include <andromeda/assets/pack_file.hpp>
+#include <andromeda/util/mapped_file.hpp>
+
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace andromeda;
+
+static void print_usage() {
+    std::cerr << "Usage: andromeda_packer [--store] <output.pak> <root directory> [directory...]\n"
+                 "    --store    Store all files uncompressed.\n";
+}
+
+int main(int argc, char** argv) {
+    assets::PackCompression compression = assets::PackCompression::LZ4;
+    std::vector<std::string_view> args{};
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg = argv[i];
+        if (arg == "--store") {
+            compression = assets::PackCompression::None;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() < 2) {
+        print_usage();
+        return 1;
+    }
+
+    fs::path const output = args[0];
+    fs::path const root = args[1];
+    std::vector<fs::path> directories{};
+    for (std::size_t i = 2; i < args.size(); ++i) {
+        directories.push_back(root / args[i]);
+    }
+    if (directories.empty()) {
+        directories.push_back(root);
+    }
+
+    assets::PackWriter writer{};
+    std::size_t files = 0;
+    uint64_t bytes = 0;
+    for (fs::path const& directory: directories) {
+        std::error_code error{};
+        for (auto const& entry: fs::recursive_directory_iterator(directory, error)) {
+            if (!entry.is_regular_file()) { continue; }
+            // Don't pack other packs, or the output of a previous run.
+            if (entry.path().extension() == ".pak") { continue; }
+
+            std::string const path = entry.path().lexically_relative(root).generic_string();
+            util::MappedFile file{entry.path().generic_string()};
+            // Empty files can't be mapped, but are still added so they are found in the pack.
+            if (!file.valid() && entry.file_size() != 0) {
+                std::cerr << "Failed to read " << entry.path().generic_string() << "\n";
+                return 1;
+            }
+            writer.add(path, file.data(), compression);
+            ++files;
+            bytes += file.size();
+        }
+        if (error) {
+            std::cerr << "Failed to list " << directory.generic_string() << ": " << error.message() << "\n";
+            return 1;
+        }
+    }
+
+    if (!writer.write(output.generic_string())) {
+        std::cerr << "Failed to write " << output.generic_string() << "\n";
+        return 1;
+    }
+    std::cout << "Packed " << files << " files (" << bytes / 1024 << " KiB) into " << output.generic_string() << " ("
+              << fs::file_size(output) / 1024 << " KiB)\n";
+    return 0;
+}
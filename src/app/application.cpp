@@ -1,68 +1,189 @@
 #include <andromeda/app/application.hpp>
 
+#include <andromeda/assets/packs.hpp>
+#include <andromeda/components/hierarchy.hpp>
+#include <andromeda/components/mesh_renderer.hpp>
+#include <andromeda/components/transform.hpp>
+#include <andromeda/components/world_transform.hpp>
+#include <andromeda/math/transform.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+#include <thread>
+
 namespace andromeda {
 
+// Amount of threads for blocking file reads. Reads from one disk hardly benefit from more than a couple of threads.
+static constexpr uint32_t io_thread_count = 2;
+
 Application::Application(int argc, char** argv) {
     log = std::make_unique<Log>();
     // Setup global logging system
     impl::_global_log_pointer = log.get();
-    window = std::make_unique<Window>("Andromeda", 1300, 800);
-    window->maximize();
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string_view{argv[i]} == "--main-thread-budget") {
+            main_thread_budget = std::chrono::microseconds{static_cast<int64_t>(std::atof(argv[i + 1]) * 1000.0)};
+        }
+    }
+    {
+        auto phase = startup.measure("window");
+        window = std::make_unique<Window>("Andromeda", 1300, 800);
+        window->maximize();
+    }
     // Note that we use thread_count() - 1 threads. The reason for this is that
     // the main thread is also included in thead_count(), but the task scheduler only uses
-    // extra threads.
-    scheduler = std::make_unique<thread::TaskScheduler>(std::thread::hardware_concurrency() - 1);
-    graphics = gfx::Context::init(*window, *log, *scheduler);
+    // extra threads. The I/O threads spend most of their time blocked on file reads, so they come on top of that.
+    scheduler = std::make_unique<thread::TaskScheduler>(std::thread::hardware_concurrency() - 1, io_thread_count);
+    {
+        auto phase = startup.measure("graphics context");
+        graphics = gfx::Context::init(*window, *log, *scheduler);
+    }
     world = std::make_unique<World>();
 
     assets::impl::set_global_pointers(graphics.get(), world.get());
 
+    // Asset loading only needs the context and the world, so start it before initializing the renderer and editor.
+    // Loads are executed on the task scheduler and overlap with the rest of startup.
+    load_scene();
+    // Files in the data directory are watched, so content can be edited without restarting the editor.
+    hot_reloader = std::make_unique<assets::HotReloader>(std::vector<std::filesystem::path>{"data"});
+
     ImGui::CreateContext();
 
-    editor = std::make_unique<editor::Editor>(*graphics, *window);
-    renderer = std::make_unique<gfx::Renderer>(*graphics, *window);
+    {
+        auto phase = startup.measure("editor");
+        editor = std::make_unique<editor::Editor>(*graphics, *window, *world);
+    }
+    {
+        auto phase = startup.measure("renderer");
+        renderer = std::make_unique<gfx::Renderer>(*graphics, *window);
+    }
+
+    // Register all per-frame systems. Transform propagation must be registered first, since every system
+    // reading world transforms depends on it. The spatial index is updated right after.
+    systems = std::make_unique<ecs::SystemScheduler>();
+    systems->add_system("transform_propagation",
+                        ecs::SystemAccess{}.read<Transform, Hierarchy>().write<WorldTransform>(),
+                        [this](ecs::registry& ecs, uint32_t thread) {
+        math::propagate_transforms(ecs, world->root());
+    });
+    systems->add_system("spatial_index_update",
+                        ecs::SystemAccess{}.read<Hierarchy, WorldTransform, MeshRenderer>().write_resource<math::BVH>(),
+                        [this](ecs::registry& ecs, uint32_t thread) {
+        world->update_spatial_index(ecs);
+    });
+    renderer->register_systems(*systems, *world);
 }
 
-int Application::run() {
+// Mount every pack in the data directory, so assets in them are loaded from the pack instead of from loose files.
+static void mount_asset_packs() {
+    std::error_code error{};
+    for (auto const& entry: std::filesystem::directory_iterator("data", error)) {
+        if (entry.path().extension() != ".pak") { continue; }
+        if (assets::mount_pack(entry.path(), "data")) {
+            LOG_FORMAT(LogLevel::Info, "Mounted asset pack {}", entry.path().generic_string());
+        } else {
+            LOG_FORMAT(LogLevel::Error, "Failed to mount asset pack {}", entry.path().generic_string());
+        }
+    }
+}
+
+void Application::load_scene() {
+    mount_asset_packs();
+
+    // Entities are loaded in the background, and imported into the world as soon as they are ready.
     Handle<ecs::entity_t> lights_bp = assets::load<ecs::entity_t>("data/scene/lights.ent");
     Handle<ecs::entity_t> camera_bp = assets::load<ecs::entity_t>("data/scene/camera.ent");
 
-    world->import_entity(*assets::get(lights_bp));
-    ecs::entity_t camera = world->import_entity(*assets::get(camera_bp));
-    renderer->create_viewport(1, 1, camera);
+    loading_scenes = {lights_bp, camera_bp};
+    world->import_when_ready(lights_bp);
+    // Pending imports are only processed in the main loop, so the renderer is guaranteed to exist by then.
+    world->import_when_ready(camera_bp, world->root(), [this](ecs::entity_t camera) {
+        renderer->create_viewport(1, 1, camera);
+    });
 
 //    Handle<ecs::entity_t> horse = assets::load<ecs::entity_t>("data/horse/horse_statue_01_4k.ent");
-//    world->import_entity(*assets::get(horse));
+//    world->import_when_ready(horse);
 
 //    Handle<ecs::entity_t> sponza = assets::load<ecs::entity_t>("data/sponza/Sponza.ent");
-//    world->import_entity(*assets::get(sponza));
+//    world->import_when_ready(sponza);
 
     Handle<ecs::entity_t> cart = assets::load<ecs::entity_t>("data/coffeecart/CoffeeCart_01_2k.ent");
-    world->import_entity(*assets::get(cart));
+    world->import_when_ready(cart);
+    loading_scenes.push_back(cart);
 
     Handle<ecs::entity_t> ground = assets::load<ecs::entity_t>("data/scene/geometry.ent");
-    world->import_entity(*assets::get(ground));
+    world->import_when_ready(ground);
+    loading_scenes.push_back(ground);
 
 //    Handle<ecs::entity_t> gallery = assets::load<ecs::entity_t>("data/gallery/gallery.ent");
-//    world->import_entity(*assets::get(gallery));
+//    world->import_when_ready(gallery);
 
 //    Handle<ecs::entity_t> rungholt = assets::load<ecs::entity_t>("data/rungholt/rungholt.ent");
-//    world->import_entity(*assets::get(rungholt));
+//    world->import_when_ready(rungholt);
 
 //    ecs::entity_t powerplant_root = world->create_entity();
 
     for (uint32_t i = 0; i < 21; ++i) {
 //        Handle<ecs::entity_t> part = assets::load<ecs::entity_t>(fmt::format(FMT_STRING("data/SM_Powerplant/SM_Powerplant{}.ent"), i));
-//       world->import_entity(*assets::get(part), powerplant_root);
+//        world->import_when_ready(part, powerplant_root);
+    }
+
+    // The progress of the scenes is tracked through their entity assets, so they must not be unloaded before that.
+    for (Handle<ecs::entity_t> scene: loading_scenes) {
+        assets::retain(scene);
+    }
+}
+
+void Application::report_scene_progress(uint64_t frame) {
+    if (loading_scenes.empty()) { return; }
+
+    assets::LoadProgress progress{};
+    for (Handle<ecs::entity_t> scene: loading_scenes) {
+        assets::LoadProgress const scene_progress = assets::load_progress(scene);
+        progress.total += scene_progress.total;
+        progress.ready += scene_progress.ready;
+        progress.failed += scene_progress.failed;
     }
+    if (!progress.done()) { return; }
 
+    LOG_FORMAT(LogLevel::Performance, "Scene fully resident at frame {}: {} assets, {} failed to load",
+               frame, progress.total, progress.failed);
+    for (Handle<ecs::entity_t> scene: loading_scenes) {
+        assets::release(scene);
+    }
+    loading_scenes.clear();
+}
+
+int Application::run() {
     uint64_t frame = 0;
     while (window->is_open()) {
         window->poll_events();
         gfx::imgui::new_frame();
 
-        bool dirty = editor->update(*world, *graphics, *renderer);
-        renderer->render_frame(*graphics, *world, dirty);
+        // Run tasks that were handed off to the main thread. Only frame critical tasks may exceed the budget.
+        scheduler->run_main_thread_tasks(main_thread_budget);
+        // Submit the uploads queued by the loaders since last frame in a single batch.
+        graphics->get_upload_service().flush();
+        // Import entities that finished loading
+        bool dirty = world->process_pending_imports();
+        // Swap in assets that were reloaded, while no frame is using them.
+        dirty |= hot_reloader->update();
+        dirty |= editor->update(*world, *graphics, *renderer);
+        renderer->begin_frame(dirty);
+        systems->run(*world, *scheduler);
+        renderer->render_frame(*graphics, *world);
+        // Looking for unused assets walks the whole world, and they are only unloaded after a grace period anyway.
+        if (frame % collect_interval == 0) {
+            assets::collect_unused(*world);
+        }
+        // Assets deleted a few frames ago can't be in use by the renderer anymore.
+        assets::end_frame();
+        if (frame == 0) {
+            startup.first_frame();
+        }
+        report_scene_progress(frame);
 
         ++frame;
         // Flush every 10 frames
@@ -80,6 +201,16 @@ int Application::run() {
     assets::unload_all<gfx::Material>();
     assets::unload_all<gfx::Environment>();
 
+    // Loads waiting on an upload only resume when the upload service is flushed, which the frame loop does not do
+    // anymore. Keep draining it until every task completed, otherwise the scheduler waits for those loads forever.
+    gfx::UploadService& uploads = graphics->get_upload_service();
+    while (true) {
+        scheduler->run_main_thread_tasks();
+        uploads.wait_all();
+        if (uploads.is_idle() && scheduler->stats().outstanding == 0) { break; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
     scheduler->shutdown();
     graphics->wait_idle();
 
@@ -0,0 +1,52 @@
+#include <andromeda/app/startup_timer.hpp>
+
+#include <andromeda/app/log.hpp>
+
+#include <algorithm>
+
+namespace andromeda {
+
+StartupTimer::Scope::Scope(StartupTimer& timer, std::string name) : timer(timer), name(std::move(name)), start(clock::now()) {
+
+}
+
+StartupTimer::Scope::~Scope() {
+    timer.record(std::move(name), start, clock::now());
+}
+
+StartupTimer::StartupTimer() : start(clock::now()) {
+
+}
+
+StartupTimer::Scope StartupTimer::measure(std::string name) {
+    return Scope{*this, std::move(name)};
+}
+
+void StartupTimer::record(std::string name, clock::time_point begin, clock::time_point end) {
+    using ms = std::chrono::duration<float, std::milli>;
+    std::lock_guard lock{mutex};
+    phases.push_back(Phase{
+        .name = std::move(name),
+        .start = ms(begin - start).count(),
+        .end = ms(end - start).count()
+    });
+}
+
+void StartupTimer::first_frame() {
+    std::lock_guard lock{mutex};
+    if (reported) { return; }
+    reported = true;
+
+    float const total = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+    std::sort(phases.begin(), phases.end(), [](Phase const& lhs, Phase const& rhs) {
+        return lhs.start < rhs.start;
+    });
+
+    LOG_FORMAT(LogLevel::Performance, "Time to first frame: {:.2f} ms", total);
+    for (Phase const& phase: phases) {
+        LOG_FORMAT(LogLevel::Performance, "    {:<24} {:>9.2f} ms  (from {:.2f} to {:.2f} ms)",
+                   phase.name, phase.end - phase.start, phase.start, phase.end);
+    }
+}
+
+} // namespace andromeda
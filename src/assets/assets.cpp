@@ -4,6 +4,9 @@
 #include <andromeda/ecs/entity.hpp>
 #include <andromeda/assets/loaders.hpp>
 
+#include <algorithm>
+#include <optional>
+
 namespace andromeda {
 namespace assets {
 
@@ -13,32 +16,65 @@ gfx::Context* gfx_context = nullptr;
 World* world = nullptr;
 
 template<>
-Handle<gfx::Texture> load_priv<gfx::Texture>(std::string const& path) {
-    return gfx_context->request_texture(path);
+void load_priv<gfx::Texture>(Handle<gfx::Texture> handle, std::string const& path, thread::TaskPriority priority) {
+    gfx_context->request_texture(handle, path, priority);
 }
 
 template<>
-Handle<gfx::Mesh> load_priv<gfx::Mesh>(std::string const& path) {
-    return gfx_context->request_mesh(path);
+void load_priv<gfx::Mesh>(Handle<gfx::Mesh> handle, std::string const& path, thread::TaskPriority priority) {
+    gfx_context->request_mesh(handle, path, priority);
 }
 
 template<>
-Handle<gfx::Material> load_priv<gfx::Material>(std::string const& path) {
-    return gfx_context->request_material(path);
+void load_priv<gfx::Material>(Handle<gfx::Material> handle, std::string const& path, thread::TaskPriority priority) {
+    gfx_context->request_material(handle, path, priority);
 }
 
 template<>
-Handle<ecs::entity_t> load_priv<ecs::entity_t>(std::string const& path) {
+void load_priv<ecs::entity_t>(Handle<ecs::entity_t> handle, std::string const& path, thread::TaskPriority priority) {
     LOG_FORMAT(LogLevel::Info, "Loading entity at path {}", path);
-    Handle<ecs::entity_t> handle = assets::impl::insert_pending<ecs::entity_t>();
-    ::andromeda::impl::load_entity(*gfx_context, *world, handle, path);
-    assets::impl::set_path(handle, path);
-    return handle;
+    // The file is read by the I/O service, so no thread blocks on it. Entities stay pending until the hierarchy is
+    // merged into the blueprints.
+    thread::task_group group{};
+    thread::task_handle task = thread::spawn(gfx_context->get_scheduler(), [handle, path, token = group.token()](uint32_t thread) {
+        return ::andromeda::impl::load_entity(*gfx_context, *world, handle, path, token);
+    }, "loading entity " + path, priority, group.token());
+    assets::impl::set_load_task(handle, task);
+    assets::impl::set_load_group(handle, group);
+}
+
+// Meshes and materials are needed to show an entity at all, so they are loaded with the same priority as the asset
+// needing them. Textures are the bulk of the data, and materials can be drawn with their defaults until they are ready,
+// so they are loaded after everything else at the same priority.
+
+template<>
+thread::TaskPriority dependency_priority<gfx::Texture>(thread::TaskPriority parent) {
+    return std::min(static_cast<thread::TaskPriority>(static_cast<uint32_t>(parent) + 1), thread::TaskPriority::Background);
 }
 
 template<>
-Handle<gfx::Environment> load_priv<gfx::Environment>(std::string const& path) {
-    return gfx_context->request_environment(path);
+thread::TaskPriority dependency_priority<gfx::Mesh>(thread::TaskPriority parent) {
+    return parent;
+}
+
+template<>
+thread::TaskPriority dependency_priority<gfx::Material>(thread::TaskPriority parent) {
+    return parent;
+}
+
+template<>
+thread::TaskPriority dependency_priority<ecs::entity_t>(thread::TaskPriority parent) {
+    return parent;
+}
+
+template<>
+thread::TaskPriority dependency_priority<gfx::Environment>(thread::TaskPriority parent) {
+    return std::min(static_cast<thread::TaskPriority>(static_cast<uint32_t>(parent) + 1), thread::TaskPriority::Background);
+}
+
+template<>
+void load_priv<gfx::Environment>(Handle<gfx::Environment> handle, std::string const& path, thread::TaskPriority priority) {
+    gfx_context->request_environment(handle, path, priority);
 }
 
 }
@@ -55,13 +91,30 @@ void unload<gfx::Mesh>(Handle<gfx::Mesh> handle) {
 
 template<>
 void unload<gfx::Material>(Handle<gfx::Material> handle) {
-    // Do nothing, materials don't actually own any resources.
+    // Materials don't own any resources, their textures are unloaded separately once no material uses them anymore.
+    impl::cancel_load(handle);
+    impl::delete_asset(handle);
 }
 
 template<>
 void unload<ecs::entity_t>(Handle<ecs::entity_t> handle) {
-    // Not implemented
-    // TODO: Deleting entities (both from blueprints and main ECS)
+    impl::cancel_load(handle);
+    // The entity is checked and erased under one lock. A load finishing concurrently either made it ready before, so the
+    // blueprint is destroyed here, or fails to make it ready afterwards and destroys the blueprint itself.
+    std::optional<ecs::entity_t> blueprint = std::nullopt;
+    {
+        auto[_, storage] = impl::acquire<ecs::entity_t>();
+        auto* element = storage.find(handle);
+        if (element != nullptr && element->status.load(std::memory_order_acquire) == Status::Ready) {
+            blueprint = element->data;
+        }
+        storage.erase(handle);
+    }
+    impl::dependencies.remove(impl::asset_key(handle));
+    // Destroying the blueprint entities releases the meshes and materials they refer to.
+    if (blueprint) {
+        impl::world->release_blueprint(*blueprint);
+    }
 }
 
 template<>
@@ -69,5 +122,19 @@ void unload<gfx::Environment>(Handle<gfx::Environment> handle) {
     impl::gfx_context->free_environment(handle);
 }
 
+template<typename T>
+static void reclaim_retired() {
+    auto[_, storage] = impl::acquire<T>();
+    storage.end_frame();
+}
+
+void end_frame() {
+    reclaim_retired<gfx::Texture>();
+    reclaim_retired<gfx::Mesh>();
+    reclaim_retired<gfx::Material>();
+    reclaim_retired<gfx::Environment>();
+    reclaim_retired<ecs::entity_t>();
+}
+
 } // namespace assets
 } // namespace andromeda
\ No newline at end of file
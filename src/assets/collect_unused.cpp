@@ -0,0 +1,179 @@
+#include <andromeda/assets/assets.hpp>
+
+#include <andromeda/ecs/entity.hpp>
+#include <andromeda/graphics/environment.hpp>
+#include <andromeda/graphics/material.hpp>
+#include <andromeda/graphics/mesh.hpp>
+#include <andromeda/graphics/texture.hpp>
+
+#include <reflect/reflection.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+
+namespace andromeda::assets {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+// Handles of all assets that are in use, per asset type.
+struct References {
+    std::tuple<
+        std::unordered_set<Handle<gfx::Texture>>,
+        std::unordered_set<Handle<gfx::Mesh>>,
+        std::unordered_set<Handle<gfx::Material>>,
+        std::unordered_set<Handle<gfx::Environment>>,
+        std::unordered_set<Handle<ecs::entity_t>>
+    > handles;
+
+    template<typename T>
+    std::unordered_set<Handle<T>>& get() {
+        return std::get<std::unordered_set<Handle<T>>>(handles);
+    }
+
+    template<typename T>
+    void add(Handle<T> handle) {
+        if (handle) { get<T>().insert(handle); }
+    }
+};
+
+// Location of a handle inside a component, and how to mark the asset it refers to.
+struct HandleField {
+    size_t offset = 0;
+    void (*mark)(std::byte const* field, References& refs) = nullptr;
+};
+
+template<typename A>
+void mark_handle(std::byte const* field, References& refs) {
+    Handle<A> handle;
+    std::memcpy(&handle, field, sizeof(Handle<A>));
+    refs.add(handle);
+}
+
+// Uses the reflection information of C to find its handle fields. This list is built only once per type.
+template<typename C>
+std::vector<HandleField> const& handle_fields() {
+    static std::vector<HandleField> const fields = [] {
+        std::vector<HandleField> result{};
+        C sample{};
+        for (meta::field<C> field: meta::reflect<C>().fields()) {
+            meta::dispatch(field, sample, [&result, &sample](auto& value) {
+                using F = std::remove_cvref_t<decltype(value)>;
+                if constexpr (is_handle<F>::value) {
+                    size_t const offset = reinterpret_cast<std::byte*>(&value) - reinterpret_cast<std::byte*>(&sample);
+                    result.push_back(HandleField{offset, &mark_handle<typename is_handle<F>::asset_type>});
+                }
+            });
+        }
+        return result;
+    }();
+    return fields;
+}
+
+template<typename C>
+struct mark_components {
+    void operator()(ecs::registry const& ecs, References& refs) {
+        std::vector<HandleField> const& fields = handle_fields<C>();
+        if (fields.empty()) { return; }
+
+        for (C const& component: ecs.get_storage<C>().dense_components()) {
+            std::byte const* base = reinterpret_cast<std::byte const*>(&component);
+            for (HandleField const& field: fields) {
+                field.mark(base + field.offset, refs);
+            }
+        }
+    }
+};
+
+// Marks the assets an asset that is in use keeps loaded.
+template<typename T>
+void mark_dependencies(T const& asset, References& refs) {}
+
+template<>
+void mark_dependencies<gfx::Material>(gfx::Material const& material, References& refs) {
+    refs.add(material.albedo);
+    refs.add(material.normal);
+    refs.add(material.metal_rough);
+    refs.add(material.occlusion);
+}
+
+/**
+ * @brief Finds the assets of type T that were unused for longer than the grace period, and updates the time since
+ *        which every other asset is unused.
+ * @return Handles of the assets to unload.
+ */
+template<typename T>
+std::vector<Handle<T>> sweep(References& refs, clock::time_point now) {
+    std::vector<Handle<T>> expired{};
+    auto[_, storage] = impl::acquire<T>();
+    for (Handle<T> handle: storage.handles()) {
+        auto* element = storage.find(handle);
+        bool const loaded = element->status.load(std::memory_order_acquire) == Status::Ready;
+        bool const used = refs.get<T>().contains(handle) || element->retain_count > 0;
+        // Assets that are still loading (or failed to load) hold no GPU resources yet.
+        if (used || !loaded || !element->collectable) {
+            element->unused_since.reset();
+            if (loaded) {
+                mark_dependencies(element->data, refs);
+            }
+            continue;
+        }
+
+        if (!element->unused_since) {
+            element->unused_since = now;
+        } else if (now - *element->unused_since >= unload_grace_period) {
+            expired.push_back(handle);
+        }
+    }
+    return expired;
+}
+
+template<typename T>
+size_t unload_expired(std::vector<Handle<T>> const& handles) {
+    for (Handle<T> handle: handles) {
+        unload(handle);
+    }
+    return handles.size();
+}
+
+} // namespace
+
+void collect_unused(World& world) {
+    References refs{};
+    {
+        auto ecs = world.ecs();
+        meta::for_each_component<mark_components>(ecs.value, refs);
+    }
+    {
+        auto blueprints = world.blueprints();
+        meta::for_each_component<mark_components>(blueprints.value, refs);
+    }
+    for (Handle<ecs::entity_t> blueprint: world.pending_import_blueprints()) {
+        refs.add(blueprint);
+    }
+
+    clock::time_point const now = clock::now();
+    // Assets are swept after the assets that can use them, so only materials that are in use keep their textures.
+    std::vector<Handle<ecs::entity_t>> const entities = sweep<ecs::entity_t>(refs, now);
+    std::vector<Handle<gfx::Material>> const materials = sweep<gfx::Material>(refs, now);
+    std::vector<Handle<gfx::Texture>> const textures = sweep<gfx::Texture>(refs, now);
+    std::vector<Handle<gfx::Mesh>> const meshes = sweep<gfx::Mesh>(refs, now);
+    std::vector<Handle<gfx::Environment>> const environments = sweep<gfx::Environment>(refs, now);
+
+    // The tables are unlocked again, since unloading locks them.
+    size_t count = 0;
+    count += unload_expired(entities);
+    count += unload_expired(materials);
+    count += unload_expired(textures);
+    count += unload_expired(meshes);
+    count += unload_expired(environments);
+    if (count != 0) {
+        LOG_FORMAT(LogLevel::Info, "Unloading {} unused assets", count);
+    }
+}
+
+} // namespace andromeda::assets
@@ -0,0 +1,88 @@
+#include <andromeda/assets/dependency_graph.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <unordered_set>
+
+namespace andromeda {
+namespace assets {
+namespace impl {
+
+DependencyGraph dependencies{};
+
+void DependencyGraph::add_dependency(AssetKey parent, AssetKey child) {
+    std::lock_guard lock{mutex};
+    std::vector<AssetKey>& edges = nodes[parent].dependencies;
+    // Creates the child's node if it did not exist yet, so it counts as pending.
+    nodes.try_emplace(child);
+    // Assets usually only have a handful of dependencies, and the same texture is often used by multiple fields.
+    if (std::find(edges.begin(), edges.end(), child) == edges.end()) {
+        edges.push_back(child);
+    }
+}
+
+void DependencyGraph::set_state(AssetKey asset, State state) {
+    std::lock_guard lock{mutex};
+    nodes[asset].state = state;
+}
+
+DependencyGraph::State DependencyGraph::get_state(AssetKey asset) const {
+    std::lock_guard lock{mutex};
+    auto it = nodes.find(asset);
+    if (it == nodes.end()) { return State::Pending; }
+    return it->second.state;
+}
+
+void DependencyGraph::set_priority(AssetKey asset, thread::TaskPriority priority) {
+    std::lock_guard lock{mutex};
+    nodes[asset].priority = priority;
+}
+
+thread::TaskPriority DependencyGraph::get_priority(AssetKey asset) const {
+    std::lock_guard lock{mutex};
+    auto it = nodes.find(asset);
+    if (it == nodes.end()) { return thread::TaskPriority::Background; }
+    return it->second.priority;
+}
+
+LoadProgress DependencyGraph::progress(AssetKey root) const {
+    std::lock_guard lock{mutex};
+    LoadProgress result{};
+    std::unordered_set<AssetKey, KeyHash> visited{root};
+    std::vector<AssetKey> stack{root};
+    while (!stack.empty()) {
+        AssetKey const key = stack.back();
+        stack.pop_back();
+
+        ++result.total;
+        auto it = nodes.find(key);
+        // Assets that were never seen by the graph are still waiting for their load to start.
+        if (it == nodes.end()) { continue; }
+        Node const& node = it->second;
+        if (node.state == State::Ready) { ++result.ready; }
+        if (node.state == State::Failed) { ++result.failed; }
+        for (AssetKey const& dependency: node.dependencies) {
+            if (visited.insert(dependency).second) {
+                stack.push_back(dependency);
+            }
+        }
+    }
+    return result;
+}
+
+void DependencyGraph::swap(AssetKey lhs, AssetKey rhs) {
+    std::lock_guard lock{mutex};
+    Node& first = nodes[lhs];
+    Node& second = nodes[rhs];
+    std::swap(first.state, second.state);
+    std::swap(first.dependencies, second.dependencies);
+}
+
+void DependencyGraph::remove(AssetKey asset) {
+    std::lock_guard lock{mutex};
+    nodes.erase(asset);
+}
+
+} // namespace impl
+} // namespace assets
+} // namespace andromeda
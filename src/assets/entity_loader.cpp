@@ -1,11 +1,13 @@
 #include <andromeda/assets/loaders.hpp>
 
 #include <andromeda/assets/assets.hpp>
+#include <andromeda/assets/packs.hpp>
 #include <andromeda/graphics/context.hpp>
 
+#include <andromeda/components/hierarchy.hpp>
+
 #include <reflect/reflection.hpp>
 
-#include <plib/stream.hpp>
 #include <json/json.hpp>
 
 namespace andromeda::impl {
@@ -98,71 +100,107 @@ struct json_convert<glm::vec3> {
 };
 
 struct load_field_json {
+    // The entity asset being loaded. Assets referenced by its components become its dependencies.
+    Handle<ecs::entity_t> owner;
+
     template<typename F>
     void operator()(F& value, json::JSON const& json) {
         value = json_convert<F>::from_json(json);
     }
+
+    template<typename A>
+    void operator()(Handle<A>& value, json::JSON const& json) {
+        value = assets::impl::load_dependency<A>(owner, json.ToString());
+    }
 };
 
 template<typename C>
 struct load_component_json {
     // Note that this JSON is the json data of the entire entity.
-    void operator()(ecs::entity_t entity, World& world, thread::LockedValue<ecs::registry>& blueprints, json::JSON const& json) const {
+    void operator()(ecs::entity_t entity, ecs::registry& staging, json::JSON const& json, Handle<ecs::entity_t> owner) const {
         meta::reflection_info<C> const& refl = meta::reflect<C>();
         // Check if JSON data has matching key for this component. If not, we can return early and skip importing fields.
         if (!json.hasKey(refl.name())) { return; }
         // Only add if not yet present
-        if (!blueprints->has_component<C>(entity)) {
-            blueprints->add_component<C>(entity);
+        if (!staging.has_component<C>(entity)) {
+            staging.add_component<C>(entity);
         }
-        C& component = blueprints->template get_component<C>(entity);
+        C& component = staging.template get_component<C>(entity);
         json::JSON const& component_json = json.at(refl.name());
 
         // Similarly to the old looping over each component, we'll now try looping over each field and finding it in the JSON object
         for (meta::field<C> field: refl.fields()) {
             // If key was found in the component's json, dispatch a call to load_field_json to load its data.
             if (component_json.hasKey(field.name())) {
-                meta::dispatch(field, component, load_field_json{}, component_json.at(field.name()));
+                meta::dispatch(field, component, load_field_json{owner}, component_json.at(field.name()));
             }
         }
     }
 };
 }
 
-static void load_entity_json(ecs::entity_t entity, World& world, thread::LockedValue<ecs::registry>& blueprints, json::JSON const& json) {
+static void load_entity_json(ecs::entity_t entity, ecs::registry& staging, json::JSON const& json, Handle<ecs::entity_t> owner) {
     // Instead of looping over each entry in the JSON, we'll loop over each component type and check whether it's present in the JSON data.
     // This way we avoid ever having to manually map strings to component types.
-    meta::for_each_component<load_component_json>(entity, world, blueprints, json);
+    meta::for_each_component<load_component_json>(entity, staging, json, owner);
 }
 
-static ecs::entity_t load_entity_and_children(World& world, thread::LockedValue<ecs::registry>& blueprints, ecs::entity_t parent, json::JSON const& json) {
-    ecs::entity_t entity = world.create_blueprint(blueprints, parent);
+static ecs::entity_t load_entity_and_children(ecs::registry& staging, ecs::entity_t parent, json::JSON const& json,
+                                              Handle<ecs::entity_t> owner) {
+    // Entities are created in a staging registry first, World::merge_blueprints() adds the remaining required components.
+    ecs::entity_t entity = staging.create_entity();
+    auto& hierarchy = staging.add_component<Hierarchy>(entity);
+    hierarchy.parent = parent;
+    hierarchy.this_entity = entity;
+    if (parent != ecs::no_entity) {
+        staging.get_component<Hierarchy>(parent).children.push_back(entity);
+    }
+
     // Read JSON information of this entity
-    load_entity_json(entity, world, blueprints, json);
+    load_entity_json(entity, staging, json, owner);
     // Load child entities
     if (json.hasKey("children")) {
         auto children = json.at("children").ArrayRange();
         for (auto const& child_json: children) {
-            ecs::entity_t child = load_entity_and_children(world, blueprints, entity, child_json);
+            load_entity_and_children(staging, entity, child_json, owner);
         }
     }
     return entity;
 }
 
-void load_entity(gfx::Context& ctx, World& world, Handle<ecs::entity_t> handle, std::string_view path) {
-    // Read JSON from file stream.
-    plib::binary_input_stream file = plib::binary_input_stream::from_file(path.data());
-
+thread::async_task load_entity(gfx::Context& ctx, World& world, Handle<ecs::entity_t> handle, std::string path,
+                               thread::cancellation_token token) {
+    // Files in a mounted pack are already in memory, everything else is read by the I/O service.
     std::string json_string{};
-    json_string.resize(file.size());
-    file.read<char>(json_string.data(), file.size());
+    if (std::optional<assets::PackedFile> packed = assets::impl::find_packed(path)) {
+        json_string.assign(reinterpret_cast<char const*>(packed->data.data()), packed->data.size());
+    } else {
+        thread::FileContents file = co_await ctx.get_io_service().read(path);
+        if (!file.success) {
+            LOG_FORMAT(LogLevel::Error, "Failed to open entity file {}", path);
+            assets::impl::fail_load(handle);
+            co_return;
+        }
+        json_string.assign(reinterpret_cast<char const*>(file.data.data()), file.data.size());
+    }
+    // Don't load meshes and materials or merge anything for an entity that was unloaded during the read.
+    if (token.cancelled()) {
+        co_return;
+    }
     json::JSON json = json::JSON::Load(json_string);
 
-    auto bp_lock = world.blueprints();
-    ecs::entity_t entity = load_entity_and_children(world, bp_lock, 0, json);
+    // Build the entire hierarchy without touching the blueprints, and only lock them to merge the result.
+    ecs::registry staging{};
+    ecs::entity_t root = load_entity_and_children(staging, ecs::no_entity, json, handle);
+    ecs::entity_t entity = world.merge_blueprints(staging, root);
 
-    // Insert into asset system
-    assets::impl::make_ready(handle, entity);
+    // Insert into asset system. If the entity was unloaded while it was loading, nothing else will ever destroy the
+    // merged blueprint.
+    if (!assets::impl::make_ready(handle, entity)) {
+        world.release_blueprint(entity);
+        co_return;
+    }
+    LOG_FORMAT(LogLevel::Info, "Loaded entity {}", path);
 }
 
 }
\ No newline at end of file
@@ -1,33 +1,46 @@
 #include <andromeda/assets/loaders.hpp>
 
+#include <andromeda/assets/mapped_asset_file.hpp>
 #include <andromeda/graphics/context.hpp>
 
-#include <assetlib/asset_file.hpp>
 #include <assetlib/environment.hpp>
 
 #include <string>
 
 namespace andromeda::impl {
 
-void load_environment(gfx::Context& ctx, Handle<gfx::Environment> handle, std::string_view path, uint32_t thread) {
+thread::async_task load_environment(gfx::Context& ctx, Handle<gfx::Environment> handle, std::string path,
+                                    thread::cancellation_token token, uint32_t thread) {
     using namespace std::literals::string_literals;
 
-    assetlib::AssetFile file{};
-    plib::binary_input_stream stream = plib::binary_input_stream::from_file(path.data());
-    bool success = assetlib::load_binary_file(stream, file);
-    if (!success) {
+    assets::MappedAssetFile file{};
+    co_await ctx.get_scheduler().schedule_io([&](uint32_t) {
+        file = assets::MappedAssetFile{path, assets::MappedAssetFile::Type::Environment};
+    }, {}, path, token);
+    if (token.cancelled()) {
+        co_return;
+    }
+    if (!file.valid()) {
         LOG_FORMAT(LogLevel::Error, "Failed to open environment file {}", path);
-        return;
+        assets::impl::fail_load(handle);
+        co_return;
     }
 
-    assetlib::EnvironmentInfo info = assetlib::read_environment_info(file);
+    assetlib::EnvironmentInfo info = assetlib::read_environment_info(file.metadata());
 
-    // Create one large staging buffer
+    // The three cubemaps are stored right after each other, so the whole blob is unpacked into a single allocation.
+    // The default alignment is a multiple of the texel size of VK_FORMAT_R32G32B32A32_SFLOAT, and so is the size of
+    // each cubemap.
     VkDeviceSize const total_size = info.hdr_bytes + info.irradiance_bytes + info.specular_bytes;
-    ph::RawBuffer upload = ctx.create_buffer(ph::BufferType::TransferBuffer, total_size);
-    std::byte* memory = ctx.map_memory(upload);
-    // Unpack directly into staging memory
-    assetlib::unpack_environment(info, file, memory, memory + info.hdr_bytes, memory + info.hdr_bytes + info.irradiance_bytes);
+    gfx::UploadService& uploads = ctx.get_upload_service();
+    gfx::UploadService::Staging staging = uploads.allocate(total_size);
+    if (!file.unpack(ctx.get_scheduler(), {staging.memory, total_size})) {
+        LOG_FORMAT(LogLevel::Error, "Failed to unpack environment file {}", path);
+        uploads.discard(staging);
+        assets::impl::fail_load(handle);
+        co_return;
+    }
+    file = {};
 
     // Create images and views
     gfx::Environment env{};
@@ -50,11 +63,7 @@ void load_environment(gfx::Context& ctx, Handle<gfx::Environment> handle, std::s
 
     // Record CPU->GPU copy for images
     // For this we first transition the images to TransferDstOptimal, then do the copy, then transfer to ShaderReadOnlyOptimal
-
-    ph::Queue& queue = *ctx.get_queue(ph::QueueType::Transfer);
-    ph::CommandBuffer cmd = queue.begin_single_time(thread);
-
-    auto to_transfer_dst = [&ctx, &cmd](ph::ImageView view) {
+    auto record_upload = [](ph::CommandBuffer& cmd, ph::ImageView view, ph::BufferSlice slice) {
         cmd.transition_layout(
             // Newly created image
             ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
@@ -62,9 +71,7 @@ void load_environment(gfx::Context& ctx, Handle<gfx::Environment> handle, std::s
             ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
             // For the copy command to work the image needs to be in the TransferDstOptimal layout.
             view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    };
-
-    auto to_shader_read_only = [&ctx, &cmd](ph::ImageView view) {
+        cmd.copy_buffer_to_image(slice, view);
         cmd.transition_layout(
             // Right after the copy operation
             ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
@@ -75,22 +82,16 @@ void load_environment(gfx::Context& ctx, Handle<gfx::Environment> handle, std::s
         );
     };
 
-    to_transfer_dst(env.cubemap_view);
-    to_transfer_dst(env.irradiance_view);
-    to_transfer_dst(env.specular_view);
-    cmd.copy_buffer_to_image(upload.slice(0, info.hdr_bytes), env.cubemap_view);
-    cmd.copy_buffer_to_image(upload.slice(info.hdr_bytes, info.irradiance_bytes), env.irradiance_view);
-    cmd.copy_buffer_to_image(upload.slice(info.hdr_bytes + info.irradiance_bytes, info.specular_bytes), env.specular_view);
-    to_shader_read_only(env.cubemap_view);
-    to_shader_read_only(env.irradiance_view);
-    to_shader_read_only(env.specular_view);
-
-    VkFence fence = ctx.create_fence();
-    queue.end_single_time(cmd, fence);
-    ctx.wait_for_fence(fence);
-    queue.free_single_time(cmd, thread);
-    ctx.destroy_fence(fence);
-    ctx.destroy_buffer(upload);
+    // Suspend until the upload is complete, so the worker thread can run other tasks in the meantime.
+    co_await uploads.upload(staging, [record_upload, env,
+                                      hdr = staging.sub_slice(0, info.hdr_bytes),
+                                      irradiance = staging.sub_slice(info.hdr_bytes, info.irradiance_bytes),
+                                      specular = staging.sub_slice(info.hdr_bytes + info.irradiance_bytes, info.specular_bytes)]
+                                      (ph::CommandBuffer& cmd) {
+        record_upload(cmd, env.cubemap_view, hdr);
+        record_upload(cmd, env.irradiance_view, irradiance);
+        record_upload(cmd, env.specular_view, specular);
+    });
 
     assets::impl::make_ready(handle, env);
 
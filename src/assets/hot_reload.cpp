@@ -0,0 +1,117 @@
+#include <andromeda/assets/hot_reload.hpp>
+
+#include <andromeda/assets/assets.hpp>
+#include <andromeda/graphics/environment.hpp>
+#include <andromeda/graphics/material.hpp>
+#include <andromeda/graphics/mesh.hpp>
+#include <andromeda/graphics/texture.hpp>
+
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace andromeda::assets {
+
+HotReloader::HotReloader(std::vector<fs::path> const& directories) : watcher(directories) {
+    if (!watcher.valid()) {
+        LOG_WRITE(LogLevel::Warning, "No asset directories could be watched, hot reloading is disabled");
+    }
+}
+
+template<typename T>
+void HotReloader::start_reload(fs::path const& path) {
+    Handle<T> target = Handle<T>::none;
+    {
+        auto[_, storage] = impl::acquire<T>();
+        target = storage.find_path(impl::normalize_path(path));
+    }
+    // Files that were never loaded, or are still loading, don't need to be reloaded.
+    if (!target || !is_ready(target)) { return; }
+
+    std::vector<Reload<T>>& loading = queue<T>().loading;
+    auto it = std::find_if(loading.begin(), loading.end(), [target](Reload<T> const& reload) {
+        return reload.target == target;
+    });
+    // The file changed again while it was being reloaded, so the reload in progress is already outdated.
+    if (it != loading.end()) {
+        unload(it->replacement);
+        loading.erase(it);
+    }
+
+    Handle<T> replacement = impl::insert_pending<T>();
+    if (!replacement) { return; }
+    // The replacement is not referenced by anything until it is swapped in, so it must not be collected before that.
+    retain(replacement);
+
+    LOG_FORMAT(LogLevel::Info, "Reloading {}", path.generic_string());
+    // Someone is waiting on the change, so it is loaded before any streaming in the background.
+    impl::dependencies.set_priority(impl::asset_key(replacement), thread::TaskPriority::Normal);
+    impl::load_priv<T>(replacement, path.generic_string(), thread::TaskPriority::Normal);
+    loading.push_back(Reload<T>{.target = target, .replacement = replacement, .path = path});
+}
+
+template<typename T>
+bool HotReloader::process() {
+    Queue<T>& pending = queue<T>();
+
+    // Old versions are unloaded once no frame in flight can still be using them.
+    while (!pending.retired.empty() && pending.retired.front().frame + retire_frames <= frame) {
+        unload(pending.retired.front().handle);
+        pending.retired.pop_front();
+    }
+
+    bool replaced = false;
+    auto it = std::remove_if(pending.loading.begin(), pending.loading.end(), [this, &pending, &replaced](Reload<T> const& reload) {
+        if (!is_ready(reload.replacement)) {
+            // A reload that finished without becoming ready has failed, the old version stays in use.
+            if (load_progress(reload.replacement).done()) {
+                LOG_FORMAT(LogLevel::Error, "Failed to reload {}, keeping the old version", reload.path.generic_string());
+                unload(reload.replacement);
+                return true;
+            }
+            return false;
+        }
+
+        // A task reading assets of this type across frames could see the swap halfway, so wait until it is done.
+        if (impl::background_readers<T>.load() != 0) { return false; }
+
+        // After this, the replacement handle holds the old version.
+        if (impl::replace(reload.target, reload.replacement)) {
+            replaced = true;
+        }
+        // If the target was unloaded in the meantime, the new version is simply dropped again.
+        pending.retired.push_back(Retired<T>{.handle = reload.replacement, .frame = frame});
+        return true;
+    });
+    pending.loading.erase(it, pending.loading.end());
+    return replaced;
+}
+
+bool HotReloader::update() {
+    ++frame;
+
+    for (fs::path const& path: watcher.poll()) {
+        fs::path const extension = path.extension();
+        if (extension == ".tx") {
+            start_reload<gfx::Texture>(path);
+        } else if (extension == ".mesh") {
+            start_reload<gfx::Mesh>(path);
+        } else if (extension == ".mat") {
+            start_reload<gfx::Material>(path);
+        } else if (extension == ".env") {
+            start_reload<gfx::Environment>(path);
+        } else if (extension == ".ent") {
+            start_reload<ecs::entity_t>(path);
+        }
+    }
+
+    bool replaced = false;
+    replaced |= process<gfx::Texture>();
+    replaced |= process<gfx::Mesh>();
+    replaced |= process<gfx::Material>();
+    replaced |= process<gfx::Environment>();
+    replaced |= process<ecs::entity_t>();
+    return replaced;
+}
+
+} // namespace andromeda::assets
@@ -0,0 +1,97 @@
+#include <andromeda/assets/lz4_chunks.hpp>
+
+#include <andromeda/thread/parallel.hpp>
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace andromeda::assets {
+
+std::vector<std::byte> compress_lz4_chunks(thread::TaskScheduler& scheduler, std::span<std::byte const> data,
+                                           uint32_t chunk_size, LZ4ChunkTable& table) {
+    std::size_t const chunks = (data.size() + chunk_size - 1) / chunk_size;
+    std::size_t const bound = LZ4_compressBound(static_cast<int>(chunk_size));
+    table.chunk_size = chunk_size;
+    table.compressed_sizes.assign(chunks, 0);
+
+    // Compress every chunk into its own worst case sized slot, then pack the slots together.
+    std::vector<std::byte> scratch(chunks * bound);
+    thread::parallel_for(scheduler, chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; ++chunk) {
+            std::size_t const offset = chunk * chunk_size;
+            std::size_t const size = std::min<std::size_t>(chunk_size, data.size() - offset);
+            int const written = LZ4_compress_default(reinterpret_cast<char const*>(data.data() + offset),
+                                                     reinterpret_cast<char*>(scratch.data() + chunk * bound),
+                                                     static_cast<int>(size), static_cast<int>(bound));
+            table.compressed_sizes[chunk] = static_cast<uint32_t>(written);
+        }
+    });
+
+    std::vector<std::byte> blob{};
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        std::byte const* compressed = scratch.data() + chunk * bound;
+        blob.insert(blob.end(), compressed, compressed + table.compressed_sizes[chunk]);
+    }
+    return blob;
+}
+
+// Get the offset of every compressed chunk in the blob, or an empty vector if the table does not match the blob and
+// destination sizes.
+static std::vector<std::size_t> chunk_offsets(LZ4ChunkTable const& table, std::size_t blob_size, std::size_t destination_size) {
+    // The LZ4 block API works with int sizes.
+    if (table.chunk_size == 0 || table.chunk_size > std::numeric_limits<int>::max()) { return {}; }
+    std::size_t const chunks = table.compressed_sizes.size();
+    if (chunks != (destination_size + table.chunk_size - 1) / table.chunk_size) { return {}; }
+
+    // One extra offset for the end of the last chunk.
+    std::vector<std::size_t> offsets(chunks + 1, 0);
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        offsets[chunk + 1] = offsets[chunk] + table.compressed_sizes[chunk];
+    }
+    if (offsets.back() != blob_size) { return {}; }
+    return offsets;
+}
+
+static bool decompress_chunk(LZ4ChunkTable const& table, std::vector<std::size_t> const& offsets, std::size_t chunk,
+                             std::span<std::byte const> blob, std::span<std::byte> destination) {
+    std::size_t const offset = chunk * table.chunk_size;
+    std::size_t const size = std::min<std::size_t>(table.chunk_size, destination.size() - offset);
+    int const written = LZ4_decompress_safe(reinterpret_cast<char const*>(blob.data() + offsets[chunk]),
+                                            reinterpret_cast<char*>(destination.data() + offset),
+                                            static_cast<int>(table.compressed_sizes[chunk]),
+                                            static_cast<int>(size));
+    return written >= 0 && static_cast<std::size_t>(written) == size;
+}
+
+bool decompress_lz4_chunks(LZ4ChunkTable const& table, std::span<std::byte const> blob, std::span<std::byte> destination) {
+    std::vector<std::size_t> const offsets = chunk_offsets(table, blob.size(), destination.size());
+    if (offsets.empty()) { return false; }
+
+    for (std::size_t chunk = 0; chunk < table.compressed_sizes.size(); ++chunk) {
+        if (!decompress_chunk(table, offsets, chunk, blob, destination)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decompress_lz4_chunks(thread::TaskScheduler& scheduler, LZ4ChunkTable const& table,
+                           std::span<std::byte const> blob, std::span<std::byte> destination) {
+    std::vector<std::size_t> const offsets = chunk_offsets(table, blob.size(), destination.size());
+    if (offsets.empty()) { return false; }
+
+    std::atomic<bool> success = true;
+    thread::parallel_for(scheduler, table.compressed_sizes.size(), 0, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; ++chunk) {
+            if (!decompress_chunk(table, offsets, chunk, blob, destination)) {
+                success.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    return success.load();
+}
+
+} // namespace andromeda::assets
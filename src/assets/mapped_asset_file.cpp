@@ -0,0 +1,117 @@
+#include <andromeda/assets/mapped_asset_file.hpp>
+
+#include <andromeda/assets/packs.hpp>
+#include <andromeda/util/mapped_file.hpp>
+
+#include <json/json.hpp>
+#include <lz4.h>
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace andromeda::assets {
+
+// Magic number, version, length of the JSON section and length of the binary blob.
+static constexpr std::size_t header_size = 4 + 3 * sizeof(uint32_t);
+
+// Version of the .tx, .mesh and .env formats written by the asset tools.
+static constexpr uint32_t asset_version = 1;
+
+// The magic number is stored in the first four bytes, so the documented IMESH magic of meshes is cut off after IMES.
+static constexpr char const* magic_numbers[] = {"ITEX", "IMES", "IENV"};
+
+static uint32_t read_u32(std::byte const* memory) {
+    uint32_t value = 0;
+    std::memcpy(&value, memory, sizeof(uint32_t));
+    return value;
+}
+
+MappedAssetFile::MappedAssetFile(std::string_view path, Type type) {
+    std::span<std::byte const> contents{};
+    if (std::optional<PackedFile> packed = impl::find_packed(path)) {
+        storage = std::move(packed->owner);
+        contents = packed->data;
+    } else {
+        auto mapping = std::make_shared<util::MappedFile const>(path);
+        contents = mapping->data();
+        storage = std::move(mapping);
+    }
+    if (contents.size() < header_size) { return; }
+
+    std::byte const* memory = contents.data();
+    if (std::memcmp(memory, magic_numbers[static_cast<std::size_t>(type)], 4) != 0) { return; }
+    if (read_u32(memory + 4) != asset_version) { return; }
+    uint64_t const json_size = read_u32(memory + 8);
+    uint64_t const blob_size = read_u32(memory + 12);
+    if (header_size + json_size + blob_size > contents.size()) { return; }
+
+    json_section = std::string_view{reinterpret_cast<char const*>(memory + header_size), json_size};
+    blob_section = contents.subspan(header_size + json_size, blob_size);
+
+    json::JSON meta = json::JSON::Load(std::string{json_section});
+    std::string const mode = meta.hasKey("compression_mode") ? meta["compression_mode"].ToString() : "None";
+    if (mode == "None") {
+        compression = Compression::None;
+    } else if (mode == "LZ4") {
+        compression = Compression::LZ4;
+    } else if (mode == "LZ4Chunked" && meta.hasKey("lz4_chunk_size") && meta.hasKey("lz4_chunks")) {
+        compression = Compression::LZ4Chunked;
+        chunks.chunk_size = static_cast<uint32_t>(meta["lz4_chunk_size"].ToInt());
+        for (json::JSON const& size: meta["lz4_chunks"].ArrayRange()) {
+            chunks.compressed_sizes.push_back(static_cast<uint32_t>(size.ToInt()));
+        }
+    }
+}
+
+bool MappedAssetFile::valid() const {
+    return !json_section.empty();
+}
+
+std::string_view MappedAssetFile::json() const {
+    return json_section;
+}
+
+std::span<std::byte const> MappedAssetFile::blob() const {
+    return blob_section;
+}
+
+assetlib::AssetFile MappedAssetFile::metadata() const {
+    assetlib::AssetFile result{};
+    result.json = std::string{json_section};
+    return result;
+}
+
+bool MappedAssetFile::unpack(std::span<std::byte> destination) const {
+    switch (compression) {
+        case Compression::None:
+            if (blob_section.size() != destination.size()) { return false; }
+            std::memcpy(destination.data(), blob_section.data(), destination.size());
+            return true;
+        case Compression::LZ4: {
+            // The LZ4 block API works with int sizes.
+            if (blob_section.size() > std::numeric_limits<int>::max() || destination.size() > std::numeric_limits<int>::max()) {
+                return false;
+            }
+            int const written = LZ4_decompress_safe(reinterpret_cast<char const*>(blob_section.data()),
+                                                    reinterpret_cast<char*>(destination.data()),
+                                                    static_cast<int>(blob_section.size()),
+                                                    static_cast<int>(destination.size()));
+            return written >= 0 && static_cast<std::size_t>(written) == destination.size();
+        }
+        case Compression::LZ4Chunked:
+            return decompress_lz4_chunks(chunks, blob_section, destination);
+        default:
+            return false;
+    }
+}
+
+bool MappedAssetFile::unpack(thread::TaskScheduler& scheduler, std::span<std::byte> destination) const {
+    if (compression == Compression::LZ4Chunked) {
+        return decompress_lz4_chunks(scheduler, chunks, blob_section, destination);
+    }
+    // Single stream blobs can only be decompressed sequentially.
+    return unpack(destination);
+}
+
+} // namespace andromeda::assets
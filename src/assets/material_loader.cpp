@@ -1,28 +1,40 @@
 #include <andromeda/assets/loaders.hpp>
 
+#include <andromeda/assets/packs.hpp>
 #include <andromeda/graphics/context.hpp>
 #include <andromeda/graphics/material.hpp>
 
-#include <plib/stream.hpp>
 #include <json/json.hpp>
 
 namespace andromeda {
 namespace impl {
 
-void load_material(gfx::Context& ctx, Handle<gfx::Material> handle, std::string_view path, uint32_t thread) {
+thread::async_task load_material(gfx::Context& ctx, Handle<gfx::Material> handle, std::string path,
+                                 thread::cancellation_token token, uint32_t thread) {
     gfx::Material material{};
 
-    plib::binary_input_stream file = plib::binary_input_stream::from_file(path.data());
-
+    // Files in a mounted pack are already in memory, everything else is read by the I/O service.
     std::string json_string{};
-    json_string.resize(file.size());
-    file.read<char>(json_string.data(), file.size());
-
+    if (std::optional<assets::PackedFile> packed = assets::impl::find_packed(path)) {
+        json_string.assign(reinterpret_cast<char const*>(packed->data.data()), packed->data.size());
+    } else {
+        thread::FileContents file = co_await ctx.get_io_service().read(path);
+        if (!file.success) {
+            LOG_FORMAT(LogLevel::Error, "Failed to open material file {}", path);
+            assets::impl::fail_load(handle);
+            co_return;
+        }
+        json_string.assign(reinterpret_cast<char const*>(file.data.data()), file.data.size());
+    }
+    // Don't start loading textures for a material that was unloaded during the read.
+    if (token.cancelled()) {
+        co_return;
+    }
     json::JSON json = json::JSON::Load(json_string);
 
     if (json.hasKey("albedo")) {
         if (json["albedo"].hasKey("path")) {
-            material.albedo = assets::load<gfx::Texture>(json["albedo"]["path"].ToString());
+            material.albedo = assets::impl::load_dependency<gfx::Texture>(handle, json["albedo"]["path"].ToString());
         }
             // No albedo texture but base color value
         else if (json["albedo"].hasKey("color")) {
@@ -32,15 +44,22 @@ void load_material(gfx::Context& ctx, Handle<gfx::Material> handle, std::string_
                 values[i] = color_json.at(i).ToInt();
             }
 
-            Handle<gfx::Texture> handle = assets::impl::insert_pending<gfx::Texture>();
-            // We'll load this on the same thread since it's a fairly cheap operation
-            load_1x1_texture(ctx, handle, values, thread);
-            material.albedo = handle;
+            Handle<gfx::Texture> texture = assets::impl::insert_pending<gfx::Texture>();
+            assets::impl::dependencies.add_dependency(assets::impl::asset_key(handle), assets::impl::asset_key(texture));
+            // Queued with the other uploads, the texture becomes ready once its upload has completed.
+            load_1x1_texture(ctx, texture, values);
+            material.albedo = texture;
         }
     }
-    if (json.hasKey("normal")) { material.normal = assets::load<gfx::Texture>(json["normal"]["path"].ToString()); }
-    if (json.hasKey("metal_rough")) { material.metal_rough = assets::load<gfx::Texture>(json["metal_rough"]["path"].ToString()); }
-    if (json.hasKey("occlusion")) { material.occlusion = assets::load<gfx::Texture>(json["occlusion"]["path"].ToString()); }
+    if (json.hasKey("normal")) {
+        material.normal = assets::impl::load_dependency<gfx::Texture>(handle, json["normal"]["path"].ToString());
+    }
+    if (json.hasKey("metal_rough")) {
+        material.metal_rough = assets::impl::load_dependency<gfx::Texture>(handle, json["metal_rough"]["path"].ToString());
+    }
+    if (json.hasKey("occlusion")) {
+        material.occlusion = assets::impl::load_dependency<gfx::Texture>(handle, json["occlusion"]["path"].ToString());
+    }
 
     assets::impl::make_ready(handle, std::move(material));
 }
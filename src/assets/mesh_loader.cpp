@@ -1,38 +1,51 @@
 #include <andromeda/assets/loaders.hpp>
 
+#include <andromeda/assets/mapped_asset_file.hpp>
 #include <andromeda/graphics/context.hpp>
+#include <andromeda/thread/parallel.hpp>
 
-#include <assetlib/asset_file.hpp>
 #include <assetlib/mesh.hpp>
 
 
+#include <glm/common.hpp>
+
+#include <cstring>
 #include <string>
 
 namespace andromeda {
 namespace impl {
 
-void load_mesh(gfx::Context& ctx, Handle<gfx::Mesh> handle, std::string_view path, uint32_t thread) {
+thread::async_task load_mesh(gfx::Context& ctx, Handle<gfx::Mesh> handle, std::string path,
+                             thread::cancellation_token token, uint32_t thread) {
     using namespace std::literals::string_literals;
 
-    assetlib::AssetFile file{};
-    plib::binary_input_stream in_stream = plib::binary_input_stream::from_file(path.data());
-    bool success = assetlib::load_binary_file(in_stream, file);
-    if (!success) {
+    // Map the file on an I/O thread, which also starts reading it ahead.
+    assets::MappedAssetFile file{};
+    co_await ctx.get_scheduler().schedule_io([&](uint32_t) {
+        file = assets::MappedAssetFile{path, assets::MappedAssetFile::Type::Mesh};
+    }, {}, path, token);
+    if (token.cancelled()) {
+        co_return;
+    }
+    if (!file.valid()) {
         LOG_FORMAT(LogLevel::Error, "Failed to open mesh file {}", path);
-        return;
+        assets::impl::fail_load(handle);
+        co_return;
     }
 
-    assetlib::MeshInfo info = assetlib::read_mesh_info(file);
+    assetlib::MeshInfo info = assetlib::read_mesh_info(file.metadata());
 
     if (info.format != assetlib::VertexFormat::PNTV32) {
         LOG_WRITE(LogLevel::Error, "Tried to load mesh with unsupported vertex format");
-        return;
+        assets::impl::fail_load(handle);
+        co_return;
     }
 
     if (info.index_bits != 32) {
         LOG_FORMAT(LogLevel::Error, "Tried to load mesh with invalid index type. "
                                     "Only 32-bit indices are supported, this mesh has {}-bit indices", info.index_bits);
-        return;
+        assets::impl::fail_load(handle);
+        co_return;
     }
 
     gfx::Mesh mesh{};
@@ -45,30 +58,46 @@ void load_mesh(gfx::Context& ctx, Handle<gfx::Mesh> handle, std::string_view pat
     ctx.name_object(mesh.vertices.handle, path.data() + " - Vertex Buffer"s);
     ctx.name_object(mesh.indices.handle, path.data() + " - Index Buffer"s);
 
-    // Create staging buffers
-    ph::RawBuffer vtx_staging = ctx.create_buffer(ph::BufferType::TransferBuffer, mesh.vertices.size);
-    ph::RawBuffer idx_staging = ctx.create_buffer(ph::BufferType::TransferBuffer, mesh.indices.size);
-
-    // Unpack directly into staging memory
-    std::byte* vtx = ctx.map_memory(vtx_staging);
-    std::byte* idx = ctx.map_memory(idx_staging);
-    assetlib::unpack_mesh(info, file, vtx, idx);
-
-    // Copy from staging buffers to GPU buffers.
-    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
-
-    ph::CommandBuffer cmd_buf = transfer.begin_single_time(thread);
-    cmd_buf.copy_buffer(vtx_staging, mesh.vertices);
-    cmd_buf.copy_buffer(idx_staging, mesh.indices);
-
-    VkFence fence = ctx.create_fence();
-    transfer.end_single_time(cmd_buf, fence);
-    ctx.wait_for_fence(fence);
-
-    ctx.destroy_buffer(vtx_staging);
-    ctx.destroy_buffer(idx_staging);
-    ctx.destroy_fence(fence);
-    transfer.free_single_time(cmd_buf, thread);
+    // The index data directly follows the vertex data, so the whole blob is unpacked into a single allocation.
+    gfx::UploadService& uploads = ctx.get_upload_service();
+    gfx::UploadService::Staging staging = uploads.allocate(mesh.vertices.size + mesh.indices.size);
+    if (!file.unpack(ctx.get_scheduler(), {staging.memory, mesh.vertices.size + mesh.indices.size})) {
+        LOG_FORMAT(LogLevel::Error, "Failed to unpack mesh file {}", path);
+        uploads.discard(staging);
+        ctx.destroy_buffer(mesh.vertices);
+        ctx.destroy_buffer(mesh.indices);
+        assets::impl::fail_load(handle);
+        co_return;
+    }
+    // Everything we need is in staging memory now, so don't keep the file mapped while waiting for the upload.
+    file = {};
+    std::byte const* vtx = staging.memory;
+
+    // Compute the bounding box from the unpacked vertices. The position is the first attribute of each vertex.
+    // Large meshes have millions of vertices, so split this up over the thread pool.
+    mesh.bounds = thread::parallel_reduce(ctx.get_scheduler(), info.vertex_count, 0, math::AABB{},
+        [vtx](std::size_t begin, std::size_t end) {
+            math::AABB bounds{};
+            for (std::size_t i = begin; i < end; ++i) {
+                glm::vec3 position;
+                std::memcpy(&position, vtx + i * sizeof(assetlib::PNTV32Vertex), sizeof(glm::vec3));
+                bounds.min = glm::min(bounds.min, position);
+                bounds.max = glm::max(bounds.max, position);
+            }
+            return bounds;
+        },
+        [](math::AABB const& lhs, math::AABB const& rhs) {
+            return math::merge(lhs, rhs);
+        });
+
+    // Copy from staging memory to GPU buffers. Suspend until the upload is complete, so the worker thread can run other
+    // tasks in the meantime.
+    co_await uploads.upload(staging, [vertices_src = staging.sub_slice(0, mesh.vertices.size),
+                                      indices_src = staging.sub_slice(mesh.vertices.size, mesh.indices.size),
+                                      vertices = mesh.vertices, indices = mesh.indices](ph::CommandBuffer& cmd) {
+        cmd.copy_buffer(vertices_src, vertices);
+        cmd.copy_buffer(indices_src, indices);
+    });
 
     assets::impl::make_ready(handle, std::move(mesh));
 
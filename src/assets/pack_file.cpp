@@ -0,0 +1,237 @@
+#include <andromeda/assets/pack_file.hpp>
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace andromeda::assets {
+
+static constexpr char pack_magic[4] = {'A', 'P', 'A', 'K'};
+static constexpr uint32_t pack_version = 1;
+
+// Magic number, version, entry count, slot count, offset and size of the string table.
+static constexpr std::size_t header_size = 4 + 3 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+// Layout of a slot in the table of contents. Slots with an empty path are unused.
+struct Slot {
+    uint64_t hash = 0;
+    uint64_t offset = 0;
+    uint64_t stored_size = 0;
+    uint64_t size = 0;
+    uint32_t path_offset = 0;
+    uint32_t path_size = 0;
+    uint32_t compression = 0;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(Slot) == 48, "Pack file slots must be tightly packed");
+
+template<typename T>
+static T read_value(std::byte const* memory) {
+    T value{};
+    std::memcpy(&value, memory, sizeof(T));
+    return value;
+}
+
+template<typename T>
+static void write_value(std::vector<std::byte>& out, std::size_t offset, T const& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t hash_pack_path(std::string_view path) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c: path) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+PackFile::PackFile(std::string_view path) : file(path) {
+    if (!file.valid() || file.size() < header_size) { return; }
+
+    std::byte const* memory = file.data().data();
+    if (std::memcmp(memory, pack_magic, sizeof(pack_magic)) != 0) { return; }
+    if (read_value<uint32_t>(memory + 4) != pack_version) { return; }
+    uint32_t const entry_count = read_value<uint32_t>(memory + 8);
+    uint32_t const slots_in_table = read_value<uint32_t>(memory + 12);
+    uint64_t const strings_offset = read_value<uint64_t>(memory + 16);
+    uint64_t const strings_size = read_value<uint64_t>(memory + 24);
+
+    // Lookups mask the hash with the slot count, and need at least one free slot to terminate.
+    if (!std::has_single_bit(slots_in_table) || entry_count >= slots_in_table) { return; }
+    uint64_t const slots_size = uint64_t{slots_in_table} * sizeof(Slot);
+    if (header_size + slots_size > file.size()) { return; }
+    if (strings_offset > file.size() || strings_size > file.size() - strings_offset) { return; }
+
+    slot_count = slots_in_table;
+    entries = entry_count;
+    slots = file.data().subspan(header_size, slots_size);
+    strings = file.data().subspan(strings_offset, strings_size);
+}
+
+bool PackFile::valid() const {
+    return slot_count != 0;
+}
+
+std::size_t PackFile::entry_count() const {
+    return entries;
+}
+
+std::optional<PackFile::Entry> PackFile::find(std::string_view path) const {
+    if (!valid()) { return std::nullopt; }
+
+    uint64_t const hash = hash_pack_path(path);
+    // Linear probing, the table always has free slots so this terminates.
+    for (uint32_t probe = 0; probe < slot_count; ++probe) {
+        uint32_t const index = (hash + probe) & (slot_count - 1);
+        Slot const slot = read_value<Slot>(slots.data() + index * sizeof(Slot));
+        if (slot.path_size == 0) { return std::nullopt; }
+        if (slot.hash != hash) { continue; }
+
+        if (uint64_t{slot.path_offset} + slot.path_size > strings.size()) { return std::nullopt; }
+        std::string_view const slot_path{reinterpret_cast<char const*>(strings.data() + slot.path_offset), slot.path_size};
+        if (slot_path != path) { continue; }
+
+        if (slot.offset > file.size() || slot.stored_size > file.size() - slot.offset) { return std::nullopt; }
+        Entry entry{};
+        entry.path = slot_path;
+        entry.data = file.data().subspan(slot.offset, slot.stored_size);
+        entry.size = slot.size;
+        entry.compression = static_cast<PackCompression>(slot.compression);
+        return entry;
+    }
+    return std::nullopt;
+}
+
+bool PackFile::unpack(Entry const& entry, std::span<std::byte> destination) {
+    if (destination.size() != entry.size) { return false; }
+    switch (entry.compression) {
+        case PackCompression::None:
+            if (entry.data.size() != destination.size()) { return false; }
+            if (!destination.empty()) {
+                std::memcpy(destination.data(), entry.data.data(), destination.size());
+            }
+            return true;
+        case PackCompression::LZ4: {
+            // The LZ4 block API works with int sizes.
+            if (entry.data.size() > std::numeric_limits<int>::max() || destination.size() > std::numeric_limits<int>::max()) {
+                return false;
+            }
+            int const written = LZ4_decompress_safe(reinterpret_cast<char const*>(entry.data.data()),
+                                                    reinterpret_cast<char*>(destination.data()),
+                                                    static_cast<int>(entry.data.size()),
+                                                    static_cast<int>(destination.size()));
+            return written >= 0 && static_cast<std::size_t>(written) == destination.size();
+        }
+        default:
+            return false;
+    }
+}
+
+void PackWriter::add(std::string path, std::span<std::byte const> data, PackCompression compression) {
+    PendingEntry entry{};
+    entry.path = std::move(path);
+    entry.size = data.size();
+
+    if (compression == PackCompression::LZ4 && !data.empty() && data.size() <= std::numeric_limits<int>::max()) {
+        std::vector<std::byte> compressed(LZ4_compressBound(static_cast<int>(data.size())));
+        int const written = LZ4_compress_default(reinterpret_cast<char const*>(data.data()),
+                                                 reinterpret_cast<char*>(compressed.data()),
+                                                 static_cast<int>(data.size()), static_cast<int>(compressed.size()));
+        // Already compressed data (like most textures) barely shrinks, and is faster to use straight from the mapping.
+        if (written > 0 && static_cast<std::size_t>(written) <= data.size() - data.size() / 8) {
+            compressed.resize(written);
+            entry.data = std::move(compressed);
+            entry.compression = PackCompression::LZ4;
+            pending.push_back(std::move(entry));
+            return;
+        }
+    }
+
+    entry.data.assign(data.begin(), data.end());
+    entry.compression = PackCompression::None;
+    pending.push_back(std::move(entry));
+}
+
+bool PackWriter::write(std::string_view path) const {
+    // Payloads are stored in path order, so files from the same directory end up next to each other.
+    std::vector<PendingEntry const*> sorted{};
+    sorted.reserve(pending.size());
+    for (PendingEntry const& entry: pending) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](PendingEntry const* lhs, PendingEntry const* rhs) {
+        return lhs->path < rhs->path;
+    });
+    // An empty path marks an unused slot, so it can't be used for an entry.
+    if (!sorted.empty() && sorted.front()->path.empty()) { return false; }
+    for (std::size_t i = 0; i + 1 < sorted.size(); ++i) {
+        if (sorted[i]->path == sorted[i + 1]->path) { return false; }
+    }
+    if (sorted.size() >= std::numeric_limits<uint32_t>::max() / 2) { return false; }
+
+    // Keep the table at most half full, so lookups only probe a few slots.
+    uint32_t const slot_count = std::bit_ceil(static_cast<uint32_t>(std::max<std::size_t>(2 * sorted.size(), 1)));
+    uint64_t const strings_offset = header_size + uint64_t{slot_count} * sizeof(Slot);
+    uint64_t strings_size = 0;
+    for (PendingEntry const* entry: sorted) {
+        strings_size += entry->path.size();
+    }
+    if (strings_size > std::numeric_limits<uint32_t>::max()) { return false; }
+
+    // Header, table of contents and string table. Payloads follow at aligned offsets.
+    std::vector<std::byte> head(strings_offset + strings_size);
+    std::memcpy(head.data(), pack_magic, sizeof(pack_magic));
+    write_value(head, 4, pack_version);
+    write_value(head, 8, static_cast<uint32_t>(sorted.size()));
+    write_value(head, 12, slot_count);
+    write_value(head, 16, strings_offset);
+    write_value(head, 24, strings_size);
+
+    uint64_t payload_offset = align_up(head.size(), pack_alignment);
+    uint32_t path_offset = 0;
+    for (PendingEntry const* entry: sorted) {
+        Slot slot{};
+        slot.hash = hash_pack_path(entry->path);
+        slot.offset = payload_offset;
+        slot.stored_size = entry->data.size();
+        slot.size = entry->size;
+        slot.path_offset = path_offset;
+        slot.path_size = static_cast<uint32_t>(entry->path.size());
+        slot.compression = static_cast<uint32_t>(entry->compression);
+
+        uint32_t index = slot.hash & (slot_count - 1);
+        while (read_value<Slot>(head.data() + header_size + index * sizeof(Slot)).path_size != 0) {
+            index = (index + 1) & (slot_count - 1);
+        }
+        write_value(head, header_size + index * sizeof(Slot), slot);
+        std::memcpy(head.data() + strings_offset + path_offset, entry->path.data(), entry->path.size());
+
+        path_offset += slot.path_size;
+        payload_offset = align_up(payload_offset + entry->data.size(), pack_alignment);
+    }
+
+    std::ofstream out{std::string{path}, std::ios::binary | std::ios::trunc};
+    if (!out) { return false; }
+    out.write(reinterpret_cast<char const*>(head.data()), head.size());
+    std::vector<char> const padding(pack_alignment, 0);
+    uint64_t written = head.size();
+    for (PendingEntry const* entry: sorted) {
+        uint64_t const offset = align_up(written, pack_alignment);
+        out.write(padding.data(), offset - written);
+        out.write(reinterpret_cast<char const*>(entry->data.data()), entry->data.size());
+        written = offset + entry->data.size();
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace andromeda::assets
@@ -0,0 +1,66 @@
+#include <andromeda/assets/packs.hpp>
+
+#include <andromeda/assets/assets.hpp>
+#include <andromeda/assets/pack_file.hpp>
+
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace andromeda::assets {
+
+namespace {
+
+struct Mount {
+    std::shared_ptr<PackFile const> pack;
+    // Normalized root directory of the pack, with a trailing '/'.
+    std::string root;
+};
+
+// Mounted packs, the last mounted pack is searched first.
+std::vector<Mount> mounts;
+std::shared_mutex mounts_mutex;
+
+} // namespace
+
+bool mount_pack(std::filesystem::path const& pack, std::filesystem::path const& root) {
+    auto file = std::make_shared<PackFile const>(pack.generic_string());
+    if (!file->valid()) { return false; }
+
+    std::string prefix = impl::normalize_path(root);
+    if (!prefix.ends_with('/')) {
+        prefix += '/';
+    }
+
+    std::unique_lock lock{mounts_mutex};
+    mounts.push_back(Mount{.pack = std::move(file), .root = std::move(prefix)});
+    return true;
+}
+
+namespace impl {
+
+std::optional<PackedFile> find_packed(std::filesystem::path const& path) {
+    std::shared_lock lock{mounts_mutex};
+    if (mounts.empty()) { return std::nullopt; }
+
+    std::string const key = normalize_path(path);
+    for (auto it = mounts.rbegin(); it != mounts.rend(); ++it) {
+        if (!key.starts_with(it->root)) { continue; }
+
+        std::optional<PackFile::Entry> entry = it->pack->find(std::string_view{key}.substr(it->root.size()));
+        if (!entry) { continue; }
+
+        // Uncompressed entries are used straight from the mapping, which the pack keeps alive.
+        if (entry->compression == PackCompression::None && entry->data.size() == entry->size) {
+            return PackedFile{.owner = it->pack, .data = entry->data};
+        }
+        auto buffer = std::make_shared<std::vector<std::byte>>(entry->size);
+        if (!PackFile::unpack(*entry, *buffer)) { return std::nullopt; }
+        return PackedFile{.owner = buffer, .data = *buffer};
+    }
+    return std::nullopt;
+}
+
+} // namespace impl
+
+} // namespace andromeda::assets
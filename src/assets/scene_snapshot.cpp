@@ -0,0 +1,737 @@
+#include <andromeda/assets/scene_snapshot.hpp>
+
+#include <andromeda/assets/assets.hpp>
+#include <andromeda/components/hierarchy.hpp>
+#include <andromeda/components/name.hpp>
+#include <andromeda/components/world_transform.hpp>
+#include <andromeda/graphics/environment.hpp>
+#include <andromeda/graphics/material.hpp>
+#include <andromeda/graphics/mesh.hpp>
+#include <andromeda/graphics/texture.hpp>
+#include <andromeda/util/mapped_file.hpp>
+
+#include <reflect/reflection.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+namespace andromeda::assets {
+
+namespace {
+
+// Binary layout of a scene snapshot. Every block starts at an 8-byte aligned offset, so the file can be
+// mapped into memory and read in place. All offsets are relative to the start of the file.
+
+constexpr char scene_magic[4] = {'A', 'S', 'C', 'N'};
+constexpr uint32_t scene_version = 1;
+
+// Value used for null entity and asset references.
+constexpr uint64_t null_index = static_cast<uint64_t>(-1);
+// Entity index used for references to the root entity of the saved world. On load these are replaced by the parent entity.
+constexpr uint64_t scene_root_index = static_cast<uint64_t>(-2);
+
+struct SceneHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t num_entities;
+    // uint64_t[num_entities], with the original id of each entity in the snapshot.
+    uint64_t entity_table_offset;
+    uint64_t num_paths;
+    // PathEntry[num_paths]
+    uint64_t path_table_offset;
+    uint64_t num_columns;
+    // ColumnEntry[num_columns]
+    uint64_t column_table_offset;
+};
+
+enum class PathType : uint32_t {
+    Texture = 0,
+    Mesh = 1,
+    Material = 2,
+    Environment = 3,
+    Entity = 4
+};
+
+struct PathEntry {
+    uint32_t type;
+    uint32_t length;
+    // Offset to the path string. This string is not null-terminated.
+    uint64_t offset;
+};
+
+enum class ColumnEncoding : uint32_t {
+    // The column is an array of components that can be copied directly into the component storage.
+    Raw = 0,
+    // The column is a string table with uint64_t offsets[count + 1] followed by the characters.
+    String = 1,
+    // The column is an array of uint64_t parent indices. Children are rebuilt on load.
+    Hierarchy = 2
+};
+
+struct ColumnEntry {
+    // Reflected name of the component, null-terminated.
+    char name[48];
+    uint32_t encoding;
+    // Size of a single component. Raw columns are skipped on load if this does not match.
+    uint32_t element_size;
+    uint64_t count;
+    // uint64_t[count] with the entity index of each component. If this is null_index, component i belongs to entity i.
+    uint64_t entities_offset;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+static_assert(sizeof(SceneHeader) % 8 == 0);
+static_assert(sizeof(PathEntry) % 8 == 0);
+static_assert(sizeof(ColumnEntry) % 8 == 0);
+
+template<typename A>
+constexpr PathType path_type();
+
+template<>
+constexpr PathType path_type<gfx::Texture>() { return PathType::Texture; }
+
+template<>
+constexpr PathType path_type<gfx::Mesh>() { return PathType::Mesh; }
+
+template<>
+constexpr PathType path_type<gfx::Material>() { return PathType::Material; }
+
+template<>
+constexpr PathType path_type<gfx::Environment>() { return PathType::Environment; }
+
+template<>
+constexpr PathType path_type<ecs::entity_t>() { return PathType::Entity; }
+
+constexpr uint64_t align_offset(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+class SnapshotWriter {
+public:
+    // Allocates an 8-byte aligned, zero-initialized block and returns its offset.
+    uint64_t allocate(uint64_t size) {
+        uint64_t const offset = align_offset(buffer.size());
+        buffer.resize(align_offset(offset + size));
+        return offset;
+    }
+
+    // Note that the returned pointer is invalidated by the next call to allocate().
+    std::byte* at(uint64_t offset) {
+        return buffer.data() + offset;
+    }
+
+    template<typename T>
+    void write(uint64_t offset, T const& value) {
+        std::memcpy(at(offset), &value, sizeof(T));
+    }
+
+    std::vector<std::byte> const& data() const {
+        return buffer;
+    }
+
+private:
+    std::vector<std::byte> buffer;
+};
+
+struct SaveContext {
+    // Maps an entity id in the world to its index in the snapshot.
+    std::vector<uint64_t> entity_index;
+    uint64_t num_entities = 0;
+    ecs::entity_t root = ecs::no_entity;
+
+    std::vector<PathEntry> path_entries;
+    std::vector<std::string> paths;
+    // Maps path type + path string to an index in the path table.
+    std::unordered_map<std::string, uint64_t> path_lookup;
+    // Caches the path index of every handle we've seen, indexed by path type.
+    std::unordered_map<uint64_t, uint64_t> handle_lookup[5];
+
+    uint64_t map_entity(ecs::entity_t entity) const {
+        if (entity == root) { return scene_root_index; }
+        if (entity == ecs::no_entity || entity >= entity_index.size()) { return null_index; }
+        return entity_index[entity];
+    }
+
+    template<typename A>
+    uint64_t map_handle(Handle<A> handle) {
+        if (!handle) { return null_index; }
+
+        auto& cache = handle_lookup[static_cast<uint32_t>(path_type<A>())];
+        if (auto it = cache.find(handle.get_id()); it != cache.end()) {
+            return it->second;
+        }
+
+        uint64_t index = null_index;
+        std::optional<fs::path> path = assets::get_path(handle);
+        // Assets created at runtime (like the default textures) have no path and cannot be stored in a snapshot.
+        if (path && !path->empty()) {
+            std::string path_str = path->generic_string();
+            std::string key = std::to_string(static_cast<uint32_t>(path_type<A>())) + ":" + path_str;
+            auto[it, inserted] = path_lookup.try_emplace(std::move(key), paths.size());
+            if (inserted) {
+                path_entries.push_back(PathEntry{
+                    .type = static_cast<uint32_t>(path_type<A>()),
+                    .length = static_cast<uint32_t>(path_str.size())
+                });
+                paths.push_back(std::move(path_str));
+            }
+            index = it->second;
+        }
+
+        cache.emplace(handle.get_id(), index);
+        return index;
+    }
+};
+
+struct LoadContext {
+    std::span<std::byte const> file;
+    // Maps a snapshot entity index to the newly created entity.
+    std::vector<ecs::entity_t> entities;
+    ecs::entity_t parent = ecs::no_entity;
+
+    std::vector<PathEntry> path_entries;
+    // Handles resolved from the path table, loaded lazily when first referenced.
+    std::tuple<
+        std::vector<Handle<gfx::Texture>>,
+        std::vector<Handle<gfx::Mesh>>,
+        std::vector<Handle<gfx::Material>>,
+        std::vector<Handle<gfx::Environment>>,
+        std::vector<Handle<ecs::entity_t>>
+    > handles;
+
+    bool in_bounds(uint64_t offset, uint64_t size) const {
+        return offset <= file.size() && size <= file.size() - offset;
+    }
+
+    template<typename T>
+    T read(uint64_t offset) const {
+        T value;
+        std::memcpy(&value, file.data() + offset, sizeof(T));
+        return value;
+    }
+
+    ecs::entity_t map_entity(uint64_t index) const {
+        if (index == scene_root_index) { return parent; }
+        if (index >= entities.size()) { return ecs::no_entity; }
+        return entities[index];
+    }
+
+    template<typename A>
+    Handle<A> resolve(uint64_t index) {
+        if (index >= path_entries.size()) { return {}; }
+        PathEntry const& entry = path_entries[index];
+        if (entry.type != static_cast<uint32_t>(path_type<A>())) { return {}; }
+
+        std::vector<Handle<A>>& cache = std::get<std::vector<Handle<A>>>(handles);
+        if (cache.empty()) { cache.resize(path_entries.size()); }
+        if (!cache[index]) {
+            std::string path{reinterpret_cast<char const*>(file.data() + entry.offset), entry.length};
+            cache[index] = assets::load<A>(path);
+        }
+        return cache[index];
+    }
+};
+
+// Describes a field that can not be copied as-is because it stores an entity or asset reference.
+// Both functions operate directly on the bytes of the field inside a component.
+struct FieldPatch {
+    size_t offset;
+    void (* save)(std::byte* field, SaveContext& ctx);
+    void (* load)(std::byte* field, LoadContext& ctx);
+};
+
+template<typename A>
+void save_handle(std::byte* field, SaveContext& ctx) {
+    Handle<A> handle;
+    std::memcpy(&handle, field, sizeof(Handle<A>));
+    uint64_t const index = ctx.map_handle(handle);
+    std::memcpy(field, &index, sizeof(uint64_t));
+}
+
+template<typename A>
+void load_handle(std::byte* field, LoadContext& ctx) {
+    uint64_t index;
+    std::memcpy(&index, field, sizeof(uint64_t));
+    Handle<A> const handle = ctx.resolve<A>(index);
+    std::memcpy(field, &handle, sizeof(Handle<A>));
+}
+
+void save_entity(std::byte* field, SaveContext& ctx) {
+    ecs::entity_t entity;
+    std::memcpy(&entity, field, sizeof(ecs::entity_t));
+    uint64_t const index = ctx.map_entity(entity);
+    std::memcpy(field, &index, sizeof(uint64_t));
+}
+
+void load_entity_ref(std::byte* field, LoadContext& ctx) {
+    uint64_t index;
+    std::memcpy(&index, field, sizeof(uint64_t));
+    ecs::entity_t const entity = ctx.map_entity(index);
+    std::memcpy(field, &entity, sizeof(ecs::entity_t));
+}
+
+// Uses the reflection information of C to find all fields that need patching. This list is built only once per type.
+template<typename C>
+std::vector<FieldPatch> const& field_patches() {
+    static std::vector<FieldPatch> const patches = [] {
+        std::vector<FieldPatch> result{};
+        C sample{};
+        for (meta::field<C> field: meta::reflect<C>().fields()) {
+            meta::dispatch(field, sample, [&result, &sample](auto& value) {
+                using F = std::remove_cvref_t<decltype(value)>;
+                size_t const offset = reinterpret_cast<std::byte*>(&value) - reinterpret_cast<std::byte*>(&sample);
+                if constexpr (is_handle<F>::value) {
+                    using A = typename is_handle<F>::asset_type;
+                    result.push_back(FieldPatch{offset, &save_handle<A>, &load_handle<A>});
+                } else if constexpr (std::is_same_v<F, ecs::entity_t>) {
+                    result.push_back(FieldPatch{offset, &save_entity, &load_entity_ref});
+                }
+            });
+        }
+        return result;
+    }();
+    return patches;
+}
+
+// Default column encoding, used for every component that can be copied with memcpy.
+template<typename C>
+struct column_traits {
+    static constexpr bool supported = std::is_trivially_copyable_v<C> && std::is_default_constructible_v<C>;
+    static constexpr ColumnEncoding encoding = ColumnEncoding::Raw;
+
+    static void save(SnapshotWriter& out, std::span<C const> components, size_t skip, SaveContext& ctx, ColumnEntry& column) {
+        size_t const count = skip < components.size() ? components.size() - 1 : components.size();
+        column.data_size = count * sizeof(C);
+        column.data_offset = out.allocate(column.data_size);
+
+        // Copy everything before and after the skipped element in (at most) two memcpy calls.
+        size_t const before = std::min(skip, components.size());
+        std::memcpy(out.at(column.data_offset), components.data(), before * sizeof(C));
+        if (before < count) {
+            std::memcpy(out.at(column.data_offset + before * sizeof(C)), components.data() + before + 1, (count - before) * sizeof(C));
+        }
+
+        // Only fields referencing other entities or assets need to be touched individually.
+        for (FieldPatch const& patch: field_patches<C>()) {
+            std::byte* base = out.at(column.data_offset);
+            for (size_t i = 0; i < count; ++i) {
+                patch.save(base + i * sizeof(C) + patch.offset, ctx);
+            }
+        }
+    }
+
+    static bool load(ColumnEntry const& column, std::vector<C>& components, LoadContext& ctx) {
+        if (column.element_size != sizeof(C) || column.data_size != column.count * sizeof(C)) {
+            LOG_FORMAT(LogLevel::Warning, "Scene snapshot column {} has a different layout than the current component. Skipping.", column.name);
+            return false;
+        }
+
+        components.resize(column.count);
+        std::memcpy(components.data(), ctx.file.data() + column.data_offset, column.data_size);
+        for (FieldPatch const& patch: field_patches<C>()) {
+            std::byte* base = reinterpret_cast<std::byte*>(components.data());
+            for (size_t i = 0; i < components.size(); ++i) {
+                patch.load(base + i * sizeof(C) + patch.offset, ctx);
+            }
+        }
+        return true;
+    }
+};
+
+template<>
+struct column_traits<Name> {
+    static constexpr bool supported = true;
+    static constexpr ColumnEncoding encoding = ColumnEncoding::String;
+
+    static void save(SnapshotWriter& out, std::span<Name const> components, size_t skip, SaveContext& ctx, ColumnEntry& column) {
+        uint64_t num_chars = 0;
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (i != skip) { num_chars += components[i].name.size(); }
+        }
+
+        uint64_t const count = skip < components.size() ? components.size() - 1 : components.size();
+        uint64_t const table_size = (count + 1) * sizeof(uint64_t);
+        column.data_size = table_size + num_chars;
+        column.data_offset = out.allocate(column.data_size);
+
+        uint64_t row = 0;
+        uint64_t char_offset = 0;
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (i == skip) { continue; }
+            std::string const& name = components[i].name;
+            out.write(column.data_offset + row * sizeof(uint64_t), char_offset);
+            std::memcpy(out.at(column.data_offset + table_size + char_offset), name.data(), name.size());
+            char_offset += name.size();
+            ++row;
+        }
+        out.write(column.data_offset + count * sizeof(uint64_t), char_offset);
+    }
+
+    static bool load(ColumnEntry const& column, std::vector<Name>& components, LoadContext& ctx) {
+        uint64_t const table_size = (column.count + 1) * sizeof(uint64_t);
+        if (column.data_size < table_size) { return false; }
+
+        uint64_t const num_chars = column.data_size - table_size;
+        char const* chars = reinterpret_cast<char const*>(ctx.file.data() + column.data_offset + table_size);
+        components.resize(column.count);
+        for (size_t i = 0; i < column.count; ++i) {
+            uint64_t const begin = ctx.read<uint64_t>(column.data_offset + i * sizeof(uint64_t));
+            uint64_t const end = ctx.read<uint64_t>(column.data_offset + (i + 1) * sizeof(uint64_t));
+            if (begin > end || end > num_chars) { return false; }
+            components[i].name.assign(chars + begin, end - begin);
+        }
+        return true;
+    }
+};
+
+template<>
+struct column_traits<Hierarchy> {
+    static constexpr bool supported = true;
+    static constexpr ColumnEncoding encoding = ColumnEncoding::Hierarchy;
+
+    // Only the parent is stored. The list of children is redundant and is rebuilt on load.
+    static void save(SnapshotWriter& out, std::span<Hierarchy const> components, size_t skip, SaveContext& ctx, ColumnEntry& column) {
+        uint64_t const count = skip < components.size() ? components.size() - 1 : components.size();
+        column.data_size = count * sizeof(uint64_t);
+        column.data_offset = out.allocate(column.data_size);
+
+        uint64_t row = 0;
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (i == skip) { continue; }
+            out.write(column.data_offset + row * sizeof(uint64_t), ctx.map_entity(components[i].parent));
+            ++row;
+        }
+    }
+
+    static bool load(ColumnEntry const& column, std::vector<Hierarchy>& components, LoadContext& ctx) {
+        if (column.data_size != column.count * sizeof(uint64_t)) { return false; }
+
+        components.resize(column.count);
+        for (size_t i = 0; i < column.count; ++i) {
+            components[i].parent = ctx.map_entity(ctx.read<uint64_t>(column.data_offset + i * sizeof(uint64_t)));
+        }
+        return true;
+    }
+};
+
+template<typename C>
+struct save_column {
+    void operator()(ecs::registry const& ecs, SnapshotWriter& out, SaveContext& ctx, std::vector<ColumnEntry>& columns) {
+        meta::reflection_info<C> const& refl = meta::reflect<C>();
+        if constexpr (!column_traits<C>::supported) {
+            LOG_FORMAT(LogLevel::Warning, "Component {} can not be stored in a scene snapshot.", refl.name());
+            return;
+        } else {
+            ecs::component_storage<C> const& storage = ecs.get_storage<C>();
+            std::span<ecs::entity_t const> entities = storage.dense();
+
+            // The root entity is never stored, so we pass its position in the storage to the column encoder to skip it.
+            size_t const root_pos = std::find(entities.begin(), entities.end(), ctx.root) - entities.begin();
+            uint64_t const count = root_pos < entities.size() ? entities.size() - 1 : entities.size();
+            if (count == 0) { return; }
+
+            ColumnEntry column{};
+            std::strncpy(column.name, refl.name().c_str(), sizeof(column.name) - 1);
+            column.encoding = static_cast<uint32_t>(column_traits<C>::encoding);
+            column.element_size = column_traits<C>::encoding == ColumnEncoding::Raw ? sizeof(C) : 0;
+            column.count = count;
+
+            // Components that every entity has are usually stored in entity order, so we can leave out the entity list.
+            uint64_t row = 0;
+            bool identity = count == ctx.num_entities;
+            for (size_t i = 0; identity && i < entities.size(); ++i) {
+                if (entities[i] == ctx.root) { continue; }
+                identity = ctx.map_entity(entities[i]) == row;
+                ++row;
+            }
+
+            column.entities_offset = null_index;
+            if (!identity) {
+                column.entities_offset = out.allocate(count * sizeof(uint64_t));
+                row = 0;
+                for (ecs::entity_t entity: entities) {
+                    if (entity == ctx.root) { continue; }
+                    out.write(column.entities_offset + row * sizeof(uint64_t), ctx.map_entity(entity));
+                    ++row;
+                }
+            }
+
+            column_traits<C>::save(out, storage.dense_components(), root_pos, ctx, column);
+            columns.push_back(column);
+        }
+    }
+};
+
+template<typename C>
+struct load_column {
+    void operator()(thread::LockedValue<ecs::registry>& ecs, ColumnEntry const& column, LoadContext& ctx, bool& found) {
+        if constexpr (column_traits<C>::supported) {
+            if (found || meta::reflect<C>().name() != column.name) { return; }
+            found = true;
+
+            if (column.encoding != static_cast<uint32_t>(column_traits<C>::encoding)) {
+                LOG_FORMAT(LogLevel::Warning, "Scene snapshot column {} has an unknown encoding. Skipping.", column.name);
+                return;
+            }
+
+            std::vector<ecs::entity_t> entities{};
+            if (column.entities_offset == null_index) {
+                if (column.count > ctx.entities.size()) {
+                    LOG_FORMAT(LogLevel::Error, "Scene snapshot column {} has too many elements. Skipping.", column.name);
+                    return;
+                }
+                entities.assign(ctx.entities.begin(), ctx.entities.begin() + column.count);
+            }
+
+            entities.resize(column.count);
+            std::vector<bool> seen(ctx.entities.size());
+            for (size_t i = 0; column.entities_offset != null_index && i < column.count; ++i) {
+                uint64_t const index = ctx.read<uint64_t>(column.entities_offset + i * sizeof(uint64_t));
+                // Every entity in a column must be part of the snapshot, and may only appear once.
+                if (index >= ctx.entities.size() || seen[index]) {
+                    LOG_FORMAT(LogLevel::Error, "Scene snapshot column {} references an invalid entity. Skipping.", column.name);
+                    return;
+                }
+                seen[index] = true;
+                entities[i] = ctx.entities[index];
+            }
+
+            std::vector<C> components{};
+            if (!column_traits<C>::load(column, components, ctx)) {
+                LOG_FORMAT(LogLevel::Error, "Scene snapshot column {} is corrupted. Skipping.", column.name);
+                return;
+            }
+
+            if constexpr (std::is_same_v<C, Hierarchy>) {
+                for (size_t i = 0; i < components.size(); ++i) {
+                    components[i].this_entity = entities[i];
+                }
+            }
+
+            ecs->insert_components<C>(entities, std::move(components));
+        }
+    }
+};
+
+// Adds a default-constructed component to every entity in the list that doesn't have one yet.
+template<typename C>
+void ensure_component(ecs::registry& ecs, std::span<ecs::entity_t const> entities) {
+    std::vector<ecs::entity_t> missing{};
+    for (ecs::entity_t entity: entities) {
+        if (!ecs.has_component<C>(entity)) {
+            missing.push_back(entity);
+        }
+    }
+    if (!missing.empty()) {
+        ecs.insert_components<C>(missing, std::vector<C>(missing.size()));
+    }
+}
+
+bool validate(LoadContext const& ctx, SceneHeader const& header) {
+    if (std::memcmp(header.magic, scene_magic, sizeof(scene_magic)) != 0) {
+        LOG_WRITE(LogLevel::Error, "File is not a scene snapshot.");
+        return false;
+    }
+    if (header.version != scene_version) {
+        LOG_FORMAT(LogLevel::Error, "Unsupported scene snapshot version {}.", header.version);
+        return false;
+    }
+
+    // Every count is at most the file size, so these multiplications can not overflow.
+    uint64_t const max_count = ctx.file.size();
+    if (header.num_entities > max_count || header.num_paths > max_count || header.num_columns > max_count
+        || !ctx.in_bounds(header.entity_table_offset, header.num_entities * sizeof(uint64_t))
+        || !ctx.in_bounds(header.path_table_offset, header.num_paths * sizeof(PathEntry))
+        || !ctx.in_bounds(header.column_table_offset, header.num_columns * sizeof(ColumnEntry))) {
+        LOG_WRITE(LogLevel::Error, "Scene snapshot is corrupted.");
+        return false;
+    }
+    return true;
+}
+
+bool validate(LoadContext const& ctx, ColumnEntry const& column) {
+    return column.name[sizeof(column.name) - 1] == '\0'
+        && column.count <= ctx.file.size()
+        && (column.entities_offset == null_index || ctx.in_bounds(column.entities_offset, column.count * sizeof(uint64_t)))
+        && ctx.in_bounds(column.data_offset, column.data_size);
+}
+
+using clock = std::chrono::steady_clock;
+
+float elapsed_ms(clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(clock::now() - start).count();
+}
+
+} // namespace
+
+bool save_scene(World const& world, std::string_view path) {
+    clock::time_point const start = clock::now();
+
+    auto ecs = world.ecs();
+    std::vector<ecs::entity_t> const& entities = ecs->get_entities();
+
+    SaveContext ctx{};
+    ctx.root = world.root();
+    uint64_t const max_entity = entities.empty() ? 0 : *std::max_element(entities.begin(), entities.end());
+    ctx.entity_index.resize(max_entity + 1, null_index);
+
+    SnapshotWriter out{};
+    uint64_t const header_offset = out.allocate(sizeof(SceneHeader));
+
+    // Entity table. The position of an entity in this table is its index in the snapshot.
+    uint64_t const num_entities = entities.size() - std::count(entities.begin(), entities.end(), ctx.root);
+    ctx.num_entities = num_entities;
+    uint64_t const entity_table_offset = out.allocate(num_entities * sizeof(uint64_t));
+    uint64_t index = 0;
+    for (ecs::entity_t entity: entities) {
+        if (entity == ctx.root) { continue; }
+        ctx.entity_index[entity] = index;
+        out.write(entity_table_offset + index * sizeof(uint64_t), entity);
+        ++index;
+    }
+
+    std::vector<ColumnEntry> columns{};
+    meta::for_each_component<save_column>(ecs.value, out, ctx, columns);
+
+    // Now that every column was written, all referenced assets are known.
+    for (size_t i = 0; i < ctx.paths.size(); ++i) {
+        ctx.path_entries[i].offset = out.allocate(ctx.paths[i].size());
+        std::memcpy(out.at(ctx.path_entries[i].offset), ctx.paths[i].data(), ctx.paths[i].size());
+    }
+    uint64_t const path_table_offset = out.allocate(ctx.path_entries.size() * sizeof(PathEntry));
+    if (!ctx.path_entries.empty()) {
+        std::memcpy(out.at(path_table_offset), ctx.path_entries.data(), ctx.path_entries.size() * sizeof(PathEntry));
+    }
+
+    uint64_t const column_table_offset = out.allocate(columns.size() * sizeof(ColumnEntry));
+    if (!columns.empty()) {
+        std::memcpy(out.at(column_table_offset), columns.data(), columns.size() * sizeof(ColumnEntry));
+    }
+
+    SceneHeader header{};
+    std::memcpy(header.magic, scene_magic, sizeof(scene_magic));
+    header.version = scene_version;
+    header.num_entities = num_entities;
+    header.entity_table_offset = entity_table_offset;
+    header.num_paths = ctx.path_entries.size();
+    header.path_table_offset = path_table_offset;
+    header.num_columns = columns.size();
+    header.column_table_offset = column_table_offset;
+    out.write(header_offset, header);
+
+    std::ofstream file{std::string{path}, std::ios::binary | std::ios::trunc};
+    if (!file) {
+        LOG_FORMAT(LogLevel::Error, "Could not open file {} for writing.", path);
+        return false;
+    }
+    file.write(reinterpret_cast<char const*>(out.data().data()), static_cast<std::streamsize>(out.data().size()));
+    if (!file) {
+        LOG_FORMAT(LogLevel::Error, "Failed to write scene snapshot {}.", path);
+        return false;
+    }
+
+    LOG_FORMAT(LogLevel::Performance, "Saved {} entities to scene snapshot {} in {:.2f} ms ({:.1f} MiB)",
+               num_entities, path, elapsed_ms(start), static_cast<float>(out.data().size()) / (1024.0f * 1024.0f));
+    return true;
+}
+
+bool load_scene(World& world, std::string_view path, ecs::entity_t parent) {
+    clock::time_point const start = clock::now();
+
+    util::MappedFile file{path};
+    if (!file.valid()) {
+        LOG_FORMAT(LogLevel::Error, "Could not open scene snapshot {}.", path);
+        return false;
+    }
+
+    LoadContext ctx{};
+    ctx.file = file.data();
+    ctx.parent = parent;
+    if (!ctx.in_bounds(0, sizeof(SceneHeader))) {
+        LOG_FORMAT(LogLevel::Error, "Scene snapshot {} is too small.", path);
+        return false;
+    }
+
+    SceneHeader const header = ctx.read<SceneHeader>(0);
+    if (!validate(ctx, header)) { return false; }
+
+    ctx.path_entries.resize(header.num_paths);
+    if (header.num_paths > 0) {
+        std::memcpy(ctx.path_entries.data(), ctx.file.data() + header.path_table_offset, header.num_paths * sizeof(PathEntry));
+    }
+    for (PathEntry const& entry: ctx.path_entries) {
+        if (!ctx.in_bounds(entry.offset, entry.length)) {
+            LOG_FORMAT(LogLevel::Error, "Scene snapshot {} has a corrupted path table.", path);
+            return false;
+        }
+    }
+
+    std::vector<ColumnEntry> columns(header.num_columns);
+    if (header.num_columns > 0) {
+        std::memcpy(columns.data(), ctx.file.data() + header.column_table_offset, header.num_columns * sizeof(ColumnEntry));
+    }
+    auto hierarchy_column = std::find_if(columns.begin(), columns.end(), [](ColumnEntry const& column) {
+        return meta::reflect<Hierarchy>().name() == column.name;
+    });
+    if (hierarchy_column == columns.end()) {
+        LOG_FORMAT(LogLevel::Error, "Scene snapshot {} has no hierarchy data.", path);
+        return false;
+    }
+
+    auto ecs = world.ecs();
+    if (!ecs->has_component<Hierarchy>(parent)) {
+        LOG_FORMAT(LogLevel::Error, "Cannot load scene snapshot {}: parent entity {} does not exist.", path, parent);
+        return false;
+    }
+
+    // Create all entities at once. Their ids are consecutive, but we still go through the remapping table so
+    // the file never depends on that.
+    ecs::entity_t const first = ecs->create_entities(header.num_entities);
+    ctx.entities.resize(header.num_entities);
+    for (uint64_t i = 0; i < header.num_entities; ++i) {
+        ctx.entities[i] = first + i;
+    }
+
+    for (ColumnEntry const& column: columns) {
+        if (!validate(ctx, column)) {
+            LOG_FORMAT(LogLevel::Error, "Scene snapshot {} has a corrupted column. Skipping.", path);
+            continue;
+        }
+
+        bool found = false;
+        meta::for_each_component<load_column>(ecs, column, ctx, found);
+        if (!found) {
+            LOG_FORMAT(LogLevel::Warning, "Scene snapshot column {} does not match any component. Skipping.", column.name);
+        }
+    }
+
+    // Every entity needs the components created by World::create_entity(). These are always present in snapshots
+    // saved by save_scene(), except for the world transform which is derived data.
+    ensure_component<Hierarchy>(ecs.value, ctx.entities);
+    ensure_component<Transform>(ecs.value, ctx.entities);
+    ensure_component<Name>(ecs.value, ctx.entities);
+    ensure_component<WorldTransform>(ecs.value, ctx.entities);
+
+    // Rebuild the child lists from the stored parents.
+    for (ecs::entity_t entity: ctx.entities) {
+        Hierarchy& hierarchy = ecs->get_component<Hierarchy>(entity);
+        hierarchy.this_entity = entity;
+        if (hierarchy.parent == ecs::no_entity) {
+            hierarchy.parent = parent;
+        }
+        ecs->get_component<Hierarchy>(hierarchy.parent).children.push_back(entity);
+    }
+
+    LOG_FORMAT(LogLevel::Performance, "Loaded {} entities from scene snapshot {} in {:.2f} ms",
+               header.num_entities, path, elapsed_ms(start));
+    return true;
+}
+
+}
@@ -1,13 +1,13 @@
 #include <andromeda/assets/loaders.hpp>
 
+#include <andromeda/assets/mapped_asset_file.hpp>
 #include <andromeda/graphics/context.hpp>
 #include <andromeda/graphics/texture.hpp>
 
-#include <assetlib/asset_file.hpp>
 #include <assetlib/texture.hpp>
 
-#include <plib/stream.hpp>
-
+#include <algorithm>
+#include <numeric>
 #include <string>
 
 namespace andromeda {
@@ -69,18 +69,47 @@ static VkFormat get_format(assetlib::TextureFormat format, assetlib::ColorSpace
     return VK_FORMAT_UNDEFINED;
 }
 
-void load_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, std::string_view path, uint32_t thread) {
+// Copy the staging memory to every mip level of the image, and transition it for use in shaders.
+static void record_texture_upload(ph::CommandBuffer& cmd, ph::ImageView view, ph::BufferSlice slice) {
+    cmd.transition_layout(
+        // Newly created image
+        ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
+        // Next usage is the copy buffer to image command, so transfer and write access.
+        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
+        // For the copy command to work the image needs to be in the TransferDstOptimal layout.
+        view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    cmd.copy_buffer_to_image(slice, view);
+    cmd.transition_layout(
+        // Right after the copy operation
+        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
+        // We don't use it anymore this submission
+        ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
+        // Next usage will be a shader read operation.
+        view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    );
+}
+
+thread::async_task load_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, std::string path,
+                                thread::cancellation_token token, uint32_t thread) {
     using namespace std::literals::string_literals;
 
-    assetlib::AssetFile file{};
-    plib::binary_input_stream in_stream = plib::binary_input_stream::from_file(path.data());
-    bool success = assetlib::load_binary_file(in_stream, file);
-    if (!success) {
+    // Map the file on an I/O thread, so this worker can run other tasks while opening it blocks. Mapping also starts
+    // reading the file ahead.
+    assets::MappedAssetFile file{};
+    co_await ctx.get_scheduler().schedule_io([&](uint32_t) {
+        file = assets::MappedAssetFile{path, assets::MappedAssetFile::Type::Texture};
+    }, {}, path, token);
+    // Skip the upload if the asset was unloaded while it was being read.
+    if (token.cancelled()) {
+        co_return;
+    }
+    if (!file.valid()) {
         LOG_FORMAT(LogLevel::Error, "Failed to open texture file {}", path);
-        return;
+        assets::impl::fail_load(handle);
+        co_return;
     }
 
-    assetlib::TextureInfo info = assetlib::read_texture_info(file);
+    assetlib::TextureInfo info = assetlib::read_texture_info(file.metadata());
     VkFormat format = get_format(info.format, info.colorspace);
 
     gfx::Texture texture{};
@@ -91,46 +120,27 @@ void load_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, std::string_vi
     ctx.name_object(texture.image.handle, path.data() + " - Image"s);
     ctx.name_object(texture.view, path.data() + " - ImageView"s);
 
-    // Upload data into staging buffer
+    // Decompress straight from the mapped file into staging memory. Copies from a buffer to an image need the offset to
+    // be a multiple of the texel size.
     uint32_t const size = get_full_image_byte_size(info.extents[0], info.extents[1], info.mip_levels, format);
+    gfx::UploadService& uploads = ctx.get_upload_service();
+    VkDeviceSize const texel_size = std::max(format_byte_size(format), 1u);
+    gfx::UploadService::Staging staging = uploads.allocate(size, std::lcm(VkDeviceSize{16}, texel_size));
+    if (!file.unpack(ctx.get_scheduler(), {staging.memory, size})) {
+        LOG_FORMAT(LogLevel::Error, "Failed to unpack texture file {}", path);
+        uploads.discard(staging);
+        ctx.destroy_image_view(texture.view);
+        ctx.destroy_image(texture.image);
+        assets::impl::fail_load(handle);
+        co_return;
+    }
+    // Don't keep the file mapped while waiting for the upload.
+    file = {};
 
-    ph::RawBuffer staging = ctx.create_buffer(ph::BufferType::TransferBuffer, size);
-    std::byte* memory = ctx.map_memory(staging);
-    // Unpack and decompress directly into the staging buffer.
-    assetlib::unpack_texture(info, file, memory);
-
-    // Now copy from the staging buffer to the image
-    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
-    ph::CommandBuffer cmd_buf = transfer.begin_single_time(thread);
-
-    cmd_buf.transition_layout(
-        // Newly created image
-        ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
-        // Next usage is the copy buffer to image command, so transfer and write access.
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // For the copy command to work the image needs to be in the TransferDstOptimal layout.
-        texture.view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    cmd_buf.copy_buffer_to_image(staging, texture.view);
-    cmd_buf.transition_layout(
-        // Right after the copy operation
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // We don't use it anymore this submission
-        ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
-        // Next usage will be a shader read operation.
-        texture.view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
-
-    VkFence fence = ctx.create_fence();
-    transfer.end_single_time(cmd_buf, fence);
-
-    // Wait until the task is complete
-    ctx.wait_for_fence(fence);
-
-    // Cleanup all resources and send the image to the asset system
-
-    ctx.destroy_buffer(staging);
-    ctx.destroy_fence(fence);
-    transfer.free_single_time(cmd_buf, thread);
+    // Wait until the upload is complete. The worker thread can run other tasks in the meantime.
+    co_await uploads.upload(staging, [view = texture.view, slice = staging.slice](ph::CommandBuffer& cmd) {
+        record_texture_upload(cmd, view, slice);
+    });
 
     assets::impl::make_ready(handle, texture);
 
@@ -139,53 +149,22 @@ void load_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, std::string_vi
                path, info.extents[0], info.extents[1], info.mip_levels, (float) size / (1024.0f * 1024.0f));
 }
 
-void load_1x1_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, uint8_t bytes[4], uint32_t thread) {
+void load_1x1_texture(gfx::Context& ctx, Handle<gfx::Texture> handle, uint8_t bytes[4]) {
     gfx::Texture texture{};
     texture.image = ctx.create_image(ph::ImageType::Texture, {1, 1}, VK_FORMAT_R8G8B8A8_SRGB);
     texture.view = ctx.create_image_view(texture.image);
 
-    // Upload data into staging buffer
     uint32_t const size = ph::format_size(VK_FORMAT_R8G8B8A8_SRGB);
-
-    ph::RawBuffer staging = ctx.create_buffer(ph::BufferType::TransferBuffer, size);
-    std::byte* memory = ctx.map_memory(staging);
-    // Unpack and decompress directly into the staging buffer.
-    std::memcpy(memory, bytes, size);
-
-    // Now copy from the staging buffer to the image
-    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
-    ph::CommandBuffer cmd_buf = transfer.begin_single_time(thread);
-
-    cmd_buf.transition_layout(
-        // Newly created image
-        ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
-        // Next usage is the copy buffer to image command, so transfer and write access.
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // For the copy command to work the image needs to be in the TransferDstOptimal layout.
-        texture.view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    cmd_buf.copy_buffer_to_image(staging, texture.view);
-    cmd_buf.transition_layout(
-        // Right after the copy operation
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // We don't use it anymore this submission
-        ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
-        // Next usage will be a shader read operation.
-        texture.view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
-
-    VkFence fence = ctx.create_fence();
-    transfer.end_single_time(cmd_buf, fence);
-
-    // Wait until the task is complete
-    ctx.wait_for_fence(fence);
-
-    // Cleanup all resources and send the image to the asset system
-
-    ctx.destroy_buffer(staging);
-    ctx.destroy_fence(fence);
-    transfer.free_single_time(cmd_buf, thread);
-
-    assets::impl::make_ready(handle, texture);
+    gfx::UploadService& uploads = ctx.get_upload_service();
+    gfx::UploadService::Staging staging = uploads.allocate(size);
+    std::memcpy(staging.memory, bytes, size);
+
+    // The texture becomes ready once the upload completes.
+    uploads.submit(staging, [view = texture.view, slice = staging.slice](ph::CommandBuffer& cmd) {
+        record_texture_upload(cmd, view, slice);
+    }, [handle, texture]() {
+        assets::impl::make_ready(handle, texture);
+    });
 }
 
 } // namespace impl
@@ -1,5 +1,6 @@
 #include <andromeda/ecs/registry.hpp>
 
+#include <algorithm>
 #include <tuple>
 
 namespace andromeda::ecs {
@@ -14,6 +15,35 @@ entity_t registry::create_entity() {
     return id;
 }
 
+entity_t registry::create_entities(size_t count) {
+    entity_t const first = id_generator.cur;
+    entities.reserve(entities.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        entities.push_back(id_generator.next());
+    }
+    return first;
+}
+
+void registry::destroy_entity(entity_t entity) {
+    destroy_entities(std::span<entity_t const>(&entity, 1));
+}
+
+void registry::destroy_entities(std::span<entity_t const> destroyed) {
+    if (destroyed.empty()) { return; }
+
+    for (storage_data& data: storages) {
+        if (data.storage == nullptr) { continue; }
+        for (entity_t entity: destroyed) {
+            data.storage->erase(entity);
+        }
+    }
+
+    std::vector<entity_t> sorted(destroyed.begin(), destroyed.end());
+    std::sort(sorted.begin(), sorted.end());
+    entities.erase(std::remove_if(entities.begin(), entities.end(), [&sorted](entity_t entity) {
+        return std::binary_search(sorted.begin(), sorted.end(), entity);
+    }), entities.end());
+}
 
 std::vector<entity_t> const& registry::get_entities() const {
     return entities;
@@ -0,0 +1,72 @@
+#include <andromeda/ecs/system_scheduler.hpp>
+
+#include <andromeda/app/log.hpp>
+
+#include <algorithm>
+
+namespace andromeda::ecs {
+
+static bool overlaps(std::vector<uint64_t> const& lhs, std::vector<uint64_t> const& rhs) {
+    // These lists are tiny, so a quadratic search is faster than anything fancy.
+    return std::any_of(lhs.begin(), lhs.end(), [&rhs](uint64_t id) {
+        return std::find(rhs.begin(), rhs.end(), id) != rhs.end();
+    });
+}
+
+bool SystemAccess::conflicts_with(SystemAccess const& other) const {
+    return overlaps(writes, other.writes) || overlaps(writes, other.reads) || overlaps(reads, other.writes);
+}
+
+void SystemAccess::prepare_storage(ecs::registry& ecs) const {
+    for (auto prepare: prepare_functions) {
+        prepare(ecs);
+    }
+}
+
+void SystemScheduler::add_system(std::string name, SystemAccess access, system_function function) {
+    System system{
+        .name = std::move(name),
+        .access = std::move(access),
+        .function = std::move(function)
+    };
+
+    // Build the edges of the conflict graph. Conflicting systems keep their registration order.
+    for (uint32_t i = 0; i < systems.size(); ++i) {
+        if (system.access.conflicts_with(systems[i].access)) {
+            system.dependencies.push_back(i);
+        }
+    }
+
+    LOG_FORMAT(LogLevel::Info, "Registered system '{}' with {} dependencies", system.name, system.dependencies.size());
+    systems.push_back(std::move(system));
+}
+
+void SystemScheduler::run(World& world, thread::TaskScheduler& scheduler) {
+    if (systems.empty()) { return; }
+
+    // Lock the ECS once for all systems. Systems only access the components they declared, so they do not
+    // need any additional synchronization between each other.
+    thread::LockedValue<ecs::registry> ecs = world.ecs();
+    for (System const& system: systems) {
+        system.access.prepare_storage(ecs.value);
+    }
+
+    std::vector<thread::task_handle> tasks{};
+    tasks.reserve(systems.size());
+    for (System& system: systems) {
+        std::vector<thread::task_id> dependencies{};
+        dependencies.reserve(system.dependencies.size());
+        for (uint32_t dependency: system.dependencies) {
+            dependencies.push_back(tasks[dependency]);
+        }
+
+        tasks.push_back(scheduler.schedule([&system, &ecs](uint32_t thread) {
+            system.function(ecs.value, thread);
+        }, dependencies, thread::TaskPriority::FrameCritical, system.name));
+    }
+
+    // Wait until every system has completed before releasing the lock on the ECS.
+    scheduler.when_all(tasks).wait();
+}
+
+} // namespace andromeda::ecs
@@ -1,5 +1,7 @@
 #include <andromeda/editor/console.hpp>
 
+#include <andromeda/assets/scene_snapshot.hpp>
+
 #include <andromeda/editor/style.hpp>
 #include <andromeda/editor/widgets/table.hpp>
 #include <andromeda/graphics/context.hpp>
@@ -35,7 +37,7 @@ static ImVec4 log_level_color(LogLevel level) {
     }
 }
 
-Console::Console(gfx::Context& ctx, Window& window)
+Console::Console(gfx::Context& ctx, Window& window, World& world)
     : command_line("##console-cmd",
                    plib::bit_flag<InputText::Flags>(InputText::Flags::SubmitWithEnter)
                    | InputText::Flags::EnableCompletion | InputText::Flags::EnableHistory | InputText::Flags::FocusAfterSubmit) {
@@ -62,6 +64,39 @@ Console::Console(gfx::Context& ctx, Window& window)
         }
     }, load_asset_args);
 
+    std::vector<CommandParser::Argument> scene_args = {
+        {.name = "path", .description = "The path of the scene snapshot."},
+    };
+
+    command_parser.add_command("save-scene", [&world](std::vector<std::string> args) {
+        assets::save_scene(world, args[1]);
+    }, scene_args);
+
+    command_parser.add_command("load-scene", [&world](std::vector<std::string> args) {
+        assets::load_scene(world, args[1]);
+    }, scene_args);
+
+    std::vector<CommandParser::Argument> import_args = {
+        {.name = "path", .description = "The path of the entity file."},
+    };
+
+    command_parser.add_command("import-entity", [&world](std::vector<std::string> args) {
+        // Loading happens in the background, the entity is added to the world once it's ready.
+        world.import_when_ready(assets::load<ecs::entity_t>(args[1]));
+    }, import_args);
+
+    command_parser.add_command("begin-trace", [&ctx](auto args) {
+        ctx.get_scheduler().begin_trace();
+    }, {});
+
+    std::vector<CommandParser::Argument> trace_args = {
+        {.name = "path", .description = "The path of the trace file, can be opened in chrome://tracing."},
+    };
+
+    command_parser.add_command("end-trace", [&ctx](std::vector<std::string> args) {
+        ctx.get_scheduler().end_trace(args[1]);
+    }, trace_args);
+
     command_parser.add_command("shutdown", [&window](auto args) {
         window.close();
     }, {});
@@ -13,7 +13,7 @@ using namespace std::literals::string_literals;
 
 namespace andromeda::editor {
 
-Editor::Editor(gfx::Context& ctx, Window& window) : console(ctx, window) {
+Editor::Editor(gfx::Context& ctx, Window& window, World& world) : console(ctx, window, world) {
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
     io.ConfigWindowsMoveFromTitleBarOnly = true;
@@ -53,7 +53,7 @@ bool Editor::update(World& world, gfx::Context& ctx, gfx::Renderer& renderer) {
     // Display each active viewport
     for (gfx::Viewport vp : renderer.get_active_viewports()) {
         // Display the viewport
-        SceneViewport viewport{vp, ctx, renderer, world};
+        SceneViewport viewport{vp, ctx, renderer, world, inspector.selected()};
     }
 
     console.display();
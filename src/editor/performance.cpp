@@ -1,7 +1,12 @@
 #include <andromeda/editor/performance.hpp>
 
+#include <andromeda/editor/widgets/table.hpp>
 #include <andromeda/graphics/performance_counters.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
 namespace andromeda::editor {
 
 void PerformanceDisplay::display(gfx::Context& ctx) {
@@ -9,6 +14,16 @@ void PerformanceDisplay::display(gfx::Context& ctx) {
     float const a = 0.98f;
     float const dt = ctx.delta_time() * 1000.0f; // seconds to milliseconds.
     average_frametime = average_frametime * a + (1.0f - a) * dt;
+
+    thread::TaskScheduler& scheduler = ctx.get_scheduler();
+    scheduler_timer += ctx.delta_time();
+    if (scheduler_timer >= scheduler_interval) {
+        scheduler_stats = scheduler.stats();
+        scheduler.reset_stats();
+        scheduler_timer = 0.0f;
+    }
+    queue_history[queue_history_offset] = static_cast<float>(scheduler.queue_depth());
+    queue_history_offset = (queue_history_offset + 1) % queue_history.size();
     // Display
     if (visible) {
         if (ImGui::Begin("Performance##widget", &visible)) {
@@ -26,11 +41,58 @@ void PerformanceDisplay::display(gfx::Context& ctx) {
             std::string const invocations_text = fmt::format(FMT_STRING("shader stage invocations:\nvertex shader: {}\nfragment shader: {}\ncompute shader: {}"),
                                                              stats.vertex_invocations, stats.fragment_invocations, stats.compute_invocations);
             ImGui::TextUnformatted(invocations_text.c_str());
+
+            ImGui::Separator();
+            display_scheduler(scheduler);
         }
         ImGui::End();
     }
 }
 
+void PerformanceDisplay::display_scheduler(thread::TaskScheduler& scheduler) {
+    using ms = std::chrono::duration<float, std::milli>;
+
+    std::string const latency_text = fmt::format(FMT_STRING("task latency: {:.3f} ms average, {:.3f} ms max\ntasks queued: {}, outstanding: {}, cancelled: {}"),
+                                                 ms(scheduler_stats.average_latency).count(), ms(scheduler_stats.max_latency).count(),
+                                                 scheduler_stats.queued, scheduler_stats.outstanding, scheduler_stats.cancelled);
+    ImGui::TextUnformatted(latency_text.c_str());
+    ImGui::PlotLines("queued tasks##scheduler", queue_history.data(), static_cast<int>(queue_history.size()),
+                     static_cast<int>(queue_history_offset), nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+    {
+        ImGuiTableFlags const tbl_flags = ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_Borders;
+        Table table{"scheduler-table", 4, tbl_flags};
+        if (table.visible()) {
+            table.column("Thread##scheduler-col", Table::ColumnFlags::locked);
+            table.column("Tasks##scheduler-col", Table::ColumnFlags::locked);
+            table.column("Busy##scheduler-col", Table::ColumnFlags::locked);
+            table.column("Idle##scheduler-col", Table::ColumnFlags::locked);
+            table.header_row();
+
+            float const elapsed = std::max(ms(scheduler_stats.elapsed).count(), 1.0f);
+            for (thread::SchedulerStats::Thread const& thread: scheduler_stats.threads) {
+                table.next_column();
+                ImGui::TextUnformatted(thread.name.c_str());
+                table.next_column();
+                ImGui::Text("%llu", static_cast<unsigned long long>(thread.tasks));
+                table.next_column();
+                ImGui::Text("%.1f%%", 100.0f * ms(thread.busy).count() / elapsed);
+                table.next_column();
+                ImGui::Text("%.1f%%", 100.0f * ms(thread.idle).count() / elapsed);
+            }
+        }
+    }
+
+    // The trace can also be written to a different path with the end-trace console command.
+    if (scheduler.is_tracing()) {
+        if (ImGui::Button("Save trace##scheduler")) {
+            scheduler.end_trace(trace_path);
+        }
+    } else if (ImGui::Button("Record trace##scheduler")) {
+        scheduler.begin_trace();
+    }
+}
+
 bool& PerformanceDisplay::is_visible() {
     return visible;
 }
@@ -37,12 +37,12 @@ static std::string camera_string_display(thread::LockedValue<ecs::registry const
     return gfx::Viewport::local_string(viewport, ICON_FA_CAMERA " " + ecs->get_component<Name>(entity).name + "##");
 }
 
-SceneViewport::SceneViewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world) {
+SceneViewport::SceneViewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection) {
     // When this class is created this signals that this viewport must be shown, so we reset our viewport-static 'is_open' value to true.
     PerViewportStatic& vp_data = per_viewport[viewport.index()];
     vp_data.is_open = true;
 
-    show_viewport(viewport, ctx, renderer, world);
+    show_viewport(viewport, ctx, renderer, world, selection);
     show_debug_views(viewport, ctx, renderer);
 }
 
@@ -51,7 +51,7 @@ bool SceneViewport::is_visible() const {
     return visible;
 }
 
-void SceneViewport::show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world) {
+void SceneViewport::show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection) {
     // We want to fit the entire image inside the viewport without any padding.
     // ScopedStyleVar will automatically call PopStyleVar on destruction.
     auto padding = style::ScopedStyleVar<ImVec2>(ImGuiStyleVar_WindowPadding, ImVec2(0.0, 0.0));
@@ -70,6 +70,9 @@ void SceneViewport::show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx
         renderer.resize_viewport(ctx, viewport, vp_size.x, vp_size.y);
 
         display_image(ctx.get_attachment(viewport.target()).view);
+        if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+            pick_entity(viewport, renderer, world, selection);
+        }
 
         show_panel(viewport, renderer, world);
     }
@@ -81,6 +84,22 @@ void SceneViewport::show_viewport(gfx::Viewport viewport, gfx::Context& ctx, gfx
     }
 }
 
+void SceneViewport::pick_entity(gfx::Viewport viewport, gfx::Renderer& renderer, World const& world, ecs::entity_t& selection) {
+    if (viewport.camera() == ecs::no_entity) { return; }
+
+    // Position of the mouse relative to the viewport image, in [0, 1]
+    ImVec2 const min = ImGui::GetItemRectMin();
+    ImVec2 const size = ImGui::GetItemRectSize();
+    ImVec2 const mouse = ImGui::GetMousePos();
+    float const x = (mouse.x - min.x) / size.x;
+    float const y = (mouse.y - min.y) / size.y;
+
+    // Objects are picked by their bounding box, so the closest box under the cursor wins.
+    math::Ray const ray = renderer.get_camera_ray(viewport, x, y);
+    std::optional<math::BVH::RayHit> hit = world.spatial_index()->raycast(ray);
+    selection = hit ? hit->entity : ecs::no_entity;
+}
+
 void SceneViewport::show_menu_bar(gfx::Viewport viewport, gfx::Renderer& renderer) {
     PerViewportStatic& vp_data = per_viewport[viewport.index()];
     auto padding = style::ScopedStyleVar<ImVec2>(ImGuiStyleVar_WindowPadding, style::default_style().WindowPadding);
@@ -2,7 +2,7 @@
 
 namespace andromeda::gfx::backend {
 
-AtmosphereRendering::AtmosphereRendering(gfx::Context& ctx, VkSampleCountFlagBits samples, float sample_ratio) : ctx(ctx) {
+AtmosphereRendering::AtmosphereRendering(gfx::Context& ctx, gfx::PipelineBatch& pipelines, VkSampleCountFlagBits samples, float sample_ratio) : ctx(ctx) {
     /*
     {
         ph::ComputePipelineCreateInfo pci = ph::ComputePipelineBuilder::create(ctx, "transmittance")
@@ -21,11 +21,11 @@ AtmosphereRendering::AtmosphereRendering(gfx::Context& ctx, VkSampleCountFlagBit
     }
      */
 
-    {
-        // TODO: Remove depth test as we want to add some sort of height fog to visible geometry.
-        //       For now we will just render the atmosphere behind everything and ignore this.
-        // This pipeline will draw a full screen quad at depth == 1.0 to render it behind everything else.
-        ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "atmosphere")
+    // TODO: Remove depth test as we want to add some sort of height fog to visible geometry.
+    //       For now we will just render the atmosphere behind everything and ignore this.
+    // This pipeline will draw a full screen quad at depth == 1.0 to render it behind everything else.
+    pipelines.add([&ctx, samples, sample_ratio]() -> ph::PipelineCreateInfo {
+        return ph::PipelineBuilder::create(ctx, "atmosphere")
             .add_shader("data/shaders/atmosphere.vert.spv", "main", ph::ShaderStage::Vertex)
             .add_shader("data/shaders/atmosphere.frag.spv", "main", ph::ShaderStage::Fragment)
             .set_depth_test(true)
@@ -40,8 +40,7 @@ AtmosphereRendering::AtmosphereRendering(gfx::Context& ctx, VkSampleCountFlagBit
             .set_sample_shading(sample_ratio)
             .reflect()
             .get();
-        ctx.create_named_pipeline(std::move(pci));
-    }
+    });
 
     transmittance = ctx.create_image(ph::ImageType::StorageImage, { ANDROMEDA_TRANSMITTANCE_LUT_WIDTH, ANDROMEDA_TRANSMITTANCE_LUT_HEIGHT }, VK_FORMAT_R32G32B32A32_SFLOAT);
     transmittance_view = ctx.create_image_view(transmittance);
@@ -25,22 +25,24 @@ void DebugGeometryList::set_color(gfx::Viewport const& viewport, glm::vec3 color
     vp[viewport.index()].commands.push_back(cmd);
 }
 
-void DebugGeometryList::initialize(gfx::Context& ctx) {
-    ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "debug_draw_lines")
-        .add_shader("data/shaders/debug_draw.vert.spv", "main", ph::ShaderStage::Vertex)
-        .add_shader("data/shaders/debug_draw.frag.spv", "main", ph::ShaderStage::Fragment)
-        .set_polygon_mode(VK_POLYGON_MODE_LINE)
-        .add_blend_attachment(false)
-        .set_depth_test(false)
-        .set_depth_write(false)
-        .add_vertex_input(0)
-        .add_vertex_attribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT) // iPos
-        .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
-        .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
-        .reflect()
-        .get();
-    pci.input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-    ctx.create_named_pipeline(std::move(pci));
+void DebugGeometryList::initialize(gfx::Context& ctx, gfx::PipelineBatch& pipelines) {
+    pipelines.add([&ctx]() -> ph::PipelineCreateInfo {
+        ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "debug_draw_lines")
+            .add_shader("data/shaders/debug_draw.vert.spv", "main", ph::ShaderStage::Vertex)
+            .add_shader("data/shaders/debug_draw.frag.spv", "main", ph::ShaderStage::Fragment)
+            .set_polygon_mode(VK_POLYGON_MODE_LINE)
+            .add_blend_attachment(false)
+            .set_depth_test(false)
+            .set_depth_write(false)
+            .add_vertex_input(0)
+            .add_vertex_attribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT) // iPos
+            .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
+            .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
+            .reflect()
+            .get();
+        pci.input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        return pci;
+    });
 }
 
 void DebugGeometryList::clear(gfx::Viewport const& viewport) {
@@ -16,7 +16,7 @@ using namespace std::literals::string_literals;
 namespace andromeda::gfx::backend {
 
 
-ForwardPlusRenderer::ForwardPlusRenderer(gfx::Context& ctx) : RendererBackend(ctx), render_data(ctx) {
+ForwardPlusRenderer::ForwardPlusRenderer(gfx::Context& ctx, gfx::PipelineBatch& pipelines) : RendererBackend(ctx), render_data(ctx, pipelines) {
     for (int i = 0; i < gfx::MAX_VIEWPORTS; ++i) {
         // Note that only the main color and depth attachments need to be multisampled
 
@@ -44,23 +44,22 @@ ForwardPlusRenderer::ForwardPlusRenderer(gfx::Context& ctx) : RendererBackend(ct
         ctx.name_object(render_data.vp[i].average_luminance.handle, gfx::Viewport::local_string(i, "Average Luminance"));
     }
 
-    create_depth_only_pipeline(ctx, render_data.msaa_samples, render_data.msaa_sample_ratio);
-    create_skybox_pipeline(ctx, render_data.msaa_samples, render_data.msaa_sample_ratio);
-    create_luminance_histogram_pipelines(ctx);
-    create_tonemapping_pipeline(ctx);
+    create_depth_only_pipeline(ctx, pipelines, render_data.msaa_samples, render_data.msaa_sample_ratio);
+    create_skybox_pipeline(ctx, pipelines, render_data.msaa_samples, render_data.msaa_sample_ratio);
+    create_luminance_histogram_pipelines(ctx, pipelines);
+    create_tonemapping_pipeline(ctx, pipelines);
 
     // Light culling shader
-    {
-        ph::ComputePipelineCreateInfo pci = ph::ComputePipelineBuilder::create(ctx, "light_cull")
+    pipelines.add([&ctx]() -> ph::ComputePipelineCreateInfo {
+        return ph::ComputePipelineBuilder::create(ctx, "light_cull")
             .set_shader("data/shaders/light_cull.comp.spv", "main")
             .reflect()
             .get();
-        ctx.create_named_pipeline(std::move(pci));
-    }
+    });
 
     // Final shading pipeline
-    {
-        ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "shading")
+    pipelines.add([&ctx, samples = render_data.msaa_samples, sample_ratio = render_data.msaa_sample_ratio]() -> ph::PipelineCreateInfo {
+        return ph::PipelineBuilder::create(ctx, "shading")
             .add_shader("data/shaders/shading.vert.spv", "main", ph::ShaderStage::Vertex)
             .add_shader("data/shaders/shading.frag.spv", "main", ph::ShaderStage::Fragment)
             .add_vertex_input(0)
@@ -75,12 +74,11 @@ ForwardPlusRenderer::ForwardPlusRenderer(gfx::Context& ctx) : RendererBackend(ct
             .set_depth_write(false) // Do not write to the depth buffer since we already have depth information
             .set_cull_mode(VK_CULL_MODE_BACK_BIT)
             .add_blend_attachment(true, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD)
-            .set_samples(render_data.msaa_samples)
-            .set_sample_shading(render_data.msaa_sample_ratio)
+            .set_samples(samples)
+            .set_sample_shading(sample_ratio)
             .reflect()
             .get();
-        ctx.create_named_pipeline(std::move(pci));
-    }
+    });
 }
 
 ForwardPlusRenderer::~ForwardPlusRenderer() {
@@ -129,7 +127,7 @@ void ForwardPlusRenderer::render_scene(ph::RenderGraph& graph, ph::InFlightConte
 
 
 //    graph.add_pass(render_data.atmosphere.lut_update_pass(viewport, ifc, scene));
-    graph.add_pass(build_depth_pass(ctx, ifc, depth_attachments[viewport.index()], scene, vp.camera, render_data.transforms));
+    graph.add_pass(build_depth_pass(ctx, ifc, depth_attachments[viewport.index()], viewport, scene, vp.camera, render_data.transforms));
     graph.add_pass(light_cull(ifc, viewport, scene));
     graph.add_pass(shading(ifc, viewport, scene));
     graph.add_pass(build_average_luminance_pass(ctx, ifc, color_attachments[viewport.index()], viewport, scene, vp.average_luminance));
@@ -281,7 +279,7 @@ ph::Pass ForwardPlusRenderer::shading(ph::InFlightContext& ifc, gfx::Viewport co
                 cmd.bind_descriptor_set(set);
 
                 // Loop over each mesh, check if it's ready and if so render it
-                for_each_ready_mesh(scene, [&scene, &vp_data, &cmd](auto const& draw, gfx::Mesh const& mesh, uint32_t index) {
+                for_each_ready_mesh(scene, viewport, [&scene, &vp_data, &cmd](auto const& draw, gfx::Mesh const& mesh, uint32_t index) {
                     // Don't draw if the material isn't ready yet.
                     if (!assets::is_ready(draw.material)) { return; }
                     gfx::Material const& material = *assets::get(draw.material);
@@ -41,13 +41,10 @@ SceneAccelerationStructure::~SceneAccelerationStructure() {
 
     destroy(bottom_level);
 
-    // If there is a BLAS update busy on another thread,
-    // queue a task to free that updated BLAS once it's done
-    // using a task dependency.
-    if (blas_update_task != static_cast<thread::task_id>(-1)) {
-        ctx.get_scheduler().schedule([this](auto thread) {
-            destroy(updated_blas);
-        }, {blas_update_task});
+    // If there is a BLAS update busy on another thread, wait for it so the updated BLAS can be freed.
+    if (blas_update_task.valid()) {
+        blas_update_task.wait();
+        destroy(updated_blas);
     }
 }
 
@@ -55,15 +52,14 @@ void SceneAccelerationStructure::update(gfx::SceneDescription const& scene) {
     // 1) We destroy items in the BLAS destroy queue.
     process_deletion_queue();
     // 2) Swap BLAS if update is done
-    if (blas_update_done) {
+    if (blas_update_task.valid() && blas_update_task.done()) {
         // We need to queue deletion for the old BLAS, since it might still be in use.
         queue_delete(bottom_level);
         // Now swap to the new BLAS.
         bottom_level = std::move(updated_blas);
         updated_blas = {};
-        // Reset synchronization objects so a new update can be queued properly.
-        blas_update_done = false;
-        blas_update_task = -1;
+        // Reset the task handle so a new update can be queued properly.
+        blas_update_task = {};
     }
 
     // 3) Queue BLAS update if necessary.
@@ -112,7 +108,9 @@ void SceneAccelerationStructure::process_deletion_queue() {
 
 bool SceneAccelerationStructure::must_update_blas(gfx::SceneDescription const& scene) {
     // First check if there is no BLAS update task currently running, and return false if there is.
-    if (blas_update_task != static_cast<thread::task_id>(-1)) { return false; }
+    if (blas_update_task.valid()) { return false; }
+    // Meshes that were hot reloaded keep their handle, but have new geometry.
+    if (assets::replace_count<gfx::Mesh>() != blas_mesh_replace_count) { return true; }
 
     auto scene_meshes = find_unique_meshes(scene);
     // Simple size test will already satisfy most cases.
@@ -143,10 +141,17 @@ void SceneAccelerationStructure::rebuild_blas_async(gfx::SceneDescription const&
     // Since another thread will be accessing the scene, we need to store all meshes
     // that will go into the rebuilt BLAS now.
     std::vector<Handle<gfx::Mesh>> scene_meshes = find_unique_meshes(scene);
+    blas_mesh_replace_count = assets::replace_count<gfx::Mesh>();
 
+    // The build reads the meshes on another thread while frames go on, so they must not be hot reloaded meanwhile.
+    assets::begin_background_read<gfx::Mesh>();
     blas_update_task = ctx.get_scheduler().schedule([this, scene_meshes](uint32_t const thread) {
         do_blas_rebuild(scene_meshes, thread);
-    }, {});
+        assets::end_background_read<gfx::Mesh>();
+    }, {}, thread::TaskPriority::FrameCritical);
+    if (!blas_update_task.valid()) {
+        assets::end_background_read<gfx::Mesh>();
+    }
 }
 
 namespace impl {
@@ -180,7 +185,10 @@ std::vector<BLASEntry> get_blas_entries(gfx::Context& ctx, std::vector<Handle<gf
     entries.reserve(meshes.size());
 
     for (Handle<gfx::Mesh> handle: meshes) {
-        gfx::Mesh const& mesh = *assets::get(handle);
+        gfx::Mesh const* mesh_ptr = assets::get(handle);
+        // The mesh was unloaded after the update was queued. It has no entry, so its instances are left out of the TLAS.
+        if (mesh_ptr == nullptr) { continue; }
+        gfx::Mesh const& mesh = *mesh_ptr;
 
         BLASEntry entry{};
         entry.geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -462,8 +470,7 @@ void SceneAccelerationStructure::do_blas_rebuild(std::vector<Handle<gfx::Mesh>>
     impl::compact_blas(ctx, blas, build_infos, resources, thread);
     // 6) Free up resources
     impl::free_build_resources(ctx, resources);
-    // Finally, we signal to the main thread that the BLAS build is complete
-    blas_update_done = true;
+    // The main thread picks up the new BLAS once blas_update_task has completed.
     LOG_WRITE_NOW(LogLevel::Performance, "RT: BLAS rebuild completed.");
 }
 
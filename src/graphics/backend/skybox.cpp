@@ -49,24 +49,25 @@ constexpr float skybox_vertices[] = {
 };
 }
 
-void create_skybox_pipeline(gfx::Context& ctx, VkSampleCountFlagBits samples, float sample_ratio) {
-    ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "skybox")
-        .add_shader("data/shaders/skybox.vert.spv", "main", ph::ShaderStage::Vertex)
-        .add_shader("data/shaders/skybox.frag.spv", "main", ph::ShaderStage::Fragment)
-        .add_vertex_input(0)
-        .add_vertex_attribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT) // iPos
-        .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
-        .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
-        .set_depth_test(true)
-        .set_depth_write(false)
-        .set_depth_op(VK_COMPARE_OP_LESS_OR_EQUAL)
-        .set_cull_mode(VK_CULL_MODE_NONE)
-        .add_blend_attachment(false)
-        .set_samples(samples)
-        .set_sample_shading(sample_ratio)
-        .reflect()
-        .get();
-    ctx.create_named_pipeline(std::move(pci));
+void create_skybox_pipeline(gfx::Context& ctx, gfx::PipelineBatch& pipelines, VkSampleCountFlagBits samples, float sample_ratio) {
+    pipelines.add([&ctx, samples, sample_ratio]() -> ph::PipelineCreateInfo {
+        return ph::PipelineBuilder::create(ctx, "skybox")
+            .add_shader("data/shaders/skybox.vert.spv", "main", ph::ShaderStage::Vertex)
+            .add_shader("data/shaders/skybox.frag.spv", "main", ph::ShaderStage::Fragment)
+            .add_vertex_input(0)
+            .add_vertex_attribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT) // iPos
+            .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
+            .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
+            .set_depth_test(true)
+            .set_depth_write(false)
+            .set_depth_op(VK_COMPARE_OP_LESS_OR_EQUAL)
+            .set_cull_mode(VK_CULL_MODE_NONE)
+            .add_blend_attachment(false)
+            .set_samples(samples)
+            .set_sample_shading(sample_ratio)
+            .reflect()
+            .get();
+    });
 }
 
 void render_skybox(gfx::Context& ctx, ph::InFlightContext& ifc, ph::CommandBuffer& cmd, gfx::Environment const& env, SceneDescription::CameraInfo const& camera) {
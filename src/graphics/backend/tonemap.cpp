@@ -2,36 +2,35 @@
 
 namespace andromeda::gfx::backend {
 
-void create_luminance_histogram_pipelines(gfx::Context& ctx) {
-    {
-        ph::ComputePipelineCreateInfo pci = ph::ComputePipelineBuilder::create(ctx, "luminance_accumulate")
+void create_luminance_histogram_pipelines(gfx::Context& ctx, gfx::PipelineBatch& pipelines) {
+    pipelines.add([&ctx]() -> ph::ComputePipelineCreateInfo {
+        return ph::ComputePipelineBuilder::create(ctx, "luminance_accumulate")
             .set_shader("data/shaders/luminance_accumulate.comp.spv", "main")
             .reflect()
             .get();
-        ctx.create_named_pipeline(std::move(pci));
-    }
-    {
-        ph::ComputePipelineCreateInfo pci = ph::ComputePipelineBuilder::create(ctx, "luminance_average")
+    });
+    pipelines.add([&ctx]() -> ph::ComputePipelineCreateInfo {
+        return ph::ComputePipelineBuilder::create(ctx, "luminance_average")
             .set_shader("data/shaders/luminance_average.comp.spv", "main")
             .reflect()
             .get();
-        ctx.create_named_pipeline(std::move(pci));
-    }
+    });
 }
 
-void create_tonemapping_pipeline(gfx::Context& ctx) {
-    ph::PipelineCreateInfo pci = ph::PipelineBuilder::create(ctx, "tonemap")
-        .add_shader("data/shaders/tonemap.vert.spv", "main", ph::ShaderStage::Vertex)
-        .add_shader("data/shaders/tonemap.frag.spv", "main", ph::ShaderStage::Fragment)
-        .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
-        .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
-        .set_depth_test(false)
-        .set_depth_write(false)
-        .set_cull_mode(VK_CULL_MODE_NONE)
-        .add_blend_attachment(false)
-        .reflect()
-        .get();
-    ctx.create_named_pipeline(std::move(pci));
+void create_tonemapping_pipeline(gfx::Context& ctx, gfx::PipelineBatch& pipelines) {
+    pipelines.add([&ctx]() -> ph::PipelineCreateInfo {
+        return ph::PipelineBuilder::create(ctx, "tonemap")
+            .add_shader("data/shaders/tonemap.vert.spv", "main", ph::ShaderStage::Vertex)
+            .add_shader("data/shaders/tonemap.frag.spv", "main", ph::ShaderStage::Fragment)
+            .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
+            .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
+            .set_depth_test(false)
+            .set_depth_write(false)
+            .set_cull_mode(VK_CULL_MODE_NONE)
+            .add_blend_attachment(false)
+            .reflect()
+            .get();
+    });
 }
 
 ph::Pass build_average_luminance_pass(gfx::Context& ctx, ph::InFlightContext& ifc, std::string_view main_hdr, gfx::Viewport const& viewport,
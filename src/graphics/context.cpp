@@ -1,6 +1,7 @@
 #include <andromeda/graphics/context.hpp>
 
 #include <andromeda/assets/loaders.hpp>
+#include <andromeda/thread/coroutine.hpp>
 
 namespace andromeda {
 namespace gfx {
@@ -67,6 +68,7 @@ std::unique_ptr<Context> Context::init(Window& window, Log& logger, thread::Task
                ctx->get_queue(ph::QueueType::Transfer)->dedicated());
     LOG_FORMAT(LogLevel::Performance, "Compute queue is dedicated: {}",
                ctx->get_queue(ph::QueueType::Compute)->dedicated());
+    LOG_FORMAT(LogLevel::Performance, "Asset file I/O backend: {}", ctx->io_service.backend_name());
 
 
     return ctx;
@@ -77,78 +79,63 @@ float Context::delta_time() const {
 }
 
 Context::Context(ph::AppSettings settings, Window& window, thread::TaskScheduler& scheduler)
-    : ph::Context(std::move(settings)), window(window), scheduler(scheduler) {
+    : ph::Context(std::move(settings)), window(window), scheduler(scheduler), io_service(scheduler),
+      upload_service(*this) {
 
 
 }
 
-Handle<gfx::Texture> Context::request_texture(std::string const& path) {
+void Context::request_texture(Handle<gfx::Texture> handle, std::string const& path, thread::TaskPriority priority) {
     LOG_FORMAT(LogLevel::Info, "Loading texture at path {}.", path);
-    Handle<gfx::Texture> handle = assets::impl::insert_pending<gfx::Texture>();
-    thread::task_id task = scheduler.schedule([this, handle, path](uint32_t thread) {
-        try {
-            impl::load_texture(*this, handle, path, thread + 1);
-        }
-        catch (std::exception const& e) {
-            LOG_FORMAT(LogLevel::Error, "Exception while loading texture {}: {}", path, e.what());
-        }
-    });
+    // The loader is a coroutine, so the task we get back completes when the whole load has completed. The priority
+    // comes from the asset system, textures loaded by scenes are loaded after their meshes and materials.
+    // All work of the load is in its own task group, so unloading the texture early can cancel it.
+    thread::task_group group{};
+    thread::task_handle task = thread::spawn(scheduler, [this, handle, path, token = group.token()](uint32_t thread) {
+        return impl::load_texture(*this, handle, path, token, thread + 1);
+    }, "loading texture " + path, priority, group.token());
     // Store load task so we can give the unload task a proper dependency.
     assets::impl::set_load_task(handle, task);
-    assets::impl::set_path(handle, path);
-    return handle;
+    assets::impl::set_load_group(handle, group);
 }
 
-Handle<gfx::Mesh> Context::request_mesh(std::string const& path) {
+void Context::request_mesh(Handle<gfx::Mesh> handle, std::string const& path, thread::TaskPriority priority) {
     LOG_FORMAT(LogLevel::Info, "Loading mesh at path {}", path);
-    Handle<gfx::Mesh> handle = assets::impl::insert_pending<gfx::Mesh>();
-    thread::task_id task = scheduler.schedule([this, handle, path](uint32_t thread) {
-        try {
-            impl::load_mesh(*this, handle, path, thread + 1);
-        }
-        catch (std::exception const& e) {
-            LOG_FORMAT(LogLevel::Error, "Exception while loading mesh {}: {}", path, e.what());
-        }
-    });
+    thread::task_group group{};
+    thread::task_handle task = thread::spawn(scheduler, [this, handle, path, token = group.token()](uint32_t thread) {
+        return impl::load_mesh(*this, handle, path, token, thread + 1);
+    }, "loading mesh " + path, priority, group.token());
     assets::impl::set_load_task(handle, task);
-    assets::impl::set_path(handle, path);
-    return handle;
+    assets::impl::set_load_group(handle, group);
 }
 
-Handle<gfx::Material> Context::request_material(std::string const& path) {
+void Context::request_material(Handle<gfx::Material> handle, std::string const& path, thread::TaskPriority priority) {
     LOG_FORMAT(LogLevel::Info, "Loading material at path {}", path);
-    Handle<gfx::Material> handle = assets::impl::insert_pending<gfx::Material>();
-    scheduler.schedule([this, handle, path](uint32_t thread) {
-        try {
-            impl::load_material(*this, handle, path, thread + 1);
-        }
-        catch (std::exception const& e) {
-            LOG_FORMAT(LogLevel::Error, "Exception while loading material {}: {}", path, e.what());
-        }
-    });
-
-    // No need to set load task, as materials don't get unloaded explicitly.
-    assets::impl::set_path(handle, path);
-    return handle;
+    thread::task_group group{};
+    thread::spawn(scheduler, [this, handle, path, token = group.token()](uint32_t thread) {
+        return impl::load_material(*this, handle, path, token, thread + 1);
+    }, "loading material " + path, priority, group.token());
+    // No need to set load task, as materials don't own GPU resources that could still be in use. The group lets
+    // unloading stop the load before it starts loading textures.
+    assets::impl::set_load_group(handle, group);
 }
 
-Handle<gfx::Environment> Context::request_environment(std::string const& path) {
+void Context::request_environment(Handle<gfx::Environment> handle, std::string const& path, thread::TaskPriority priority) {
     LOG_FORMAT(LogLevel::Info, "Loading environment at path {}", path);
-    Handle<gfx::Environment> handle = assets::impl::insert_pending<gfx::Environment>();
-    thread::task_id task = scheduler.schedule([this, handle, path](uint32_t thread) {
-        try {
-            impl::load_environment(*this, handle, path, thread + 1);
-        } catch (std::exception const& e) {
-            LOG_FORMAT(LogLevel::Error, "Exception while loading environment {}: {}", path, e.what());
-        }
-    }, {});
+    thread::task_group group{};
+    thread::task_handle task = thread::spawn(scheduler, [this, handle, path, token = group.token()](uint32_t thread) {
+        return impl::load_environment(*this, handle, path, token, thread + 1);
+    }, "loading environment " + path, priority, group.token());
     assets::impl::set_load_task(handle, task);
-    assets::impl::set_path(handle, path);
-    return handle;
+    assets::impl::set_load_group(handle, group);
 }
 
 void Context::free_texture(Handle<gfx::Texture> handle) {
     try {
+        // Stop the load if it is still in progress, there's no use in uploading a texture that is freed right after.
+        assets::impl::cancel_load(handle);
+        // Loading the same file again while the texture is being freed must start a new load.
+        assets::impl::unregister_path(handle);
         // If we free a texture before it is fully loaded we will get an error, unless
         // we set the load task as a dependency of the unload task
         thread::task_id dependency = assets::impl::get_load_task(handle);
@@ -158,7 +145,13 @@ void Context::free_texture(Handle<gfx::Texture> handle) {
         if (dependency != static_cast<thread::task_id>(-1)) {
             dependencies.push_back(dependency);
         }
-        scheduler.schedule([this, handle](uint32_t thread) {
+        // Deferred deletes run on the main thread within its frame budget, so they don't hold up the workers.
+        scheduler.schedule_main([this, handle](uint32_t thread) {
+            // The load was cancelled or failed, so there are no resources to free.
+            if (!assets::is_ready(handle)) {
+                assets::impl::delete_asset(handle);
+                return;
+            }
             gfx::Texture* tex = assets::get(handle);
             if (tex == nullptr) {
                 LOG_WRITE(LogLevel::Error, "Tried to delete null texture");
@@ -168,7 +161,7 @@ void Context::free_texture(Handle<gfx::Texture> handle) {
             destroy_image(tex->image);
             // Remove the asset from the asset system.
             assets::impl::delete_asset(handle);
-        }, dependencies);
+        }, dependencies, thread::TaskPriority::Background);
     }
     catch (std::exception const& e) {
         LOG_FORMAT(LogLevel::Fatal, "Fatal exception occurred. Provided message: {}", e.what());
@@ -178,6 +171,8 @@ void Context::free_texture(Handle<gfx::Texture> handle) {
 
 void Context::free_mesh(Handle<gfx::Mesh> handle) {
     try {
+        assets::impl::cancel_load(handle);
+        assets::impl::unregister_path(handle);
         // If we free a mesh before it is fully loaded we will get an error, unless
         // we set the load task as a dependency of the unload task
         thread::task_id dependency = assets::impl::get_load_task(handle);
@@ -187,7 +182,11 @@ void Context::free_mesh(Handle<gfx::Mesh> handle) {
         if (dependency != static_cast<thread::task_id>(-1)) {
             dependencies.push_back(dependency);
         }
-        scheduler.schedule([this, handle](uint32_t thread) {
+        scheduler.schedule_main([this, handle](uint32_t thread) {
+            if (!assets::is_ready(handle)) {
+                assets::impl::delete_asset(handle);
+                return;
+            }
             gfx::Mesh* mesh = assets::get(handle);
             if (mesh == nullptr) {
                 LOG_WRITE(LogLevel::Error, "Tried to delete null mesh");
@@ -197,7 +196,7 @@ void Context::free_mesh(Handle<gfx::Mesh> handle) {
             destroy_buffer(mesh->indices);
             // Remove the asset from the asset system.
             assets::impl::delete_asset(handle);
-        }, dependencies);
+        }, dependencies, thread::TaskPriority::Background);
     }
     catch (std::exception const& e) {
         LOG_FORMAT(LogLevel::Fatal, "Fatal exception occurred. Provided message: {}", e.what());
@@ -207,12 +206,18 @@ void Context::free_mesh(Handle<gfx::Mesh> handle) {
 
 void Context::free_environment(Handle<gfx::Environment> handle) {
     try {
+        assets::impl::cancel_load(handle);
+        assets::impl::unregister_path(handle);
         thread::task_id dependency = assets::impl::get_load_task(handle);
         std::vector<thread::task_id> dependencies;
         if (dependency != static_cast<thread::task_id>(-1)) {
             dependencies.push_back(dependency);
         }
-        scheduler.schedule([this, handle](uint32_t thread) {
+        scheduler.schedule_main([this, handle](uint32_t thread) {
+            if (!assets::is_ready(handle)) {
+                assets::impl::delete_asset(handle);
+                return;
+            }
             gfx::Environment* env = assets::get(handle);
             if (env == nullptr) {
                 LOG_WRITE(LogLevel::Error, "Tried to delete null environment");
@@ -225,7 +230,7 @@ void Context::free_environment(Handle<gfx::Environment> handle) {
             destroy_image_view(env->irradiance_view);
             destroy_image_view(env->specular_view);
             assets::impl::delete_asset(handle);
-        }, dependencies);
+        }, dependencies, thread::TaskPriority::Background);
     }
     catch (std::exception const& e) {
         LOG_FORMAT(LogLevel::Fatal, "Fatal exception occurred. Provided message: {}", e.what());
@@ -0,0 +1,85 @@
+#include <andromeda/graphics/pipeline_batch.hpp>
+
+#include <andromeda/app/log.hpp>
+
+#include <chrono>
+
+namespace andromeda::gfx {
+
+PipelineBatch::~PipelineBatch() {
+    // Running tasks still reference the entries, so we can't destroy them before they are done.
+    done.wait();
+}
+
+void PipelineBatch::add(graphics_builder builder) {
+    entries.push_back(Entry{.builder = std::move(builder)});
+}
+
+void PipelineBatch::add(compute_builder builder) {
+    entries.push_back(Entry{.builder = std::move(builder)});
+}
+
+void PipelineBatch::compile(thread::TaskScheduler& scheduler) {
+    if (done.valid()) {
+        LOG_WRITE(LogLevel::Warning, "Pipeline batch was already compiled");
+        return;
+    }
+
+    std::vector<thread::task_handle> builds{};
+    builds.reserve(entries.size());
+    // Note that entries may not be resized after this point, since the tasks hold references into it.
+    for (Entry& entry: entries) {
+        builds.push_back(scheduler.schedule([&entry](uint32_t thread) {
+            build(entry);
+        }));
+    }
+    done = scheduler.when_all(builds);
+}
+
+void PipelineBatch::finish(gfx::Context& ctx) {
+    auto const start = std::chrono::high_resolution_clock::now();
+    if (done.valid()) {
+        done.wait();
+    } else {
+        for (Entry& entry: entries) {
+            build(entry);
+        }
+    }
+    auto const end = std::chrono::high_resolution_clock::now();
+
+    uint32_t created = 0;
+    for (Entry& entry: entries) {
+        if (auto* pci = std::get_if<ph::PipelineCreateInfo>(&entry.result)) {
+            ctx.create_named_pipeline(std::move(*pci));
+            ++created;
+        } else if (auto* cpci = std::get_if<ph::ComputePipelineCreateInfo>(&entry.result)) {
+            ctx.create_named_pipeline(std::move(*cpci));
+            ++created;
+        }
+    }
+
+    LOG_FORMAT(LogLevel::Performance, "Created {}/{} pipelines, waited {:.2f} ms for pipeline builds",
+               created, entries.size(), std::chrono::duration<float, std::milli>(end - start).count());
+
+    entries.clear();
+    done = {};
+}
+
+std::size_t PipelineBatch::size() const {
+    return entries.size();
+}
+
+void PipelineBatch::build(Entry& entry) {
+    // Exceptions can't propagate out of a task, so report them here. The pipeline will simply be missing.
+    try {
+        if (auto* builder = std::get_if<graphics_builder>(&entry.builder)) {
+            entry.result = (*builder)();
+        } else {
+            entry.result = std::get<compute_builder>(entry.builder)();
+        }
+    } catch (std::exception const& e) {
+        LOG_FORMAT(LogLevel::Error, "Failed to build pipeline: {}", e.what());
+    }
+}
+
+} // namespace andromeda::gfx
@@ -2,78 +2,69 @@
 
 #include <andromeda/graphics/backend/forward_plus.hpp>
 #include <andromeda/graphics/imgui.hpp>
+#include <andromeda/graphics/pipeline_batch.hpp>
 
 #include <andromeda/graphics/environment.hpp>
 
 #include <andromeda/components/transform.hpp>
 #include <andromeda/components/mesh_renderer.hpp>
 #include <andromeda/components/hierarchy.hpp>
+#include <andromeda/components/world_transform.hpp>
 
 #include <phobos/render_graph.hpp>
 
 #include <andromeda/math/transform.hpp>
+#include <andromeda/thread/parallel.hpp>
+
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace andromeda::gfx {
 
 /**
- * @brief Creates a 1x1 texture and returns a handle to it.
+ * @brief Creates the default textures and the default environment, and adds them to the scene.
+ *        All resources are uploaded in a single submission so we only have to wait for the transfer queue once.
  *        May only be called from the main thread.
  * @param ctx Reference to the graphics context.
- * @param format Format of the texture image.
- * @param color Color to fill the single pixel of the image with.
- * @param size Size of the color buffer (in bytes). This isn't fixed so we can create different image formats with a single function.
- * @return A handle to the 1x1 texture in the asset system.
+ * @param scene Scene description to register the default resources in.
  */
-static Handle<gfx::Texture> create_1x1_texture(gfx::Context& ctx, VkFormat format, uint8_t const* color, uint32_t size) {
-    ph::RawImage image = ctx.create_image(ph::ImageType::Texture, {1, 1}, format);
-    ph::ImageView view = ctx.create_image_view(image);
-
-    // Fill image data. For this we'll need a command buffer. Since this function runs on the main thread thread_index is zero.
-    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
-    ph::CommandBuffer cmd = transfer.begin_single_time(0);
+static void upload_default_resources(gfx::Context& ctx, gfx::SceneDescription& scene) {
+    // Every resource gets its own region in the staging buffer. Copy offsets must be a multiple of the texel size,
+    // so each region is aligned to the size of the largest texel we upload (a single RGBA32F value).
+    constexpr uint32_t region_size = 4 * sizeof(float);
+    constexpr uint32_t region_count = 5;
 
-    // Record transfer commands
-    ph::RawBuffer staging = ctx.create_buffer(ph::BufferType::TransferBuffer, size);
+    ph::RawBuffer staging = ctx.create_buffer(ph::BufferType::TransferBuffer, region_count * region_size);
     std::byte* memory = ctx.map_memory(staging);
-    std::memcpy(memory, color, size);
-    ctx.unmap_memory(staging);
 
-    // Issue copy layout transitions and copy commands
-    cmd.transition_layout(
-        // Newly created image
-        ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
-        // Next usage is the copy buffer to image command, so transfer and write access.
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // For the copy command to work the image needs to be in the TransferDstOptimal layout.
-        view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    cmd.copy_buffer_to_image(staging, view);
-    cmd.transition_layout(
-        // Right after the copy operation
-        ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-        // We don't use it anymore this submission
-        ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
-        // Next usage will be a shader read operation.
-        view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+    // Images to copy to, together with the offset of their data in the staging buffer.
+    std::vector<std::pair<ph::ImageView, uint32_t>> uploads{};
+    uint32_t offset = 0;
 
-    VkFence fence = ctx.create_fence();
-    transfer.end_single_time(cmd, fence);
-    ctx.wait_for_fence(fence);
-    ctx.destroy_fence(fence);
-    transfer.free_single_time(cmd, 0);
-    ctx.destroy_buffer(staging);
+    auto create_texture = [&](VkFormat format, std::span<uint8_t const> color, std::string const& name) {
+        ph::RawImage image = ctx.create_image(ph::ImageType::Texture, {1, 1}, format);
+        ph::ImageView view = ctx.create_image_view(image);
+        ctx.name_object(image, "default_" + name + " - image");
+        ctx.name_object(view, "default_" + name + " - view");
+
+        std::memcpy(memory + offset, color.data(), color.size());
+        uploads.emplace_back(view, offset);
+        offset += region_size;
 
-    gfx::Texture texture{
-        .image = image,
-        .view = view
+        return assets::take(gfx::Texture{.image = image, .view = view});
     };
 
-    return assets::take(texture);
-}
+    uint8_t const magenta[4]{255, 0, 255, 255};
+    uint8_t const up[4]{128, 128, 255, 255};
+    uint8_t const arm[4]{0, 255, 0, 0};
+    uint8_t const white[1]{255};
+    scene.set_default_albedo(create_texture(VK_FORMAT_R8G8B8A8_SRGB, magenta, "albedo"));
+    scene.set_default_normal(create_texture(VK_FORMAT_R8G8B8A8_UNORM, up, "normal"));
+    scene.set_default_metal_rough(create_texture(VK_FORMAT_R8G8B8A8_UNORM, arm, "metal/rough"));
+    scene.set_default_occlusion(create_texture(VK_FORMAT_R8_UNORM, white, "occlusion"));
 
-static Handle<gfx::Environment> create_default_environment(gfx::Context& ctx) {
     gfx::Environment env{};
-
     env.cubemap = ctx.create_image(ph::ImageType::EnvMap, {1, 1}, VK_FORMAT_R32G32B32A32_SFLOAT);
     env.irradiance = ctx.create_image(ph::ImageType::EnvMap, {1, 1}, VK_FORMAT_R32G32B32A32_SFLOAT);
     env.specular = ctx.create_image(ph::ImageType::EnvMap, {1, 1}, VK_FORMAT_R32G32B32A32_SFLOAT);
@@ -88,41 +79,61 @@ static Handle<gfx::Environment> create_default_environment(gfx::Context& ctx) {
     ctx.name_object(env.irradiance_view, "Default Envmap Irradiance - ImageView");
     ctx.name_object(env.specular_view, "Default Envmap Specular - ImageView");
 
-    ph::Queue& queue = *ctx.get_queue(ph::QueueType::Transfer);
-    ph::CommandBuffer cmd = queue.begin_single_time(0);
-
-    float data[4]{0.0f, 0.0f, 0.0f, 0.0f}; // zero alpha so this will never affect anything
-    ph::RawBuffer upload = ctx.create_buffer(ph::BufferType::TransferBuffer, sizeof(data));
-    std::byte* mem = ctx.map_memory(upload);
-    std::memcpy(mem, data, sizeof(data));
-    ctx.unmap_memory(upload);
+    // The three environment images share the same data.
+    float const env_data[4]{0.0f, 0.0f, 0.0f, 0.0f}; // zero alpha so this will never affect anything
+    std::memcpy(memory + offset, env_data, sizeof(env_data));
+    uploads.emplace_back(env.cubemap_view, offset);
+    uploads.emplace_back(env.irradiance_view, offset);
+    uploads.emplace_back(env.specular_view, offset);
+    offset += region_size;
+    ctx.unmap_memory(staging);
 
-    auto upload_image = [&ctx, &upload, &cmd](ph::ImageView img) {
+    // Record all copies into one command buffer. Since this function runs on the main thread thread_index is zero.
+    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
+    ph::CommandBuffer cmd = transfer.begin_single_time(0);
+    for (auto const& [view, region]: uploads) {
         cmd.transition_layout(
-            ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR, ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
-            img, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        cmd.copy_buffer_to_image(upload, img);
+            // Newly created image
+            ph::PipelineStage::TopOfPipe, VK_ACCESS_NONE_KHR,
+            // Next usage is the copy buffer to image command, so transfer and write access.
+            ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
+            // For the copy command to work the image needs to be in the TransferDstOptimal layout.
+            view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        cmd.copy_buffer_to_image(staging.slice(region, region_size), view);
         cmd.transition_layout(
-            ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT, ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
-            img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            // Right after the copy operation
+            ph::PipelineStage::Transfer, VK_ACCESS_MEMORY_WRITE_BIT,
+            // We don't use it anymore this submission
+            ph::PipelineStage::BottomOfPipe, VK_ACCESS_MEMORY_READ_BIT,
+            // Next usage will be a shader read operation.
+            view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         );
-    };
-
-    upload_image(env.cubemap_view);
-    upload_image(env.irradiance_view);
-    upload_image(env.specular_view);
+    }
 
     VkFence fence = ctx.create_fence();
-    queue.end_single_time(cmd, fence);
+    transfer.end_single_time(cmd, fence);
     ctx.wait_for_fence(fence);
     ctx.destroy_fence(fence);
-    queue.free_single_time(cmd, 0);
-    ctx.destroy_buffer(upload);
+    transfer.free_single_time(cmd, 0);
+    ctx.destroy_buffer(staging);
 
-    return assets::take(env);
+    scene.set_default_environment(assets::take(env));
 }
 
 Renderer::Renderer(gfx::Context& ctx, Window& window) {
+    // The BRDF LUT is loaded asynchronously, so start loading it before doing anything else.
+    Handle<gfx::Texture> brdf_lut = assets::load<gfx::Texture>("data/textures/brdf_lut.tx");
+    // No component references the LUT, so it must be kept loaded explicitly.
+    assets::retain(brdf_lut);
+    scene.set_brdf_lut(brdf_lut);
+
+    // Pipelines are built on the task scheduler while the rest of the renderer is being initialized.
+    // They are registered with the context at the end of this constructor.
+    gfx::PipelineBatch pipelines{};
+    backend::DebugGeometryList::initialize(ctx, pipelines);
+    impl = std::make_unique<backend::ForwardPlusRenderer>(ctx, pipelines);
+    pipelines.compile(ctx.get_scheduler());
+
     gfx::imgui::init(ctx, window);
 
     // Initialize viewports
@@ -136,44 +147,15 @@ Renderer::Renderer(gfx::Context& ctx, Window& window) {
         ctx.create_attachment(vp.target(), {vp.width(), vp.height()}, VK_FORMAT_R8G8B8A8_SRGB, ph::ImageType::ColorAttachment);
     }
 
-    // Create default textures and add them to the scene
-    {
-        uint8_t magenta[4]{255, 0, 255, 255};
-        uint8_t up[4]{128, 128, 255, 255};
-        uint8_t arm[4]{0, 255, 0, 0};
-        uint8_t white[1]{255};
-        Handle<gfx::Texture> albedo = create_1x1_texture(ctx, VK_FORMAT_R8G8B8A8_SRGB, magenta, sizeof(magenta));
-        Handle<gfx::Texture> normal = create_1x1_texture(ctx, VK_FORMAT_R8G8B8A8_UNORM, up, sizeof(up));
-        Handle<gfx::Texture> metal_rough = create_1x1_texture(ctx, VK_FORMAT_R8G8B8A8_UNORM, arm, sizeof(arm));
-        Handle<gfx::Texture> occlusion = create_1x1_texture(ctx, VK_FORMAT_R8_UNORM, white, sizeof(white));
-
-        auto name_default_tex = [&ctx](Handle<gfx::Texture> t, std::string const& base) {
-            gfx::Texture* tex = assets::get(t);
-            ctx.name_object(tex->image, "default_" + base + " - image");
-            ctx.name_object(tex->view, "default_" + base + " - view");
-        };
-
-        name_default_tex(albedo, "albedo");
-        name_default_tex(normal, "normal");
-        name_default_tex(metal_rough, "metal/rough");
-        name_default_tex(occlusion, "occlusion");
-
-        scene.set_default_albedo(albedo);
-        scene.set_default_normal(normal);
-        scene.set_default_metal_rough(metal_rough);
-        scene.set_default_occlusion(occlusion);
-    }
+    upload_default_resources(ctx, scene);
 
-    scene.set_default_environment(create_default_environment(ctx));
-    scene.set_brdf_lut(assets::load<gfx::Texture>("data/textures/brdf_lut.tx"));
-
-    backend::DebugGeometryList::initialize(ctx);
     // register global pointer
     backend::impl::_debug_geometry_list_ptr = &debug_geometry;
-    impl = std::make_unique<backend::ForwardPlusRenderer>(ctx);
 
     StatTracker::initialize(ctx);
     StatTracker::set_interval(60); // At 60 fps, this would update once every second.
+
+    pipelines.finish(ctx);
 }
 
 void Renderer::shutdown(gfx::Context& ctx) {
@@ -182,12 +164,45 @@ void Renderer::shutdown(gfx::Context& ctx) {
     impl.reset(nullptr);
 }
 
-void Renderer::render_frame(gfx::Context& ctx, World const& world, bool dirty) {
-    ph::InFlightContext ifc = ctx.wait_for_frame();
+void Renderer::register_systems(ecs::SystemScheduler& systems, World const& world) {
+    // Note that these two systems both write to the scene description, but they touch disjoint parts of it
+    // so they can safely run concurrently.
+    systems.add_system("gather_draws", ecs::SystemAccess{}.read<Hierarchy, WorldTransform, MeshRenderer>(),
+                       [this](ecs::registry& ecs, uint32_t thread) {
+        for (auto[hierarchy, transform, mesh]: std::as_const(ecs).view<Hierarchy, WorldTransform, MeshRenderer>()) {
+            // Register the used material before adding the draw
+            scene.add_material(mesh.material);
+            scene.add_draw(mesh.mesh, mesh.material, mesh.occluder, transform.local_to_world, hierarchy.this_entity);
+        }
+    });
+
+    systems.add_system("gather_lights",
+                       ecs::SystemAccess{}.read<Transform, WorldTransform, PointLight, DirectionalLight>().read_resource<math::BVH>(),
+                       [this, &world](ecs::registry& ecs, uint32_t thread) {
+        auto spatial_index = world.spatial_index();
+        for (auto[transform, light]: std::as_const(ecs).view<WorldTransform, PointLight>()) {
+            glm::vec3 const position = transform.local_to_world[3]; // Position is stored in the last column
+            // Lights that do not reach any geometry can't affect the image, so they don't need to be sent to the GPU.
+            if (!spatial_index->any_overlap(math::Sphere{position, light.radius})) { continue; }
+            scene.add_light(light, position);
+        }
 
+        for (auto[transform, light]: std::as_const(ecs).view<Transform, DirectionalLight>()) {
+            // Directional lights do not respect parent rotations.
+            glm::vec3 const rotation = transform.rotation;
+            scene.add_light(light, rotation);
+        }
+    });
+}
+
+void Renderer::begin_frame(bool dirty) {
     // Reset scene description from last frame
     scene.reset();
     scene.set_dirty(dirty);
+}
+
+void Renderer::render_frame(gfx::Context& ctx, World const& world) {
+    ph::InFlightContext ifc = ctx.wait_for_frame();
 
     for (auto const& viewport : viewports) {
         debug_geometry.clear(viewport.vp);
@@ -196,7 +211,7 @@ void Renderer::render_frame(gfx::Context& ctx, World const& world, bool dirty) {
 
     StatTracker::new_frame(ctx);
 
-    fill_scene_description(world);
+    fill_scene_description(ctx, world);
 
     ph::Pass clear_swap = ph::PassBuilder::create("clear")
         .add_attachment(ctx.get_swapchain_attachment_name(),
@@ -288,45 +303,48 @@ std::vector<std::string> Renderer::get_debug_views(gfx::Viewport viewport) {
     return impl->debug_views(viewport);
 }
 
-void Renderer::fill_scene_description(World const& world) {
+math::Ray Renderer::get_camera_ray(gfx::Viewport const& viewport, float x, float y) const {
+    SceneDescription::CameraInfo const& info = scene.get_camera_info(viewport);
+    // The projection matrix is flipped vertically, so the top of the viewport maps to y = -1.
+    glm::vec4 const ndc_near = glm::vec4(x * 2.0f - 1.0f, y * 2.0f - 1.0f, 0.0f, 1.0f);
+    glm::vec4 const ndc_far = glm::vec4(x * 2.0f - 1.0f, y * 2.0f - 1.0f, 1.0f, 1.0f);
+
+    glm::mat4 const inv_proj_view = info.inv_view * info.inv_projection;
+    glm::vec4 near = inv_proj_view * ndc_near;
+    glm::vec4 far = inv_proj_view * ndc_far;
+    near /= near.w;
+    far /= far.w;
+
+    return math::Ray{
+        .origin = glm::vec3(near),
+        .direction = glm::normalize(glm::vec3(far - near))
+    };
+}
+
+void Renderer::fill_scene_description(gfx::Context& ctx, World const& world) {
+    // Draws and lights were already added by the systems registered in register_systems().
     // Access the ECS.
     auto ecs = world.ecs();
 
-    std::unordered_map<ecs::entity_t, glm::mat4> transform_lookup{};
-
-    // Register all used materials
-    for (auto[_, mesh]: ecs->view<Transform, MeshRenderer>()) {
-        scene.add_material(mesh.material);
-    }
-
-    // Add all meshes in the world to the draw list
-    for (auto[_, mesh, hierarchy]: ecs->view<Transform, MeshRenderer, Hierarchy>()) {
-        glm::mat4 world_transform = math::local_to_world(hierarchy.this_entity, ecs, transform_lookup);
-        scene.add_draw(mesh.mesh, mesh.material, mesh.occluder, world_transform);
-    }
-
-    // Add lighting information
-    for (auto[_, light, hierarchy]: ecs->view<Transform, PointLight, Hierarchy>()) {
-        glm::mat4 const world_transform = math::local_to_world(hierarchy.this_entity, ecs, transform_lookup);
-        glm::vec3 const position = world_transform[3]; // Position is stored in the last column
-        scene.add_light(light, position);
-    }
-
-    for (auto[transform, light, hierarchy]: ecs->view<Transform, DirectionalLight, Hierarchy>()) {
-        // Directional lights do not respect parent rotations.
-        glm::vec3 const rotation = transform.rotation;
-        scene.add_light(light, rotation);
-    }
+    // The spatial index was updated by the systems this frame.
+    auto spatial_index = world.spatial_index();
 
-    // Add every camera/viewport combo.
+    // Find every camera/viewport combo. Don't render viewports with no camera.
+    std::vector<gfx::Viewport const*> active{};
     for (auto const& viewport: viewports) {
-        if (viewport.in_use) {
-            ecs::entity_t camera = viewport.vp.camera();
-            // Don't render viewports with no camera
-            if (camera == ecs::no_entity) { continue; }
-            scene.add_viewport(viewport.vp, ecs, camera);
+        if (viewport.in_use && viewport.vp.camera() != ecs::no_entity) {
+            active.push_back(&viewport.vp);
         }
     }
+
+    // Add and frustum cull viewports in parallel. Each viewport only writes to its own camera and visibility list.
+    thread::parallel_for(ctx.get_scheduler(), active.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            gfx::Viewport const& vp = *active[i];
+            scene.add_viewport(vp, ecs, vp.camera());
+            scene.cull_viewport(vp, spatial_index.value, ctx.get_scheduler());
+        }
+    });
 }
 
 } // namespace andromeda::gfx
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include <andromeda/components/environment.hpp>
 #include <andromeda/math/transform.hpp>
+#include <andromeda/thread/parallel.hpp>
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
@@ -22,8 +23,12 @@ void SceneDescription::set_dirty(bool d) {
     dirty = d;
 }
 
-void SceneDescription::add_draw(Handle<gfx::Mesh> mesh, Handle<gfx::Material> material, bool occluder, glm::mat4 const& transform) {
-    draws.push_back(Draw{mesh, material, occluder});
+void SceneDescription::add_draw(Handle<gfx::Mesh> mesh, Handle<gfx::Material> material, bool occluder, glm::mat4 const& transform, ecs::entity_t entity) {
+    if (entity >= entity_draws.size()) {
+        entity_draws.resize(entity + 1, no_draw);
+    }
+    entity_draws[entity] = draws.size();
+    draws.push_back(Draw{mesh, material, occluder, entity});
     draw_transforms.push_back(transform);
 }
 
@@ -129,6 +134,21 @@ void SceneDescription::add_viewport(gfx::Viewport const& vp, thread::LockedValue
     info.position = transform.position;
 }
 
+void SceneDescription::cull_viewport(gfx::Viewport const& vp, math::BVH const& bvh, thread::TaskScheduler& scheduler) {
+    CameraInfo const& info = cameras[vp.index()];
+    std::vector<uint32_t>& visible = visible_draws[vp.index()];
+    visible.clear();
+
+    math::Frustum const frustum = math::Frustum::from_matrix(info.proj_view);
+    bvh.query(frustum, [this, &visible](ecs::entity_t entity) {
+        if (entity < entity_draws.size() && entity_draws[entity] != no_draw) {
+            visible.push_back(entity_draws[entity]);
+        }
+    });
+    // Keep draws in submission order.
+    thread::parallel_sort(scheduler, visible.begin(), visible.end());
+}
+
 void SceneDescription::set_default_albedo(Handle<gfx::Texture> handle) {
     textures.default_albedo = handle;
 }
@@ -155,6 +175,10 @@ void SceneDescription::set_brdf_lut(Handle<gfx::Texture> handle) {
 
 void SceneDescription::reset() {
     dirty = false;
+    // Only reset the entries that were used last frame.
+    for (Draw const& draw: draws) {
+        entity_draws[draw.entity] = no_draw;
+    }
     draws.clear();
     draw_transforms.clear();
     textures.views.clear();
@@ -163,6 +187,10 @@ void SceneDescription::reset() {
     directional_lights.clear();
     num_shadowing_dir_lights = 0;
 
+    for (auto& visible: visible_draws) {
+        visible.clear();
+    }
+
     for (auto& cam: cameras) {
         cam.active = false;
         cam.environment = Handle<gfx::Environment>::none;
@@ -200,6 +228,10 @@ std::span<glm::mat4 const> SceneDescription::get_draw_transforms() const {
     return draw_transforms;
 }
 
+std::span<uint32_t const> SceneDescription::get_visible_draws(gfx::Viewport const& vp) const {
+    return visible_draws[vp.index()];
+}
+
 auto SceneDescription::get_camera_info(gfx::Viewport const& vp) const -> CameraInfo const& {
     return cameras[vp.index()];
 }
@@ -0,0 +1,172 @@
+#include <andromeda/graphics/upload_service.hpp>
+
+#include <utility>
+
+namespace andromeda::gfx {
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UploadService::Awaiter::Awaiter(UploadService& service, Staging staging, record_function record)
+    : service(service), staging(std::move(staging)), record(std::move(record)) {
+
+}
+
+void UploadService::Awaiter::await_suspend(std::coroutine_handle<thread::async_task::promise_type> coroutine) {
+    // Only queue the upload once the coroutine is suspended, since it may complete and resume the coroutine right away.
+    service.submit(std::move(staging), std::move(record), [coroutine]() {
+        coroutine.promise().resume_after();
+    });
+}
+
+UploadService::UploadService(ph::Context& ctx) : ctx(ctx) {
+    ring = ctx.create_buffer(ph::BufferType::TransferBuffer, ring_size);
+    ring_memory = ctx.map_memory(ring);
+    ctx.name_object(ring.handle, "[Buffer] Upload Staging Ring");
+}
+
+UploadService::~UploadService() {
+    // Nothing resumes the coroutines waiting on these uploads anymore, they are leaked. The application drains the
+    // service with wait_all() before shutting down, so this only frees the resources.
+    for (Batch& batch: in_flight) {
+        ctx.wait_for_fence(batch.fence);
+        retire(batch);
+    }
+    in_flight.clear();
+
+    // Uploads that were never submitted can't complete anymore, but their staging memory must still be freed.
+    for (Upload& upload: queued) {
+        if (upload.staging.dedicated) {
+            ctx.destroy_buffer(upload.staging.buffer);
+        }
+    }
+    ctx.destroy_buffer(ring);
+}
+
+UploadService::Staging UploadService::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    {
+        std::lock_guard lock{mutex};
+        // Nothing is in use, so start over at the beginning of the ring to leave room for large uploads.
+        if (allocations.empty()) {
+            head = align_up(head, ring_size);
+            tail = head;
+        }
+        uint64_t offset = align_up(head, alignment);
+        // Allocations may not wrap around the end of the ring, so skip ahead to the start of the ring if this one would.
+        if (offset % ring_size + size > ring_size) {
+            offset = align_up(align_up(offset, ring_size), alignment);
+        }
+        bool const fits = offset % ring_size + size <= ring_size;
+        if (fits && offset + size - tail <= ring_size) {
+            head = offset + size;
+            allocations.push_back(Allocation{.end = head});
+
+            Staging staging{};
+            staging.memory = ring_memory + offset % ring_size;
+            staging.slice = ring.slice(offset % ring_size, size);
+            staging.buffer = ring;
+            staging.base = offset % ring_size;
+            staging.allocation = first_allocation + allocations.size() - 1;
+            return staging;
+        }
+    }
+
+    // The ring is full or the upload is too large for it, so give it a buffer of its own.
+    Staging staging{};
+    staging.buffer = ctx.create_buffer(ph::BufferType::TransferBuffer, size);
+    staging.dedicated = true;
+    staging.memory = ctx.map_memory(staging.buffer);
+    staging.slice = staging.buffer.slice(0, size);
+    return staging;
+}
+
+UploadService::Awaiter UploadService::upload(Staging staging, record_function record) {
+    return Awaiter{*this, std::move(staging), std::move(record)};
+}
+
+void UploadService::submit(Staging staging, record_function record, completion_function on_complete) {
+    std::lock_guard lock{mutex};
+    queued.push_back(Upload{
+        .staging = std::move(staging),
+        .record = std::move(record),
+        .on_complete = std::move(on_complete)
+    });
+}
+
+void UploadService::discard(Staging staging) {
+    release(staging);
+}
+
+void UploadService::flush() {
+    // Fences of submissions to the same queue are signaled in submission order, so we can stop at the first batch that
+    // is still running.
+    while (!in_flight.empty() && vkGetFenceStatus(ctx.device(), in_flight.front().fence) == VK_SUCCESS) {
+        Batch batch = std::move(in_flight.front());
+        in_flight.pop_front();
+        // Free all staging memory before running the callbacks, since they may start new uploads.
+        retire(batch);
+        for (Upload& upload: batch.uploads) {
+            upload.on_complete();
+        }
+    }
+
+    std::vector<Upload> uploads;
+    {
+        std::lock_guard lock{mutex};
+        uploads.swap(queued);
+    }
+    if (uploads.empty()) { return; }
+
+    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
+    Batch batch{};
+    batch.cmd = transfer.begin_single_time(main_thread);
+    for (Upload& upload: uploads) {
+        upload.record(batch.cmd);
+    }
+    batch.fence = ctx.create_fence();
+    transfer.end_single_time(batch.cmd, batch.fence);
+    batch.uploads = std::move(uploads);
+    in_flight.push_back(std::move(batch));
+}
+
+void UploadService::wait_all() {
+    flush();
+    for (Batch& batch: in_flight) {
+        ctx.wait_for_fence(batch.fence);
+    }
+    // Completes every batch, since all of their fences are signaled now.
+    flush();
+}
+
+bool UploadService::is_idle() {
+    std::lock_guard lock{mutex};
+    return queued.empty() && in_flight.empty();
+}
+
+void UploadService::retire(Batch& batch) {
+    ph::Queue& transfer = *ctx.get_queue(ph::QueueType::Transfer);
+    transfer.free_single_time(batch.cmd, main_thread);
+    ctx.destroy_fence(batch.fence);
+    for (Upload& upload: batch.uploads) {
+        release(upload.staging);
+    }
+}
+
+void UploadService::release(Staging& staging) {
+    if (staging.dedicated) {
+        ctx.destroy_buffer(staging.buffer);
+        return;
+    }
+
+    std::lock_guard lock{mutex};
+    allocations[staging.allocation - first_allocation].completed = true;
+    // Uploads can complete out of allocation order, the ring space is only reused once everything before it completed.
+    while (!allocations.empty() && allocations.front().completed) {
+        tail = allocations.front().end;
+        allocations.pop_front();
+        ++first_allocation;
+    }
+}
+
+} // namespace andromeda::gfx
@@ -0,0 +1,130 @@
+#include <andromeda/math/bounds.hpp>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <algorithm>
+
+namespace andromeda::math {
+
+bool AABB::valid() const {
+    return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+float AABB::surface_area() const {
+    if (!valid()) { return 0.0f; }
+    glm::vec3 const size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+glm::vec3 AABB::center() const {
+    return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::extents() const {
+    return (max - min) * 0.5f;
+}
+
+Frustum Frustum::from_matrix(glm::mat4 const& proj_view) {
+    // Gribb-Hartmann plane extraction. glm matrices are column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    auto row = [&proj_view](int i) {
+        return glm::vec4(proj_view[0][i], proj_view[1][i], proj_view[2][i], proj_view[3][i]);
+    };
+
+    glm::vec4 const r0 = row(0);
+    glm::vec4 const r1 = row(1);
+    glm::vec4 const r2 = row(2);
+    glm::vec4 const r3 = row(3);
+
+    Frustum frustum{};
+    frustum.planes[0] = r3 + r0;
+    frustum.planes[1] = r3 - r0;
+    frustum.planes[2] = r3 + r1;
+    frustum.planes[3] = r3 - r1;
+    // With a zero to one depth range the near plane is simply z >= 0
+    frustum.planes[4] = r2;
+    frustum.planes[5] = r3 - r2;
+
+    for (glm::vec4& plane: frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+AABB merge(AABB const& lhs, AABB const& rhs) {
+    return AABB{
+        .min = glm::min(lhs.min, rhs.min),
+        .max = glm::max(lhs.max, rhs.max)
+    };
+}
+
+AABB expand(AABB const& box, float margin) {
+    return AABB{
+        .min = box.min - glm::vec3(margin),
+        .max = box.max + glm::vec3(margin)
+    };
+}
+
+AABB transform_aabb(AABB const& box, glm::mat4 const& transform) {
+    // Arvo's method: instead of transforming all eight corners, accumulate the minimum and maximum contribution
+    // of each matrix element separately.
+    glm::vec3 const translation = transform[3];
+    AABB result{.min = translation, .max = translation};
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            float const a = transform[column][row] * box.min[column];
+            float const b = transform[column][row] * box.max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+bool contains(AABB const& outer, AABB const& inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+        && outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+bool overlaps(AABB const& lhs, AABB const& rhs) {
+    return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x
+        && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y
+        && lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+}
+
+bool overlaps(AABB const& box, Sphere const& sphere) {
+    glm::vec3 const closest = glm::clamp(sphere.center, box.min, box.max);
+    glm::vec3 const delta = closest - sphere.center;
+    return glm::dot(delta, delta) <= sphere.radius * sphere.radius;
+}
+
+Containment classify(Frustum const& frustum, AABB const& box) {
+    glm::vec3 const center = box.center();
+    glm::vec3 const extents = box.extents();
+
+    Containment result = Containment::Inside;
+    for (glm::vec4 const& plane: frustum.planes) {
+        glm::vec3 const normal = glm::vec3(plane);
+        // Signed distance of the center, and the projected radius of the box onto the plane normal.
+        float const distance = glm::dot(normal, center) + plane.w;
+        float const radius = glm::dot(extents, glm::abs(normal));
+        if (distance < -radius) { return Containment::Outside; }
+        if (distance < radius) { result = Containment::Intersects; }
+    }
+    return result;
+}
+
+std::optional<float> intersect(Ray const& ray, glm::vec3 const& inv_direction, AABB const& box) {
+    // Slab test. Divisions by zero direction components produce infinities, which compare correctly.
+    glm::vec3 const t0 = (box.min - ray.origin) * inv_direction;
+    glm::vec3 const t1 = (box.max - ray.origin) * inv_direction;
+    glm::vec3 const t_min = glm::min(t0, t1);
+    glm::vec3 const t_max = glm::max(t0, t1);
+
+    float const enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+    float const exit = std::min(std::min(t_max.x, t_max.y), t_max.z);
+    if (enter > exit) { return std::nullopt; }
+    return enter;
+}
+
+} // namespace andromeda::math
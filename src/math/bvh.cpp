@@ -0,0 +1,317 @@
+#include <andromeda/math/bvh.hpp>
+
+#include <algorithm>
+
+namespace andromeda::math {
+
+BVH::BVH(float margin) : margin(margin) {
+
+}
+
+void BVH::insert(ecs::entity_t entity, AABB const& bounds) {
+    if (leaves.contains(entity)) {
+        update(entity, bounds);
+        return;
+    }
+
+    int32_t const leaf = allocate_node();
+    Node& node = nodes[leaf];
+    node.bounds = expand(bounds, margin);
+    node.entity = entity;
+    node.height = 0;
+    leaves.emplace(entity, leaf);
+    insert_leaf(leaf);
+}
+
+void BVH::remove(ecs::entity_t entity) {
+    auto it = leaves.find(entity);
+    if (it == leaves.end()) { return; }
+
+    remove_leaf(it->second);
+    free_node(it->second);
+    leaves.erase(it);
+}
+
+bool BVH::update(ecs::entity_t entity, AABB const& bounds) {
+    auto it = leaves.find(entity);
+    if (it == leaves.end()) {
+        insert(entity, bounds);
+        return true;
+    }
+
+    int32_t const leaf = it->second;
+    // Still inside the enlarged box, nothing to do.
+    if (math::contains(nodes[leaf].bounds, bounds)) { return false; }
+
+    remove_leaf(leaf);
+    nodes[leaf].bounds = expand(bounds, margin);
+    insert_leaf(leaf);
+    return true;
+}
+
+bool BVH::contains(ecs::entity_t entity) const {
+    return leaves.contains(entity);
+}
+
+void BVH::clear() {
+    nodes.clear();
+    leaves.clear();
+    root = null_node;
+    free_list = null_node;
+}
+
+std::size_t BVH::size() const {
+    return leaves.size();
+}
+
+AABB const& BVH::get_bounds(ecs::entity_t entity) const {
+    return nodes[leaves.at(entity)].bounds;
+}
+
+int32_t BVH::height() const {
+    if (root == null_node) { return 0; }
+    return nodes[root].height + 1;
+}
+
+bool BVH::any_overlap(AABB const& box) const {
+    return find_leaf([&box](AABB const& bounds) { return overlaps(bounds, box); });
+}
+
+bool BVH::any_overlap(Sphere const& sphere) const {
+    return find_leaf([&sphere](AABB const& bounds) { return overlaps(bounds, sphere); });
+}
+
+std::optional<BVH::RayHit> BVH::raycast(Ray const& ray, float max_distance) const {
+    std::optional<RayHit> closest = std::nullopt;
+    glm::vec3 const inv_direction = 1.0f / ray.direction;
+    for_each_ray_hit(ray, inv_direction, max_distance, [&closest](ecs::entity_t entity, float distance) {
+        if (!closest || distance < closest->distance) {
+            closest = RayHit{.entity = entity, .distance = distance};
+            return true;
+        }
+        return false;
+    });
+    return closest;
+}
+
+int32_t BVH::allocate_node() {
+    if (free_list != null_node) {
+        int32_t const index = free_list;
+        free_list = nodes[index].parent;
+        nodes[index] = Node{};
+        return index;
+    }
+
+    nodes.emplace_back();
+    return static_cast<int32_t>(nodes.size() - 1);
+}
+
+void BVH::free_node(int32_t index) {
+    Node& node = nodes[index];
+    node.height = -1;
+    node.entity = ecs::no_entity;
+    node.left = null_node;
+    node.right = null_node;
+    node.parent = free_list;
+    free_list = index;
+}
+
+int32_t BVH::find_best_sibling(AABB const& bounds) const {
+    // Branch and bound search for the sibling that causes the smallest increase in total surface area.
+    // The cost of choosing a node as sibling is the area of the new parent plus the area added to every ancestor
+    // (the inherited cost). A subtree can be skipped if even a perfect fit at the bottom can't beat the current best.
+    float const leaf_area = bounds.surface_area();
+
+    int32_t best = root;
+    float best_cost = merge(nodes[root].bounds, bounds).surface_area();
+
+    struct Entry {
+        int32_t index;
+        float inherited_cost;
+    };
+    std::vector<Entry> stack{};
+    stack.push_back({root, 0.0f});
+    while (!stack.empty()) {
+        Entry const entry = stack.back();
+        stack.pop_back();
+
+        Node const& node = nodes[entry.index];
+        float const direct_cost = merge(node.bounds, bounds).surface_area();
+        float const cost = direct_cost + entry.inherited_cost;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = entry.index;
+        }
+
+        if (node.is_leaf()) { continue; }
+        float const child_inherited_cost = entry.inherited_cost + direct_cost - node.bounds.surface_area();
+        float const lower_bound = leaf_area + child_inherited_cost;
+        if (lower_bound < best_cost) {
+            stack.push_back({node.left, child_inherited_cost});
+            stack.push_back({node.right, child_inherited_cost});
+        }
+    }
+
+    return best;
+}
+
+void BVH::insert_leaf(int32_t leaf) {
+    if (root == null_node) {
+        root = leaf;
+        nodes[leaf].parent = null_node;
+        return;
+    }
+
+    int32_t const sibling = find_best_sibling(nodes[leaf].bounds);
+    int32_t const old_parent = nodes[sibling].parent;
+    // Note that this may reallocate the node pool, so don't hold on to references across this call.
+    int32_t const new_parent = allocate_node();
+
+    Node& parent = nodes[new_parent];
+    parent.parent = old_parent;
+    parent.left = sibling;
+    parent.right = leaf;
+    parent.bounds = merge(nodes[sibling].bounds, nodes[leaf].bounds);
+    parent.height = nodes[sibling].height + 1;
+
+    if (old_parent == null_node) {
+        root = new_parent;
+    } else if (nodes[old_parent].left == sibling) {
+        nodes[old_parent].left = new_parent;
+    } else {
+        nodes[old_parent].right = new_parent;
+    }
+
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    refit_ancestors(new_parent);
+}
+
+void BVH::remove_leaf(int32_t leaf) {
+    if (leaf == root) {
+        root = null_node;
+        return;
+    }
+
+    int32_t const parent = nodes[leaf].parent;
+    int32_t const grandparent = nodes[parent].parent;
+    int32_t const sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    // The sibling takes the place of the parent node.
+    if (grandparent == null_node) {
+        root = sibling;
+        nodes[sibling].parent = null_node;
+        free_node(parent);
+    } else {
+        if (nodes[grandparent].left == parent) {
+            nodes[grandparent].left = sibling;
+        } else {
+            nodes[grandparent].right = sibling;
+        }
+        nodes[sibling].parent = grandparent;
+        free_node(parent);
+        refit_ancestors(grandparent);
+    }
+
+    nodes[leaf].parent = null_node;
+}
+
+void BVH::refit_ancestors(int32_t index) {
+    while (index != null_node) {
+        Node& node = nodes[index];
+        node.bounds = merge(nodes[node.left].bounds, nodes[node.right].bounds);
+        node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+        rotate(index);
+        index = node.parent;
+    }
+}
+
+void BVH::rotate(int32_t index) {
+    // Tree rotations as described by Kopta et al., "Fast, Effective BVH Updates for Animated Scenes".
+    // For a node A with children B and C, we try swapping B with one of C's children, or C with one of B's children.
+    // This changes the bounds of the child whose contents changed, but not those of A.
+    // The rotation that reduces the surface area the most is applied.
+    Node& a = nodes[index];
+    int32_t const b = a.left;
+    int32_t const c = a.right;
+    if (nodes[b].is_leaf() && nodes[c].is_leaf()) { return; }
+
+    enum class Rotation {
+        None,
+        BF, BG, // Swap B with a child of C
+        CD, CE  // Swap C with a child of B
+    };
+
+    Rotation best = Rotation::None;
+    float best_diff = 0.0f;
+
+    if (!nodes[c].is_leaf()) {
+        int32_t const f = nodes[c].left;
+        int32_t const g = nodes[c].right;
+        float const area_c = nodes[c].bounds.surface_area();
+
+        float const diff_bf = merge(nodes[b].bounds, nodes[g].bounds).surface_area() - area_c;
+        if (diff_bf < best_diff) {
+            best = Rotation::BF;
+            best_diff = diff_bf;
+        }
+        float const diff_bg = merge(nodes[b].bounds, nodes[f].bounds).surface_area() - area_c;
+        if (diff_bg < best_diff) {
+            best = Rotation::BG;
+            best_diff = diff_bg;
+        }
+    }
+
+    if (!nodes[b].is_leaf()) {
+        int32_t const d = nodes[b].left;
+        int32_t const e = nodes[b].right;
+        float const area_b = nodes[b].bounds.surface_area();
+
+        float const diff_cd = merge(nodes[c].bounds, nodes[e].bounds).surface_area() - area_b;
+        if (diff_cd < best_diff) {
+            best = Rotation::CD;
+            best_diff = diff_cd;
+        }
+        float const diff_ce = merge(nodes[c].bounds, nodes[d].bounds).surface_area() - area_b;
+        if (diff_ce < best_diff) {
+            best = Rotation::CE;
+            best_diff = diff_ce;
+        }
+    }
+
+    // Swaps 'child' (a direct child of A) with 'grandchild' (a child of A's other child, 'other').
+    auto swap = [this, index](int32_t child, int32_t other, int32_t grandchild) {
+        Node& a = nodes[index];
+        Node& o = nodes[other];
+        if (a.left == child) { a.left = grandchild; }
+        else { a.right = grandchild; }
+        if (o.left == grandchild) { o.left = child; }
+        else { o.right = child; }
+        nodes[child].parent = other;
+        nodes[grandchild].parent = index;
+
+        o.bounds = merge(nodes[o.left].bounds, nodes[o.right].bounds);
+        o.height = 1 + std::max(nodes[o.left].height, nodes[o.right].height);
+        a.height = 1 + std::max(nodes[a.left].height, nodes[a.right].height);
+    };
+
+    switch (best) {
+        case Rotation::None:
+            break;
+        case Rotation::BF:
+            swap(b, c, nodes[c].left);
+            break;
+        case Rotation::BG:
+            swap(b, c, nodes[c].right);
+            break;
+        case Rotation::CD:
+            swap(c, b, nodes[b].left);
+            break;
+        case Rotation::CE:
+            swap(c, b, nodes[b].right);
+            break;
+    }
+}
+
+} // namespace andromeda::math
@@ -2,6 +2,7 @@
 
 #include <andromeda/components/transform.hpp>
 #include <andromeda/components/hierarchy.hpp>
+#include <andromeda/components/world_transform.hpp>
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
@@ -42,17 +43,34 @@ glm::mat4 local_to_world(ecs::entity_t ent, thread::LockedValue<ecs::registry co
     // Now that we have the parent to world matrix (or an identity matrix if this entity has no parent),
     // we simply apply this entity's transformation.
     auto const& transform = ecs->get_component<Transform>(ent);
-    glm::mat4 local_transform = glm::translate(glm::mat4(1.0), transform.position);
-    local_transform = glm::rotate(local_transform, glm::radians(transform.rotation));
-    local_transform = glm::scale(local_transform, transform.scale);
-
-    glm::mat4 local_to_world = parent_transform * local_transform;
+    glm::mat4 local_to_world = parent_transform * local_transform(transform);
     // Store the transform in the lookup table.
     lookup[ent] = local_to_world;
 
     return local_to_world;
 }
 
+glm::mat4 local_transform(Transform const& transform) {
+    glm::mat4 local = glm::translate(glm::mat4(1.0), transform.position);
+    local = glm::rotate(local, glm::radians(transform.rotation));
+    local = glm::scale(local, transform.scale);
+    return local;
+}
+
+void propagate_transforms(ecs::registry& ecs, ecs::entity_t root, glm::mat4 const& parent_transform) {
+    // Walking the hierarchy top-down means every parent transform is computed exactly once, and we don't need
+    // a lookup table like local_to_world() does.
+    auto const& hierarchy = ecs.get_component<Hierarchy>(root);
+    glm::mat4 local_to_world = parent_transform * local_transform(ecs.get_component<Transform>(root));
+    if (ecs.has_component<WorldTransform>(root)) {
+        ecs.get_component<WorldTransform>(root).local_to_world = local_to_world;
+    }
+
+    for (ecs::entity_t child: hierarchy.children) {
+        propagate_transforms(ecs, child, local_to_world);
+    }
+}
+
 glm::vec3 euler_to_direction(glm::vec3 const& euler) {
     // We will convert the set of euler angles to a direction vector by rotating
     // the forward vector (0, 0, -1) around these angles.
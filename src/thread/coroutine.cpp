@@ -0,0 +1,128 @@
+#include <andromeda/thread/coroutine.hpp>
+
+#include <andromeda/app/log.hpp>
+
+#include <exception>
+#include <utility>
+
+namespace andromeda {
+namespace thread {
+
+async_task::promise_type::~promise_type() {
+    if (state && state->completion.valid()) {
+        state->scheduler->signal_event(state->completion.id());
+    }
+}
+
+async_task async_task::promise_type::get_return_object() noexcept {
+    return async_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+}
+
+void async_task::promise_type::unhandled_exception() {
+    // Nobody is waiting on the result of the coroutine, so report the exception here. The frame is destroyed right
+    // after this, which signals the completion event.
+    try {
+        throw;
+    }
+    catch (std::exception const& e) {
+        LOG_FORMAT(LogLevel::Error, "Exception while {}: {}", state->description, e.what());
+    }
+    catch (...) {
+        LOG_FORMAT(LogLevel::Error, "Unknown exception while {}", state->description);
+    }
+}
+
+void async_task::promise_type::resume_after(dependency_list dependencies) {
+    auto coroutine = std::coroutine_handle<promise_type>::from_promise(*this);
+    task_handle resume = state->scheduler->schedule_on(state->thread, [coroutine](uint32_t) {
+        coroutine.resume();
+    }, dependencies, state->priority, state->description);
+
+    if (!resume.valid()) {
+        LOG_FORMAT(LogLevel::Error, "Could not resume coroutine while {}, it will never complete.", state->description);
+    }
+}
+
+async_task::async_task(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {
+
+}
+
+async_task::async_task(async_task&& rhs) noexcept : coroutine(std::exchange(rhs.coroutine, {})) {
+
+}
+
+async_task& async_task::operator=(async_task&& rhs) noexcept {
+    if (this != &rhs) {
+        if (coroutine) { coroutine.destroy(); }
+        coroutine = std::exchange(rhs.coroutine, {});
+    }
+    return *this;
+}
+
+async_task::~async_task() {
+    if (coroutine) {
+        coroutine.destroy();
+    }
+}
+
+void async_task::start(std::unique_ptr<coroutine_state> state, uint32_t thread_index) {
+    state->thread = thread_index;
+    coroutine.promise().state = std::move(state);
+    // The coroutine may complete and destroy itself inside resume(), so give up ownership first.
+    std::exchange(coroutine, {}).resume();
+}
+
+task_handle spawn(TaskScheduler& scheduler, coroutine_function function, std::string description, TaskPriority priority,
+                  cancellation_token token) {
+    task_handle completion = scheduler.create_event();
+    if (!completion.valid()) { return {}; }
+
+    auto state = std::make_unique<coroutine_state>(coroutine_state{
+        .scheduler = &scheduler,
+        .priority = priority,
+        .completion = completion,
+        .description = std::move(description),
+        .function = std::move(function),
+        .token = std::move(token)
+    });
+    std::string_view const name = state->description;
+
+    // The token is checked here instead of being passed to the scheduler, since a dropped task would never signal the
+    // completion event.
+    auto start_coroutine = [state = std::move(state)](uint32_t thread) mutable {
+        if (state->token.cancelled()) {
+            state->scheduler->signal_event(state->completion.id());
+            return;
+        }
+        // Destroy the function once the coroutine is created, it is not needed anymore.
+        async_task task = std::exchange(state->function, {})(thread);
+        task.start(std::move(state), thread);
+    };
+    static_assert(task_function::stored_inline<decltype(start_coroutine)>, "Starting a coroutine should not allocate a task");
+
+    task_handle start = scheduler.schedule(std::move(start_coroutine), {}, priority, name);
+    // Don't leave the event pending forever, so waiting on it does not deadlock.
+    if (!start.valid()) {
+        scheduler.signal_event(completion.id());
+    }
+    return completion;
+}
+
+task_awaiter::task_awaiter(task_handle task) : task(task) {
+
+}
+
+bool task_awaiter::await_ready() const {
+    return task.done();
+}
+
+void task_awaiter::await_suspend(std::coroutine_handle<async_task::promise_type> coroutine) const {
+    coroutine.promise().resume_after({task.id()});
+}
+
+task_awaiter operator co_await(task_handle task) {
+    return task_awaiter{task};
+}
+
+} // namespace thread
+} // namespace andromeda
@@ -0,0 +1,479 @@
+#include <andromeda/thread/io_service.hpp>
+
+#include <andromeda/app/log.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#if ANDROMEDA_IO_URING
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace andromeda {
+namespace thread {
+
+class IOService::Backend {
+public:
+    virtual ~Backend() = default;
+    virtual void read_file(std::string path, read_callback on_complete) = 0;
+    virtual char const* name() const = 0;
+};
+
+namespace {
+
+/**
+ * @brief Reads every file with a blocking task on the scheduler's I/O threads.
+ */
+class ThreadPoolBackend : public IOService::Backend {
+public:
+    explicit ThreadPoolBackend(TaskScheduler& scheduler) : scheduler(scheduler) {}
+
+    void read_file(std::string path, IOService::read_callback on_complete) override {
+        // The callback is moved into the task, so we can't call it anymore if scheduling fails.
+        task_handle task = scheduler.schedule_io([path, on_complete = std::move(on_complete)](uint32_t) mutable {
+            on_complete(read_blocking(path));
+        }, {}, path);
+        if (!task.valid()) {
+            LOG_FORMAT(LogLevel::Error, "Could not schedule read of file {}", path);
+        }
+    }
+
+    char const* name() const override {
+        return "thread pool";
+    }
+
+private:
+    TaskScheduler& scheduler;
+
+    static FileContents read_blocking(std::string const& path) {
+        FileContents result{};
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) { return result; }
+
+        std::fseek(file, 0, SEEK_END);
+        long const size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        if (size >= 0) {
+            result.data.resize(static_cast<std::size_t>(size));
+            result.success = std::fread(result.data.data(), 1, result.data.size(), file) == result.data.size();
+        }
+        std::fclose(file);
+        return result;
+    }
+};
+
+#if ANDROMEDA_IO_URING
+
+/**
+ * @brief Submits all reads to an io_uring instance. A single thread owns the ring: it opens files, splits them into
+ *        chunks, keeps the submission queue filled and processes completions. New requests wake it up through an
+ *        eventfd that is read through the ring itself, so the thread only ever blocks inside io_uring_enter().
+ */
+class IOUringBackend : public IOService::Backend {
+public:
+    // Maximum amount of operations in flight.
+    static constexpr uint32_t queue_depth = 128;
+    // Files are read in chunks of this size, so large files are read with multiple requests in parallel.
+    static constexpr std::size_t chunk_size = 512 * 1024; // 512 KiB
+
+    IOUringBackend() = default;
+
+    ~IOUringBackend() override {
+        if (thread.joinable()) {
+            {
+                std::lock_guard lock{mutex};
+                stop = true;
+            }
+            wake();
+            thread.join();
+        }
+        // Requests that never started are dropped without calling their callbacks.
+        for (Request* request: incoming) {
+            delete request;
+        }
+        if (sqes != nullptr) { munmap(sqes, sqes_size); }
+        if (cq_memory != nullptr && cq_memory != sq_memory) { munmap(cq_memory, cq_size); }
+        if (sq_memory != nullptr) { munmap(sq_memory, sq_size); }
+        if (ring_fd >= 0) { close(ring_fd); }
+        if (wake_fd >= 0) { close(wake_fd); }
+    }
+
+    /**
+     * @brief Create the ring and start the I/O thread.
+     * @return false if io_uring is not available, for example because the kernel is too old or it is disabled.
+     */
+    bool init() {
+        io_uring_params params{};
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+        if (ring_fd < 0) { return false; }
+        // We rely on the kernel copying SQEs on submission, so we can reuse them right away.
+        if (!(params.features & IORING_FEAT_SUBMIT_STABLE)) { return false; }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool const single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_size = cq_size = std::max(sq_size, cq_size);
+        }
+
+        sq_memory = map(sq_size, IORING_OFF_SQ_RING);
+        if (sq_memory == nullptr) { return false; }
+        cq_memory = single_mmap ? sq_memory : map(cq_size, IORING_OFF_CQ_RING);
+        if (cq_memory == nullptr) { return false; }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+        if (sqes == nullptr) { return false; }
+
+        auto* sq = static_cast<std::byte*>(sq_memory);
+        sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<std::byte*>(cq_memory);
+        cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (wake_fd < 0) { return false; }
+
+        thread = std::thread{[this]() { run(); }};
+        return true;
+    }
+
+    void read_file(std::string path, IOService::read_callback on_complete) override {
+        auto* request = new Request{};
+        request->path = std::move(path);
+        request->on_complete = std::move(on_complete);
+        {
+            std::lock_guard lock{mutex};
+            incoming.push_back(request);
+        }
+        wake();
+    }
+
+    char const* name() const override {
+        return "io_uring";
+    }
+
+private:
+    struct Request;
+
+    struct Operation {
+        enum class Type {
+            Wake,
+            Open,
+            Read
+        };
+
+        Type type = Type::Wake;
+        Request* request = nullptr;
+        // Part of the file to read, for read operations.
+        std::size_t offset = 0;
+        std::size_t length = 0;
+    };
+
+    struct Request {
+        std::string path;
+        IOService::read_callback on_complete;
+        int fd = -1;
+        FileContents contents{};
+        // Operations that were not completed yet, both in flight and waiting for room in the ring.
+        uint32_t outstanding = 0;
+        bool failed = false;
+        Operation open{.type = Operation::Type::Open};
+        std::vector<Operation> chunks;
+    };
+
+    int ring_fd = -1;
+    int wake_fd = -1;
+    void* sq_memory = nullptr;
+    void* cq_memory = nullptr;
+    std::size_t sq_size = 0;
+    std::size_t cq_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqes_size = 0;
+
+    uint32_t* sq_head = nullptr;
+    uint32_t* sq_tail = nullptr;
+    uint32_t* sq_array = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t sq_entries = 0;
+    uint32_t* cq_head = nullptr;
+    uint32_t* cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    // Requests waiting to be picked up by the I/O thread.
+    std::vector<Request*> incoming;
+    bool stop = false;
+    std::mutex mutex;
+
+    // The fields below are only accessed by the I/O thread.
+    std::thread thread;
+    // Operations waiting for room in the ring.
+    std::deque<Operation*> backlog;
+    uint32_t in_flight = 0;
+    // Amount of SQEs added since the last io_uring_enter() call.
+    uint32_t unsubmitted = 0;
+    Operation wake_operation{};
+    uint64_t wake_value = 0;
+    // Requests that were picked up and did not complete yet.
+    uint32_t active = 0;
+
+    void* map(std::size_t size, off_t offset) const {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    void wake() {
+        uint64_t const value = 1;
+        // Only fails if the counter would overflow, in which case the thread is woken up anyway.
+        [[maybe_unused]] ssize_t result = write(wake_fd, &value, sizeof(value));
+    }
+
+    io_uring_sqe* get_sqe() {
+        uint32_t const tail = *sq_tail;
+        uint32_t const head = std::atomic_ref<uint32_t>{*sq_head}.load(std::memory_order_acquire);
+        if (tail - head >= sq_entries) { return nullptr; }
+
+        uint32_t const index = tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sq_array[index] = index;
+        std::atomic_ref<uint32_t>{*sq_tail}.store(tail + 1, std::memory_order_release);
+        ++unsubmitted;
+        return sqe;
+    }
+
+    // Add an operation to the ring. Returns false if there is no room.
+    bool push(Operation* operation) {
+        // Keep one slot free for the wake operation, and never have more operations in flight than fit in the CQ ring.
+        if (operation->type != Operation::Type::Wake && in_flight + 1 >= queue_depth) { return false; }
+        io_uring_sqe* sqe = get_sqe();
+        if (sqe == nullptr) { return false; }
+
+        switch (operation->type) {
+            case Operation::Type::Wake:
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = wake_fd;
+                sqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+                sqe->len = sizeof(wake_value);
+                break;
+            case Operation::Type::Open:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(operation->request->path.c_str());
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                break;
+            case Operation::Type::Read:
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = operation->request->fd;
+                sqe->addr = reinterpret_cast<uint64_t>(operation->request->contents.data.data() + operation->offset);
+                sqe->len = static_cast<uint32_t>(operation->length);
+                sqe->off = operation->offset;
+                break;
+        }
+        sqe->user_data = reinterpret_cast<uint64_t>(operation);
+        ++in_flight;
+        return true;
+    }
+
+    void queue(Operation* operation) {
+        if (backlog.empty() && push(operation)) { return; }
+        backlog.push_back(operation);
+    }
+
+    void run() {
+        push(&wake_operation);
+        while (true) {
+            std::vector<Request*> requests;
+            bool stopping = false;
+            {
+                std::lock_guard lock{mutex};
+                requests.swap(incoming);
+                stopping = stop;
+            }
+            // Wait for reads that are in flight, since the kernel is still writing into their buffers.
+            if (stopping && active == 0) { break; }
+            if (!stopping) {
+                for (Request* request: requests) {
+                    ++active;
+                    request->open.request = request;
+                    request->outstanding = 1;
+                    queue(&request->open);
+                }
+            } else {
+                for (Request* request: requests) { delete request; }
+            }
+
+            while (!backlog.empty() && push(backlog.front())) {
+                backlog.pop_front();
+            }
+
+            long const result = syscall(__NR_io_uring_enter, ring_fd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result >= 0) {
+                unsubmitted -= static_cast<uint32_t>(result);
+            } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                LOG_FORMAT(LogLevel::Error, "io_uring_enter failed: {}", std::strerror(errno));
+                break;
+            }
+            reap();
+        }
+    }
+
+    void reap() {
+        uint32_t head = *cq_head;
+        uint32_t const tail = std::atomic_ref<uint32_t>{*cq_tail}.load(std::memory_order_acquire);
+        while (head != tail) {
+            io_uring_cqe const& cqe = cqes[head & cq_mask];
+            auto* operation = reinterpret_cast<Operation*>(cqe.user_data);
+            int const result = cqe.res;
+            ++head;
+            // Free the CQE right away, completing an operation may submit new ones.
+            std::atomic_ref<uint32_t>{*cq_head}.store(head, std::memory_order_release);
+            --in_flight;
+            complete(operation, result);
+        }
+    }
+
+    void complete(Operation* operation, int result) {
+        if (operation->type == Operation::Type::Wake) {
+            queue(&wake_operation);
+            return;
+        }
+
+        Request* request = operation->request;
+        if (result == -EINTR || result == -EAGAIN) {
+            queue(operation);
+            return;
+        }
+
+        if (operation->type == Operation::Type::Open) {
+            if (result < 0) {
+                request->failed = true;
+            } else {
+                request->fd = result;
+                start_reads(request);
+            }
+        } else if (result <= 0) {
+            // Reading past the end of the file means it was truncated while we were reading it.
+            request->failed = true;
+        } else if (static_cast<std::size_t>(result) < operation->length) {
+            // Short read, read the rest of the chunk.
+            operation->offset += result;
+            operation->length -= result;
+            queue(operation);
+            return;
+        }
+
+        if (--request->outstanding == 0) {
+            finish(request);
+        }
+    }
+
+    void start_reads(Request* request) {
+        struct stat info{};
+        if (fstat(request->fd, &info) != 0) {
+            request->failed = true;
+            return;
+        }
+
+        std::size_t const size = static_cast<std::size_t>(info.st_size);
+        request->contents.data.resize(size);
+        request->chunks.resize((size + chunk_size - 1) / chunk_size);
+        for (std::size_t i = 0; i < request->chunks.size(); ++i) {
+            Operation& chunk = request->chunks[i];
+            chunk.type = Operation::Type::Read;
+            chunk.request = request;
+            chunk.offset = i * chunk_size;
+            chunk.length = std::min(chunk_size, size - chunk.offset);
+        }
+        // Don't let the open operation complete the request before its chunks were queued.
+        request->outstanding += static_cast<uint32_t>(request->chunks.size());
+        for (Operation& chunk: request->chunks) {
+            queue(&chunk);
+        }
+    }
+
+    void finish(Request* request) {
+        if (request->fd >= 0) { close(request->fd); }
+        request->contents.success = !request->failed;
+        --active;
+
+        bool stopping = false;
+        {
+            std::lock_guard lock{mutex};
+            stopping = stop;
+        }
+        if (!stopping) {
+            request->on_complete(std::move(request->contents));
+        }
+        delete request;
+    }
+};
+
+#endif
+
+} // namespace
+
+IOService::Awaiter::Awaiter(IOService& service, std::string path) : service(service), path(std::move(path)) {
+
+}
+
+void IOService::Awaiter::await_suspend(std::coroutine_handle<async_task::promise_type> coroutine) {
+    // The awaiter lives in the coroutine frame until the coroutine resumes, so the callback can store the result in it.
+    service.read_file(std::move(path), [this, coroutine](FileContents result) mutable {
+        contents = std::move(result);
+        coroutine.promise().resume_after();
+    });
+}
+
+IOService::IOService(TaskScheduler& scheduler) {
+#if ANDROMEDA_IO_URING
+    auto uring = std::make_unique<IOUringBackend>();
+    if (uring->init()) {
+        backend = std::move(uring);
+    } else {
+        LOG_WRITE(LogLevel::Warning, "io_uring is not available, falling back to blocking reads on I/O threads.");
+    }
+#endif
+    if (backend == nullptr) {
+        backend = std::make_unique<ThreadPoolBackend>(scheduler);
+    }
+}
+
+IOService::~IOService() = default;
+
+void IOService::read_file(std::string path, read_callback on_complete) {
+    backend->read_file(std::move(path), std::move(on_complete));
+}
+
+IOService::Awaiter IOService::read(std::string path) {
+    return Awaiter{*this, std::move(path)};
+}
+
+char const* IOService::backend_name() const {
+    return backend->name();
+}
+
+} // namespace thread
+} // namespace andromeda
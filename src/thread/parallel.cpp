@@ -0,0 +1,58 @@
+#include <andromeda/thread/parallel.hpp>
+
+#include <atomic>
+
+namespace andromeda {
+namespace thread {
+
+// Amount of chunks per thread created with the default grain size.
+static constexpr std::size_t chunks_per_thread = 4;
+
+std::size_t default_grain_size(TaskScheduler const& scheduler, std::size_t count) {
+    // The calling thread also processes chunks, so count it as an extra thread.
+    std::size_t const chunks = chunks_per_thread * (scheduler.thread_count() + 1);
+    return std::max<std::size_t>((count + chunks - 1) / chunks, 1);
+}
+
+void parallel_for(TaskScheduler& scheduler, std::size_t count, std::size_t grain, range_function const& function) {
+    if (count == 0) { return; }
+    if (grain == 0) {
+        grain = default_grain_size(scheduler, count);
+    }
+
+    std::size_t const chunks = (count + grain - 1) / grain;
+    if (chunks == 1) {
+        function(0, count);
+        return;
+    }
+
+    // Chunks are handed out one at a time, so threads that are busy with other work simply process fewer chunks.
+    std::atomic<std::size_t> next_chunk = 0;
+    auto process = [&next_chunk, chunks, grain, count, &function]() {
+        for (std::size_t chunk = next_chunk.fetch_add(1); chunk < chunks; chunk = next_chunk.fetch_add(1)) {
+            std::size_t const begin = chunk * grain;
+            function(begin, std::min(begin + grain, count));
+        }
+    };
+
+    // The calling thread processes chunks as well, so we need one helper task less than there are chunks.
+    std::size_t const helpers = std::min<std::size_t>(chunks - 1, scheduler.thread_count());
+    std::vector<task_handle> tasks{};
+    tasks.reserve(helpers);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        // The caller is blocked until the loop is done, so don't let helpers queue behind background work.
+        tasks.push_back(scheduler.schedule([&process](uint32_t thread) {
+            process();
+        }, {}, TaskPriority::FrameCritical));
+    }
+
+    process();
+    // Helpers reference variables on this stack frame, so they must have completed before we return. When they
+    // were not started yet, they find no chunks left and return immediately.
+    for (task_handle const& task: tasks) {
+        task.wait();
+    }
+}
+
+} // namespace thread
+} // namespace andromeda
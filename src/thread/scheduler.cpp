@@ -1,66 +1,119 @@
 #include <andromeda/thread/scheduler.hpp>
 
-#include <andromeda/util/idgen.hpp>
 #include <andromeda/app/log.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
 namespace andromeda {
 namespace thread {
 
-TaskScheduler::TaskScheduler(uint32_t num_threads) {
-    // This function will continuously run on every thread, waiting to accept tasks.
-    auto thread_loop_function = [this](uint32_t thread_index) {
-        while (true) {
-            Task job{};
-            {
-                // Acquire the mutex
-                std::unique_lock lock{task_mutex};
-                // Wait until there is a task available or until the thread pool should be stopped.
-                cv.wait(lock, [this]() {
-                    return !pending_tasks.empty() || terminate;
-                });
-
-                // If the terminate flag is set and there is no new task, break out of the loop
-                if (pending_tasks.empty() && terminate) { break; }
-
-                // Find the first task that has all its dependencies completed and execute it.
-                for (auto it = pending_tasks.begin(); it != pending_tasks.end(); ++it) {
-                    bool dependencies_complete = true;
-                    for (task_id dep: it->dependencies) {
-                        if (is_running(dep, lock) || is_pending(dep, lock)) {
-                            dependencies_complete = false;
-                            break;
-                        }
-                    }
-                    if (dependencies_complete) {
-                        job = std::move(*it);
-                        pending_tasks.erase(it);
-                        running_tasks.push_back(job);
-                        break;
-                    }
-                }
-            }
+// Set on worker threads, so schedule() can push to the calling worker's own queue.
+static thread_local TaskScheduler* current_scheduler = nullptr;
+static thread_local uint32_t current_worker = 0;
+
+// Amount of times an idle worker looks for work before going to sleep.
+static constexpr uint32_t idle_spin_count = 64;
+// Maximum amount of timeline events recorded per thread, so forgetting to end a trace does not eat all memory.
+static constexpr std::size_t max_trace_events = 1 << 18;
+
+static uint32_t slot_index(task_id task) {
+    return static_cast<uint32_t>(task & 0xFFFFFFFF);
+}
+
+static uint32_t generation(task_id task) {
+    return static_cast<uint32_t>(task >> 32);
+}
 
-            // Run the task (if one was found)
-            if (job.function) {
-                job.function(thread_index);
-                // Remove this task from the running task list
-                {
-                    std::unique_lock lock{task_mutex};
-                    running_tasks.erase(std::remove_if(running_tasks.begin(), running_tasks.end(),
-                                                       [&job](Task const& t) {
-                                                           return job.id == t.id;
-                                                       }), running_tasks.end());
+static task_id make_task_id(uint32_t slot, uint32_t generation) {
+    return (static_cast<task_id>(generation) << 32) | slot;
+}
+
+static uint64_t to_ns(std::chrono::steady_clock::duration duration) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+static double to_us(std::chrono::nanoseconds duration) {
+    return static_cast<double>(duration.count()) / 1000.0;
+}
+
+static std::string escape_json(std::string_view str) {
+    std::string result{};
+    result.reserve(str.size());
+    for (char c: str) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += fmt::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    result += c;
                 }
-                // Since the task is complete we want to wake up all threads, because this task might be
-                // a dependency to a bunch of other tasks.
-                cv.notify_all();
-            }
         }
-    };
+    }
+    return result;
+}
+
+task_handle::task_handle(TaskScheduler* scheduler, task_id id) : scheduler(scheduler), task(id) {
+
+}
+
+task_id task_handle::id() const {
+    return task;
+}
+
+bool task_handle::valid() const {
+    return scheduler != nullptr;
+}
+
+bool task_handle::done() const {
+    if (!valid()) { return true; }
+    return scheduler->is_complete(task);
+}
+
+void task_handle::wait() const {
+    if (!valid()) { return; }
+    scheduler->wait(task);
+}
+
+task_handle task_handle::then(task_function function, TaskPriority priority) const {
+    if (!valid()) { return {}; }
+    return scheduler->schedule(std::move(function), {task}, priority);
+}
+
+task_handle::operator task_id() const {
+    return task;
+}
 
-    threads.reserve(num_threads);
+TaskScheduler::TaskScheduler(uint32_t num_threads, uint32_t num_io_threads) {
+    // Workers, the main thread and the I/O threads.
+    thread_stats.reserve(num_threads + 1 + num_io_threads);
+    for (uint32_t i = 0; i < num_threads + 1 + num_io_threads; ++i) {
+        thread_stats.push_back(std::make_unique<ThreadStats>());
+    }
+    stats_start.store(clock::now().time_since_epoch().count());
+
+    workers.reserve(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        // Any non-zero seed works for the xorshift generator.
+        workers.back()->random_state = i + 1;
+    }
+
+    // Only start the threads once all workers exist, since they may immediately try to steal from each other.
     for (uint32_t i = 0; i < num_threads; ++i) {
-        threads.push_back(std::thread{thread_loop_function, i});
+        workers[i]->thread = std::thread{[this, i]() { worker_loop(i); }};
+    }
+
+    io_threads.reserve(num_io_threads);
+    for (uint32_t i = 0; i < num_io_threads; ++i) {
+        // Index 0 after the workers is the main thread.
+        uint32_t const thread_index = num_threads + 1 + i;
+        io_threads.emplace_back([this, thread_index]() { io_loop(thread_index); });
     }
 }
 
@@ -68,72 +121,789 @@ TaskScheduler::~TaskScheduler() {
     if (!stopped) {
         shutdown();
     }
+
+    for (auto& chunk: chunks) {
+        delete[] chunk.load();
+    }
+}
+
+task_handle TaskScheduler::schedule(task_function function, dependency_list dependencies, TaskPriority priority,
+                                    std::string_view name, cancellation_token token) {
+    return schedule_task(std::move(function), dependencies, any_thread, priority, name, std::move(token));
+}
+
+task_handle TaskScheduler::schedule_on(uint32_t thread_index, task_function function, dependency_list dependencies,
+                                       TaskPriority priority, std::string_view name, cancellation_token token) {
+    if (thread_index >= thread_count()) {
+        LOG_FORMAT(LogLevel::Error, "Tried to schedule a task on thread {}, but there are only {} threads.", thread_index, thread_count());
+        return {};
+    }
+    return schedule_task(std::move(function), dependencies, thread_index, priority, name, std::move(token));
+}
+
+task_handle TaskScheduler::schedule_io(task_function function, dependency_list dependencies, std::string_view name,
+                                       cancellation_token token) {
+    if (io_threads.empty()) {
+        return schedule_task(std::move(function), dependencies, any_thread, TaskPriority::Background, name, std::move(token));
+    }
+    return schedule_task(std::move(function), dependencies, io_thread, TaskPriority::Background, name, std::move(token));
+}
+
+task_handle TaskScheduler::schedule_main(task_function function, dependency_list dependencies, TaskPriority priority,
+                                         std::string_view name, cancellation_token token) {
+    return schedule_task(std::move(function), dependencies, main_thread, priority, name, std::move(token));
+}
+
+task_handle TaskScheduler::schedule_main_job(main_job_function job, dependency_list dependencies, TaskPriority priority,
+                                             std::string_view name, cancellation_token token) {
+    task_handle completion = create_event();
+    if (!completion.valid()) { return {}; }
+
+    auto state = std::make_unique<MainJob>(MainJob{
+        .function = std::move(job),
+        .completion = completion,
+        .priority = priority,
+        .name = std::string{name},
+        .token = std::move(token)
+    });
+    task_handle first = schedule_main([this, state = std::move(state)](uint32_t) mutable {
+        run_main_job(std::move(state));
+    }, dependencies, priority, name);
+    // Don't leave the event pending forever, so waiting on it does not deadlock.
+    if (!first.valid()) {
+        signal_event(completion.id());
+        return {};
+    }
+    return completion;
+}
+
+void TaskScheduler::run_main_job(std::unique_ptr<MainJob> job) {
+    // The steps of a job are not scheduled with its token, since dropping one would leave the job's completion event
+    // pending forever. A cancelled job completes at its next step instead.
+    if (job->token.cancelled() || job->function(main_deadline) == JobStatus::Done) {
+        signal_event(job->completion.id());
+        return;
+    }
+
+    task_id const completion = job->completion.id();
+    TaskPriority const priority = job->priority;
+    std::string_view const name = job->name;
+    // The next step is scheduled while this one is still running, so it won't run again until the next call to
+    // run_main_thread_tasks().
+    task_handle next = schedule_main([this, job = std::move(job)](uint32_t) mutable {
+        run_main_job(std::move(job));
+    }, {}, priority, name);
+    if (!next.valid()) {
+        LOG_WRITE(LogLevel::Error, "Could not resume main thread job, it will never complete.");
+        signal_event(completion);
+    }
+}
+
+uint32_t TaskScheduler::run_main_thread_tasks(std::chrono::microseconds budget) {
+    clock::time_point const start = clock::now();
+    main_deadline = budget >= std::chrono::duration_cast<std::chrono::microseconds>(clock::time_point::max() - start)
+                    ? clock::time_point::max()
+                    : start + budget;
+
+    // Only run the tasks that are ready now. Tasks that become ready while we are running are picked up next time,
+    // so a task scheduling more main thread work can't keep us here forever.
+    std::array<std::deque<uint32_t>, priority_count> ready{};
+    {
+        std::lock_guard lock{main_mutex};
+        ready.swap(main_queues);
+    }
+
+    uint32_t count = 0;
+    uint32_t budgeted_count = 0;
+    for (uint32_t priority = 0; priority < priority_count; ++priority) {
+        bool const budgeted = priority != static_cast<uint32_t>(TaskPriority::FrameCritical);
+        std::deque<uint32_t>& queue = ready[priority];
+        while (!queue.empty()) {
+            if (budgeted && budgeted_count != 0 && clock::now() >= main_deadline) { break; }
+
+            uint32_t const slot = queue.front();
+            queue.pop_front();
+            run_task(slot, main_thread_index());
+            ++count;
+            if (budgeted) { ++budgeted_count; }
+        }
+    }
+
+    // Put back the tasks we did not get to, in front of anything that was queued in the meantime.
+    {
+        std::lock_guard lock{main_mutex};
+        for (uint32_t priority = 0; priority < priority_count; ++priority) {
+            std::deque<uint32_t>& queue = main_queues[priority];
+            queue.insert(queue.begin(), ready[priority].begin(), ready[priority].end());
+        }
+    }
+    main_deadline = clock::time_point::max();
+    return count;
+}
+
+task_handle TaskScheduler::create_event() {
+    // An event is an empty task with one extra dependency, which is removed by signal_event(). Whatever depends on
+    // the event should not have to wait for it to get picked up, so it gets the highest priority.
+    return schedule_task([](uint32_t) {}, {}, any_thread, TaskPriority::FrameCritical, "event", {}, 1);
+}
+
+void TaskScheduler::signal_event(task_id event) {
+    Task* task = lookup(event);
+    if (task == nullptr || task->generation.load() != generation(event)) {
+        LOG_WRITE(LogLevel::Error, "Tried to signal an event that does not exist.");
+        return;
+    }
+
+    if (task->remaining_dependencies.fetch_sub(1) == 1) {
+        enqueue(slot_index(event));
+    }
 }
 
-task_id TaskScheduler::schedule(task_function function, std::vector<task_id> dependencies) {
+task_handle TaskScheduler::schedule_task(task_function function, dependency_list dependencies, uint32_t affinity,
+                                         TaskPriority priority, std::string_view name, cancellation_token token,
+                                         uint32_t external_dependencies) {
     if (stopped) {
         LOG_WRITE(LogLevel::Error, "Tried to schedule a task but scheduler is stopped.");
-        return -1;
+        return {};
     }
 
-    task_id id = IDGen<Task, task_id>::next();
-    {
-        // Acquire lock and schedule the task
-        std::unique_lock lock{task_mutex};
-        pending_tasks.push_back(Task{
-            .id = id,
-            .function = std::move(function),
-            .dependencies = std::move(dependencies)
-        });
-        // Notify a single thread that a new task is availble
-        cv.notify_one();
+    uint32_t const slot = allocate_slot();
+    if (slot == no_slot) {
+        LOG_WRITE(LogLevel::Error, "Tried to schedule a task but the scheduler is out of task slots.");
+        return {};
+    }
+
+    Task& task = get_task(slot);
+    task_id const id = make_task_id(slot, task.generation.load());
+    task.function = std::move(function);
+    task.token = std::move(token);
+    task.affinity = affinity;
+    task.priority = priority;
+    if (tracing.load(std::memory_order_relaxed)) {
+        task.name.assign(name.empty() ? std::string_view{"task"} : name);
+    } else {
+        task.name.clear();
+    }
+    // Start with one extra dependency so the task can't be queued before all dependencies are registered.
+    task.remaining_dependencies.store(1 + external_dependencies);
+    task.state.store(TaskState::Pending);
+    outstanding.fetch_add(1);
+
+    for (task_id dependency: dependencies) {
+        Task* dep = lookup(dependency);
+        if (dep == nullptr) { continue; }
+
+        // The dependency's mutex orders this against its completion, so either we register ourselves as a dependent
+        // before it completes, or we see that its generation changed and don't have to wait for it.
+        std::lock_guard lock{dep->mutex};
+        if (dep->generation.load() == generation(dependency) && dep->state.load() != TaskState::Free) {
+            dep->dependents.push_back(slot);
+            task.remaining_dependencies.fetch_add(1);
+        }
+    }
+
+    if (task.remaining_dependencies.fetch_sub(1) == 1) {
+        enqueue(slot);
+    }
+    return task_handle{this, id};
+}
+
+task_handle TaskScheduler::when_all(std::vector<task_handle> const& tasks) {
+    // Most calls only combine a few tasks, so only go to the heap for long lists.
+    std::array<task_id, 16> local_ids{};
+    std::vector<task_id> heap_ids{};
+    task_id* ids = local_ids.data();
+    if (tasks.size() > local_ids.size()) {
+        heap_ids.resize(tasks.size());
+        ids = heap_ids.data();
+    }
+
+    std::size_t count = 0;
+    for (task_handle const& task: tasks) {
+        if (task.valid()) { ids[count++] = task.id(); }
     }
-    return id;
+    // An empty task that is only queued once all dependencies are complete. Since it is empty, running it first
+    // costs nothing and lets whoever waits on it continue sooner.
+    return schedule([](uint32_t) {}, std::span<task_id const>(ids, count), TaskPriority::FrameCritical, "when_all");
 }
 
 bool TaskScheduler::is_running(task_id task) {
-    std::unique_lock lock{task_mutex};
-    return is_running(task, lock);
+    return has_state(task, TaskState::Running);
 }
 
 bool TaskScheduler::is_pending(task_id task) {
-    std::unique_lock lock{task_mutex};
-    return is_pending(task, lock);
+    return has_state(task, TaskState::Pending);
+}
+
+bool TaskScheduler::is_complete(task_id task) {
+    Task* slot = lookup(task);
+    if (slot == nullptr) { return true; }
+    // The generation of a slot changes when its task completes.
+    return slot->generation.load() != generation(task);
+}
+
+void TaskScheduler::wait(task_id task) {
+    if (is_complete(task)) { return; }
+
+    // Pairs with the fence in run_task(). Either the completing thread sees that we are waiting and notifies us,
+    // or we see that the task is complete in the wait predicate.
+    waiting.fetch_add(1);
+    if (current_scheduler == this) {
+        // Worker threads keep running other tasks, the task we are waiting for might even be in our own queue.
+        uint32_t const thread_index = current_worker;
+        while (!is_complete(task)) {
+            uint32_t const slot = find_task(thread_index);
+            if (slot != no_slot) {
+                run_task(slot, thread_index);
+                continue;
+            }
+
+            // Nothing to run, so sleep like an idle worker until new work shows up or the task completes.
+            clock::time_point const idle_start = begin_idle(thread_index);
+            std::unique_lock lock{sleep_mutex};
+            sleeping.fetch_add(1);
+            // Pairs with the fence in wake_one(), same as in worker_loop().
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            sleep_cv.wait(lock, [this, task, thread_index]() {
+                return has_work(thread_index) || is_complete(task);
+            });
+            sleeping.fetch_sub(1);
+            lock.unlock();
+            end_idle(thread_index, idle_start);
+        }
+    } else {
+        // Other threads can't run tasks, since the thread index passed to a task identifies per-thread resources
+        // owned by a worker.
+        std::unique_lock lock{wait_mutex};
+        wait_cv.wait(lock, [this, task]() {
+            return is_complete(task);
+        });
+    }
+    waiting.fetch_sub(1);
+}
+
+uint32_t TaskScheduler::thread_count() const {
+    return static_cast<uint32_t>(workers.size());
+}
+
+uint32_t TaskScheduler::main_thread_index() const {
+    return thread_count();
+}
+
+SchedulerStats TaskScheduler::stats() const {
+    SchedulerStats result{};
+    clock::time_point const now = clock::now();
+    clock::time_point const begin{clock::duration{stats_start.load()}};
+    result.elapsed = now - begin;
+    result.queued = queued.load();
+    result.outstanding = outstanding.load();
+
+    uint64_t total_tasks = 0;
+    result.threads.reserve(thread_stats.size());
+    for (uint32_t i = 0; i < thread_stats.size(); ++i) {
+        ThreadStats const& stats = *thread_stats[i];
+        std::string name{};
+        if (i < thread_count()) {
+            name = fmt::format("worker {}", i);
+        } else if (i == main_thread_index()) {
+            name = "main";
+        } else {
+            name = fmt::format("io {}", i - main_thread_index() - 1);
+        }
+
+        uint64_t const tasks = stats.tasks.load(std::memory_order_relaxed);
+        total_tasks += tasks;
+        uint64_t idle = stats.idle_ns.load(std::memory_order_relaxed);
+        // Include the idle period the thread is in right now, or a sleeping thread would look fully busy.
+        if (clock::rep const since = stats.idle_since.load(std::memory_order_relaxed); since != 0) {
+            clock::time_point const idle_start{clock::duration{since}};
+            // The idle period may have started before the stats were reset.
+            idle += to_ns(now - std::max(idle_start, begin));
+        }
+        result.threads.push_back(SchedulerStats::Thread{
+            .name = std::move(name),
+            .tasks = tasks,
+            .busy = std::chrono::nanoseconds{stats.busy_ns.load(std::memory_order_relaxed)},
+            .idle = std::chrono::nanoseconds{idle}
+        });
+    }
+
+    if (total_tasks != 0) {
+        result.average_latency = std::chrono::nanoseconds{latency_total_ns.load(std::memory_order_relaxed) / total_tasks};
+    }
+    result.max_latency = std::chrono::nanoseconds{latency_max_ns.load(std::memory_order_relaxed)};
+    result.cancelled = cancelled.load(std::memory_order_relaxed);
+    return result;
+}
+
+uint32_t TaskScheduler::queue_depth() const {
+    return queued.load(std::memory_order_relaxed);
+}
+
+void TaskScheduler::reset_stats() {
+    for (auto& stats: thread_stats) {
+        stats->tasks.store(0, std::memory_order_relaxed);
+        stats->busy_ns.store(0, std::memory_order_relaxed);
+        stats->idle_ns.store(0, std::memory_order_relaxed);
+    }
+    latency_total_ns.store(0, std::memory_order_relaxed);
+    latency_max_ns.store(0, std::memory_order_relaxed);
+    cancelled.store(0, std::memory_order_relaxed);
+    stats_start.store(clock::now().time_since_epoch().count());
+}
+
+void TaskScheduler::begin_trace() {
+    if (tracing) {
+        LOG_WRITE(LogLevel::Warning, "Tried to begin a scheduler trace, but a trace is already being recorded.");
+        return;
+    }
+
+    for (auto& stats: thread_stats) {
+        std::lock_guard lock{stats->trace_mutex};
+        stats->trace.clear();
+    }
+    trace_start.store(clock::now().time_since_epoch().count());
+    tracing.store(true, std::memory_order_release);
+}
+
+bool TaskScheduler::end_trace(std::string_view path) {
+    if (!tracing.exchange(false)) {
+        LOG_WRITE(LogLevel::Error, "Tried to end a scheduler trace, but no trace is being recorded.");
+        return false;
+    }
+
+    std::ofstream file{std::string{path}, std::ios::trunc};
+    if (!file) {
+        LOG_FORMAT(LogLevel::Error, "Could not open file {} for writing.", path);
+        return false;
+    }
+
+    SchedulerStats const summary = stats();
+    std::size_t event_count = 0;
+    bool truncated = false;
+    file << "{\"traceEvents\":[\n";
+    for (uint32_t i = 0; i < thread_stats.size(); ++i) {
+        // Metadata event naming the thread in the timeline.
+        file << fmt::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{}"}}}})", i, summary.threads[i].name);
+
+        std::vector<TraceEvent> events{};
+        {
+            std::lock_guard lock{thread_stats[i]->trace_mutex};
+            events.swap(thread_stats[i]->trace);
+        }
+        truncated = truncated || events.size() >= max_trace_events;
+        event_count += events.size();
+
+        for (TraceEvent const& event: events) {
+            file << fmt::format(",\n" R"({{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"latency_us":{:.3f}}}}})",
+                                escape_json(event.name), i, to_us(event.start), to_us(event.duration), to_us(event.latency));
+            // Queue depth as a counter track, sampled whenever a task starts.
+            file << fmt::format(",\n" R"({{"name":"queued tasks","ph":"C","pid":0,"ts":{:.3f},"args":{{"queued":{}}}}})",
+                                to_us(event.start), event.queued);
+        }
+        file << (i + 1 < thread_stats.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+
+    if (!file) {
+        LOG_FORMAT(LogLevel::Error, "Failed to write scheduler trace {}.", path);
+        return false;
+    }
+    if (truncated) {
+        LOG_FORMAT(LogLevel::Warning, "Scheduler trace was truncated, only the first {} tasks per thread were recorded.", max_trace_events);
+    }
+    LOG_FORMAT(LogLevel::Info, "Wrote {} tasks to scheduler trace {}.", event_count, path);
+    return true;
+}
+
+bool TaskScheduler::is_tracing() const {
+    return tracing.load();
 }
 
 void TaskScheduler::shutdown() {
     // Note that we don't need a lock here since terminate is atomic
     terminate = true;
-    // Notify all threads that the terminate flag is set
-    cv.notify_all();
+    // Wake up all threads so they can see the terminate flag. Threads only exit once all tasks are completed.
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+    sleep_cv.notify_all();
+    {
+        std::lock_guard lock{io_mutex};
+    }
+    io_cv.notify_all();
+    // Tasks may still schedule work on the main thread, so keep running it until everything has completed.
+    while (true) {
+        run_main_thread_tasks();
+        if (outstanding.load() == 0) { break; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
     // Join all threads to wait for tasks to be completed
-    for (std::thread& thread: threads) {
-        thread.join();
+    for (auto& worker: workers) {
+        worker->thread.join();
     }
-    threads.clear();
+    workers.clear();
+    for (std::thread& io: io_threads) {
+        io.join();
+    }
+    io_threads.clear();
     // Set stopped flag
     stopped = true;
 
     LOG_WRITE(LogLevel::Info, "Shutting down task scheduler");
 }
 
-bool TaskScheduler::is_running(task_id task, std::unique_lock<std::mutex>& lock) {
-    auto it = std::find_if(running_tasks.begin(), running_tasks.end(),
-                           [task](Task const& t) {
-                               return task == t.id;
-                           }
-    );
-    return it != running_tasks.end();
+void TaskScheduler::worker_loop(uint32_t thread_index) {
+    current_scheduler = this;
+    current_worker = thread_index;
+
+    while (true) {
+        clock::time_point const idle_start = begin_idle(thread_index);
+        uint32_t slot = no_slot;
+        // Look for work a couple of times before going to sleep, new tasks are often scheduled in quick succession.
+        for (uint32_t i = 0; i < idle_spin_count && slot == no_slot; ++i) {
+            slot = find_task(thread_index);
+            if (slot == no_slot) { std::this_thread::yield(); }
+        }
+
+        if (slot != no_slot) {
+            end_idle(thread_index, idle_start);
+            run_task(slot, thread_index);
+            continue;
+        }
+
+        std::unique_lock lock{sleep_mutex};
+        sleeping.fetch_add(1);
+        // Pairs with the fence in wake_one(). Either the thread scheduling a task sees that we are sleeping and
+        // notifies us, or we see the new task here.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        sleep_cv.wait(lock, [this, thread_index]() {
+            return has_work(thread_index) || (terminate && outstanding == 0);
+        });
+        sleeping.fetch_sub(1);
+        lock.unlock();
+        end_idle(thread_index, idle_start);
+
+        if (terminate && outstanding == 0 && !has_work(thread_index)) { break; }
+    }
+}
+
+void TaskScheduler::io_loop(uint32_t thread_index) {
+    while (true) {
+        uint32_t slot = no_slot;
+        clock::time_point const idle_start = begin_idle(thread_index);
+        {
+            std::unique_lock lock{io_mutex};
+            io_cv.wait(lock, [this]() {
+                return !io_queue.empty() || (terminate && outstanding == 0);
+            });
+            if (io_queue.empty()) { break; }
+            slot = io_queue.front();
+            io_queue.pop_front();
+        }
+        end_idle(thread_index, idle_start);
+        run_task(slot, thread_index);
+    }
+}
+
+uint32_t TaskScheduler::find_task(uint32_t thread_index) {
+    for (uint32_t priority = 0; priority < priority_count; ++priority) {
+        // Pinned tasks are usually continuations of work this thread started, so finish those first.
+        if (uint32_t slot = pop_pinned(thread_index, priority); slot != no_slot) {
+            return slot;
+        }
+        if (auto slot = workers[thread_index]->queues[priority].pop()) {
+            return *slot;
+        }
+        if (uint32_t slot = pop_injected(priority); slot != no_slot) {
+            return slot;
+        }
+        if (uint32_t slot = steal(thread_index, priority); slot != no_slot) {
+            return slot;
+        }
+    }
+    return no_slot;
+}
+
+uint32_t TaskScheduler::pop_pinned(uint32_t thread_index, uint32_t priority) {
+    Worker& worker = *workers[thread_index];
+    if (worker.pinned_size.load(std::memory_order_relaxed) == 0) { return no_slot; }
+
+    std::lock_guard lock{worker.pinned_mutex};
+    std::deque<uint32_t>& queue = worker.pinned[priority];
+    if (queue.empty()) { return no_slot; }
+    uint32_t const slot = queue.front();
+    queue.pop_front();
+    worker.pinned_size.fetch_sub(1, std::memory_order_relaxed);
+    return slot;
+}
+
+uint32_t TaskScheduler::pop_injected(uint32_t priority) {
+    if (injection_size.load(std::memory_order_relaxed) == 0) { return no_slot; }
+
+    std::lock_guard lock{injection_mutex};
+    std::deque<uint32_t>& queue = injection_queues[priority];
+    if (queue.empty()) { return no_slot; }
+    uint32_t const slot = queue.front();
+    queue.pop_front();
+    injection_size.fetch_sub(1, std::memory_order_relaxed);
+    return slot;
+}
+
+uint32_t TaskScheduler::steal(uint32_t thread_index, uint32_t priority) {
+    uint32_t const count = thread_count();
+    if (count <= 1) { return no_slot; }
+
+    // Start at a random victim so thieves don't all hammer the same worker.
+    uint32_t& state = workers[thread_index]->random_state;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    uint32_t const first = state % count;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t const victim = (first + i) % count;
+        if (victim == thread_index) { continue; }
+        if (auto slot = workers[victim]->queues[priority].steal()) {
+            return *slot;
+        }
+    }
+    return no_slot;
+}
+
+bool TaskScheduler::has_work(uint32_t thread_index) const {
+    if (injection_size.load() != 0) { return true; }
+    if (workers[thread_index]->pinned_size.load() != 0) { return true; }
+    return std::any_of(workers.begin(), workers.end(), [](auto const& worker) {
+        return std::any_of(worker->queues.begin(), worker->queues.end(), [](auto const& queue) {
+            return !queue.empty();
+        });
+    });
+}
+
+void TaskScheduler::run_task(uint32_t slot, uint32_t thread_index) {
+    Task& task = get_task(slot);
+    task.state.store(TaskState::Running);
+    uint32_t const queue_depth = queued.fetch_sub(1, std::memory_order_relaxed) - 1;
+
+    if (task.token.cancelled()) {
+        // Dropped tasks still complete, so their dependents are not blocked forever.
+        cancelled.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        execute(task, thread_index, queue_depth);
+    }
+    // Destroy the captured state now, and not when the slot is reused.
+    task.function = nullptr;
+    task.token = {};
+
+    // Mark the task as completed. Changing the generation invalidates the task's id, after this no new dependents
+    // can be added.
+    {
+        std::lock_guard lock{task.mutex};
+        task.generation.fetch_add(1);
+        task.state.store(TaskState::Free);
+    }
+
+    // Nobody else touches the list anymore, so we can read it without the lock. Clearing it instead of moving it out
+    // keeps its capacity around for the next task in this slot.
+    for (uint32_t dependent: task.dependents) {
+        if (get_task(dependent).remaining_dependencies.fetch_sub(1) == 1) {
+            enqueue(dependent);
+        }
+    }
+    task.dependents.clear();
+
+    // Pairs with the increment of waiting in wait(), see there.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load() != 0) {
+        notify_waiting();
+    }
+
+    free_slot(slot);
+    // If this was the last task and we are shutting down, every sleeping thread has to wake up to exit.
+    if (outstanding.fetch_sub(1) == 1 && terminate) {
+        {
+            std::lock_guard lock{sleep_mutex};
+        }
+        sleep_cv.notify_all();
+        {
+            std::lock_guard lock{io_mutex};
+        }
+        io_cv.notify_all();
+    }
+}
+
+void TaskScheduler::execute(Task& task, uint32_t thread_index, uint32_t queue_depth) {
+    ThreadStats& stats = *thread_stats[thread_index];
+    clock::time_point const start = clock::now();
+    uint64_t const latency = to_ns(start - task.ready_at);
+    latency_total_ns.fetch_add(latency, std::memory_order_relaxed);
+    uint64_t max_latency = latency_max_ns.load(std::memory_order_relaxed);
+    while (latency > max_latency && !latency_max_ns.compare_exchange_weak(max_latency, latency, std::memory_order_relaxed)) {}
+
+    bool const outermost = stats.depth++ == 0;
+    if (outermost) {
+        stats.outer_start = start;
+        stats.outer_idle_ns = stats.idle_ns.load(std::memory_order_relaxed);
+    }
+
+    task.function(thread_index);
+
+    clock::time_point const end = clock::now();
+    --stats.depth;
+    if (outermost) {
+        // Time spent sleeping inside wait() was already counted as idle time.
+        uint64_t const idle = stats.idle_ns.load(std::memory_order_relaxed) - stats.outer_idle_ns;
+        stats.busy_ns.fetch_add(to_ns(end - stats.outer_start) - idle, std::memory_order_relaxed);
+    }
+    stats.tasks.fetch_add(1, std::memory_order_relaxed);
+
+    if (tracing.load(std::memory_order_acquire)) {
+        clock::time_point const trace_begin{clock::duration{trace_start.load()}};
+        std::lock_guard lock{stats.trace_mutex};
+        if (stats.trace.size() < max_trace_events) {
+            stats.trace.push_back(TraceEvent{
+                .name = std::move(task.name),
+                .start = start - trace_begin,
+                .duration = end - start,
+                .latency = std::chrono::nanoseconds{latency},
+                .queued = queue_depth
+            });
+        }
+    }
+}
+
+TaskScheduler::clock::time_point TaskScheduler::begin_idle(uint32_t thread_index) {
+    clock::time_point const now = clock::now();
+    thread_stats[thread_index]->idle_since.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+    return now;
+}
+
+void TaskScheduler::end_idle(uint32_t thread_index, clock::time_point since) {
+    ThreadStats& stats = *thread_stats[thread_index];
+    stats.idle_since.store(0, std::memory_order_relaxed);
+    stats.idle_ns.fetch_add(to_ns(clock::now() - since), std::memory_order_relaxed);
+}
+
+void TaskScheduler::enqueue(uint32_t slot) {
+    Task& task = get_task(slot);
+    task.ready_at = clock::now();
+    queued.fetch_add(1, std::memory_order_relaxed);
+    uint32_t const affinity = task.affinity;
+    uint32_t const priority = static_cast<uint32_t>(task.priority);
+
+    if (affinity == main_thread) {
+        std::lock_guard lock{main_mutex};
+        main_queues[priority].push_back(slot);
+        return;
+    }
+
+    if (affinity == io_thread) {
+        {
+            std::lock_guard lock{io_mutex};
+            io_queue.push_back(slot);
+        }
+        io_cv.notify_one();
+        return;
+    }
+
+    if (affinity != any_thread) {
+        Worker& worker = *workers[affinity];
+        {
+            std::lock_guard lock{worker.pinned_mutex};
+            worker.pinned[priority].push_back(slot);
+            worker.pinned_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Only one worker can run this task, and we can't wake up a specific one.
+        wake_all();
+        return;
+    }
+
+    if (current_scheduler == this) {
+        workers[current_worker]->queues[priority].push(slot);
+    } else {
+        std::lock_guard lock{injection_mutex};
+        injection_queues[priority].push_back(slot);
+        injection_size.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_one();
+}
+
+void TaskScheduler::wake_one() {
+    // Pairs with the fence in worker_loop(), see there.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load() == 0) { return; }
+    // Taking the lock makes sure the worker is either waiting already or will see the new task in its predicate.
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+    sleep_cv.notify_one();
+}
+
+void TaskScheduler::notify_waiting() {
+    // Waiting workers sleep on sleep_cv, so wake all of them to let them recheck their task.
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+    sleep_cv.notify_all();
+    {
+        std::lock_guard lock{wait_mutex};
+    }
+    wait_cv.notify_all();
+}
+
+void TaskScheduler::wake_all() {
+    // Pairs with the fence in worker_loop(), see there.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load() == 0) { return; }
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+    sleep_cv.notify_all();
+}
+
+uint32_t TaskScheduler::allocate_slot() {
+    std::lock_guard lock{slot_mutex};
+    if (free_slots.empty()) {
+        uint32_t const chunk = chunk_count.load();
+        if (chunk == max_chunks) { return no_slot; }
+
+        chunks[chunk].store(new Task[chunk_size]);
+        chunk_count.store(chunk + 1);
+        // Push in reverse order so slots are handed out in increasing order.
+        for (uint32_t i = chunk_size; i > 0; --i) {
+            free_slots.push_back(chunk * chunk_size + i - 1);
+        }
+    }
+
+    uint32_t const slot = free_slots.back();
+    free_slots.pop_back();
+    return slot;
+}
+
+void TaskScheduler::free_slot(uint32_t slot) {
+    std::lock_guard lock{slot_mutex};
+    free_slots.push_back(slot);
+}
+
+TaskScheduler::Task& TaskScheduler::get_task(uint32_t slot) {
+    return chunks[slot / chunk_size].load()[slot % chunk_size];
+}
+
+TaskScheduler::Task* TaskScheduler::lookup(task_id task) {
+    uint32_t const slot = slot_index(task);
+    if (slot / chunk_size >= chunk_count.load()) { return nullptr; }
+    return &get_task(slot);
 }
 
-bool TaskScheduler::is_pending(task_id task, std::unique_lock<std::mutex>& lock) {
-    auto it = std::find_if(pending_tasks.begin(), pending_tasks.end(),
-                           [task](Task const& t) {
-                               return task == t.id;
-                           }
-    );
-    return it != pending_tasks.end();
+bool TaskScheduler::has_state(task_id task, TaskState state) {
+    Task* slot = lookup(task);
+    if (slot == nullptr) { return false; }
+    // Check the generation on both sides of reading the state, so we never report the state of a newer task
+    // that reused this slot.
+    if (slot->generation.load() != generation(task)) { return false; }
+    TaskState const current = slot->state.load();
+    return current == state && slot->generation.load() == generation(task);
 }
 
 } // namespace thread
-} // namespace andromeda
\ No newline at end of file
+} // namespace andromeda
@@ -0,0 +1,162 @@
+#include <andromeda/util/file_watcher.hpp>
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstddef>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace andromeda::util {
+
+#ifdef __linux__
+
+// Files are reported once they are closed after writing, or moved into place. Many tools save by writing a temporary
+// file and renaming it over the original. New directories need a watch of their own.
+static constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+FileWatcher::FileWatcher(std::vector<fs::path> const& directories) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) { return; }
+
+    for (fs::path const& directory: directories) {
+        add_watches(directory);
+    }
+    if (watches.empty()) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool FileWatcher::valid() const {
+    return fd >= 0;
+}
+
+void FileWatcher::add_watches(fs::path const& directory) {
+    std::error_code error{};
+    if (!fs::is_directory(directory, error)) { return; }
+
+    // inotify is not recursive, so every subdirectory is watched separately.
+    std::vector<fs::path> pending{directory};
+    for (auto it = fs::recursive_directory_iterator(directory, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        std::error_code entry_error{};
+        if (it->is_directory(entry_error)) {
+            pending.push_back(it->path());
+        }
+    }
+
+    for (fs::path const& path: pending) {
+        int const wd = inotify_add_watch(fd, path.c_str(), watch_mask);
+        if (wd >= 0) {
+            watches.insert_or_assign(wd, path);
+        }
+    }
+}
+
+std::vector<fs::path> FileWatcher::poll() {
+    std::vector<fs::path> changed{};
+    if (fd < 0) { return changed; }
+
+    alignas(inotify_event) std::byte buffer[4096];
+    while (true) {
+        ssize_t const size = read(fd, buffer, sizeof(buffer));
+        // EAGAIN once all events were read.
+        if (size <= 0) { break; }
+
+        for (ssize_t offset = 0; offset < size;) {
+            auto const* event = reinterpret_cast<inotify_event const*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_IGNORED) {
+                // The directory was deleted.
+                watches.erase(event->wd);
+                continue;
+            }
+            auto it = watches.find(event->wd);
+            if (it == watches.end() || event->len == 0) { continue; }
+
+            fs::path path = it->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                // Files in a new directory may have been written before the watch was added, so they are not reported.
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    add_watches(path);
+                }
+                continue;
+            }
+            // IN_CREATE is only of interest for directories, the file is reported when it is closed.
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                changed.push_back(std::move(path));
+            }
+        }
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher(std::vector<fs::path> const& directories) {
+    std::error_code error{};
+    for (fs::path const& directory: directories) {
+        if (fs::is_directory(directory, error)) {
+            roots.push_back(directory);
+        }
+    }
+    // The first scan only records the current modification times.
+    scan(nullptr);
+    last_scan = std::chrono::steady_clock::now();
+}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::valid() const {
+    return !roots.empty();
+}
+
+void FileWatcher::scan(std::vector<fs::path>* changed) {
+    std::error_code error{};
+    for (fs::path const& root: roots) {
+        for (auto it = fs::recursive_directory_iterator(root, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+            std::error_code entry_error{};
+            if (!it->is_regular_file(entry_error)) { continue; }
+
+            fs::file_time_type const time = it->last_write_time(entry_error);
+            if (entry_error) { continue; }
+            auto[entry, inserted] = write_times.try_emplace(it->path().generic_string(), time);
+            if (!inserted && entry->second != time) {
+                entry->second = time;
+                if (changed) { changed->push_back(it->path()); }
+            } else if (inserted && changed) {
+                changed->push_back(it->path());
+            }
+        }
+    }
+}
+
+std::vector<fs::path> FileWatcher::poll() {
+    std::vector<fs::path> changed{};
+    auto const now = std::chrono::steady_clock::now();
+    if (roots.empty() || now - last_scan < poll_interval) { return changed; }
+
+    last_scan = now;
+    scan(&changed);
+    return changed;
+}
+
+#endif
+
+} // namespace andromeda::util
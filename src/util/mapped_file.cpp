@@ -0,0 +1,118 @@
+#include <andromeda/util/mapped_file.hpp>
+
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace andromeda::util {
+
+MappedFile::MappedFile(std::string_view path) {
+    // Make sure the path is null-terminated before handing it to the OS.
+    std::string const path_str{path};
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path_str.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return; }
+    file_handle = file;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        release();
+        return;
+    }
+    file_size = static_cast<std::size_t>(size.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        release();
+        return;
+    }
+    mapping_handle = mapping;
+
+    memory = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (memory == nullptr) {
+        release();
+    }
+#else
+    int fd = open(path_str.c_str(), O_RDONLY);
+    if (fd < 0) { return; }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return;
+    }
+    file_size = static_cast<std::size_t>(info.st_size);
+
+    void* ptr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing the file descriptor.
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        file_size = 0;
+        return;
+    }
+    // We usually read the whole file front to back, so tell the kernel to read ahead aggressively. The advice values
+    // are not flags, so each needs a call of its own.
+    madvise(ptr, file_size, MADV_SEQUENTIAL);
+    madvise(ptr, file_size, MADV_WILLNEED);
+    memory = static_cast<std::byte const*>(ptr);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept {
+    *this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        release();
+        memory = std::exchange(rhs.memory, nullptr);
+        file_size = std::exchange(rhs.file_size, 0);
+#ifdef _WIN32
+        file_handle = std::exchange(rhs.file_handle, nullptr);
+        mapping_handle = std::exchange(rhs.mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+bool MappedFile::valid() const {
+    return memory != nullptr;
+}
+
+std::span<std::byte const> MappedFile::data() const {
+    if (!valid()) { return {}; }
+    return {memory, file_size};
+}
+
+std::size_t MappedFile::size() const {
+    return file_size;
+}
+
+void MappedFile::release() {
+#ifdef _WIN32
+    if (memory) { UnmapViewOfFile(memory); }
+    if (mapping_handle) { CloseHandle(mapping_handle); }
+    if (file_handle) { CloseHandle(file_handle); }
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+#else
+    if (memory) { munmap(const_cast<std::byte*>(memory), file_size); }
+#endif
+    memory = nullptr;
+    file_size = 0;
+}
+
+} // namespace andromeda::util
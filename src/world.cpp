@@ -1,10 +1,18 @@
 #include <andromeda/world.hpp>
 
+#include <andromeda/assets/assets.hpp>
+#include <andromeda/components/mesh_renderer.hpp>
+#include <andromeda/graphics/mesh.hpp>
 #include <andromeda/components/hierarchy.hpp>
 #include <andromeda/components/transform.hpp>
 #include <andromeda/components/name.hpp>
+#include <andromeda/components/world_transform.hpp>
 #include <reflect/reflection.hpp>
 
+#include <algorithm>
+#include <span>
+#include <type_traits>
+
 namespace andromeda {
 
 namespace detail {
@@ -22,6 +30,23 @@ struct component_copy {
         }
     }
 };
+
+template<typename C>
+struct component_merge {
+    void operator()(ecs::registry const& src, ecs::registry& dst, ecs::entity_t first) {
+        auto const& storage = src.get_storage<C>();
+        std::span<C const> components = storage.dense_components();
+        if (components.empty()) { return; }
+
+        // Staging entities are numbered from zero, so they map to first + id.
+        std::span<ecs::entity_t const> src_entities = storage.dense();
+        std::vector<ecs::entity_t> entities(src_entities.size());
+        std::transform(src_entities.begin(), src_entities.end(), entities.begin(), [first](ecs::entity_t entity) {
+            return entity + first;
+        });
+        dst.insert_components<C>(entities, std::vector<C>(components.begin(), components.end()));
+    }
+};
 }
 
 World::World() {
@@ -52,6 +77,47 @@ thread::LockedValue<ecs::registry const> World::blueprints() const {
     return {._lock = std::lock_guard{blueprint_mutex}, .value = blueprint_entities};
 }
 
+thread::LockedValue<math::BVH> World::spatial_index() {
+    return {._lock = std::lock_guard{spatial_mutex}, .value = bvh};
+}
+
+thread::LockedValue<math::BVH const> World::spatial_index() const {
+    return {._lock = std::lock_guard{spatial_mutex}, .value = bvh};
+}
+
+void World::update_spatial_index(ecs::registry const& ecs) {
+    auto index = spatial_index();
+    std::size_t indexed = 0;
+    for (auto[hierarchy, transform, renderer]: ecs.view<Hierarchy, WorldTransform, MeshRenderer>()) {
+        ecs::entity_t const entity = hierarchy.this_entity;
+        // Bounds are only known after the mesh is loaded.
+        if (!renderer.mesh || !assets::is_ready(renderer.mesh)) {
+            index->remove(entity);
+            continue;
+        }
+
+        gfx::Mesh const* mesh = assets::get(renderer.mesh);
+        // This is cheap for entities that did not move since the last update.
+        index->update(entity, math::transform_aabb(mesh->bounds, transform.local_to_world));
+        ++indexed;
+    }
+
+    // Every entity visited above is in the tree, so any other leaf belongs to an entity that was destroyed or lost one
+    // of the components. This is only searched for when the counts differ.
+    if (index->size() != indexed) {
+        std::vector<ecs::entity_t> stale{};
+        index->for_each([&ecs, &stale](ecs::entity_t entity, math::AABB const&) {
+            if (!ecs.has_component<Hierarchy>(entity) || !ecs.has_component<WorldTransform>(entity)
+                || !ecs.has_component<MeshRenderer>(entity)) {
+                stale.push_back(entity);
+            }
+        });
+        for (ecs::entity_t entity: stale) {
+            index->remove(entity);
+        }
+    }
+}
+
 ecs::entity_t World::create_entity(ecs::entity_t parent) {
     // Gain thread-safe access to the ECS.
     auto lock = this->ecs();
@@ -103,6 +169,108 @@ ecs::entity_t World::import_entity(ecs::entity_t entity, ecs::entity_t parent) {
     return import_entity_impl(this, ecs, bp, entity, parent);
 }
 
+void World::import_when_ready(Handle<ecs::entity_t> blueprint, ecs::entity_t parent, std::function<void(ecs::entity_t)> on_import) {
+    std::lock_guard lock{import_mutex};
+    pending_imports.push_back(PendingImport{
+        .blueprint = blueprint,
+        .parent = parent,
+        .on_import = std::move(on_import)
+    });
+}
+
+bool World::process_pending_imports() {
+    std::vector<PendingImport> finished{};
+    {
+        std::lock_guard lock{import_mutex};
+        // Move all imports whose blueprint is no longer loading to the end of the list, and take them out.
+        auto it = std::stable_partition(pending_imports.begin(), pending_imports.end(), [](PendingImport const& import) {
+            return assets::is_valid(import.blueprint) && !assets::is_ready(import.blueprint)
+                && !assets::load_failed(import.blueprint);
+        });
+        finished.assign(std::make_move_iterator(it), std::make_move_iterator(pending_imports.end()));
+        pending_imports.erase(it, pending_imports.end());
+    }
+
+    // Import without holding the lock, so callbacks may queue new imports.
+    bool imported = false;
+    for (PendingImport& import: finished) {
+        // The blueprint will never become ready, so the import can't happen anymore.
+        if (!assets::is_ready(import.blueprint)) {
+            LOG_WRITE(LogLevel::Warning, "Dropped an entity import, its blueprint failed to load or was unloaded");
+            continue;
+        }
+        ecs::entity_t entity = import_entity(*assets::get(import.blueprint), import.parent);
+        imported = true;
+        if (import.on_import) {
+            import.on_import(entity);
+        }
+    }
+    return imported;
+}
+
+std::vector<Handle<ecs::entity_t>> World::pending_import_blueprints() {
+    std::lock_guard lock{import_mutex};
+    std::vector<Handle<ecs::entity_t>> result{};
+    result.reserve(pending_imports.size());
+    for (PendingImport const& import: pending_imports) {
+        result.push_back(import.blueprint);
+    }
+    return result;
+}
+
+void World::release_blueprint(ecs::entity_t blueprint) {
+    auto bp = this->blueprints();
+    // Detach from the parent, so the parent doesn't refer to destroyed entities.
+    ecs::entity_t const parent = bp->get_component<Hierarchy>(blueprint).parent;
+    if (parent != ecs::no_entity) {
+        std::vector<ecs::entity_t>& siblings = bp->get_component<Hierarchy>(parent).children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), blueprint), siblings.end());
+    }
+
+    std::vector<ecs::entity_t> subtree{};
+    std::vector<ecs::entity_t> stack{blueprint};
+    while (!stack.empty()) {
+        ecs::entity_t const entity = stack.back();
+        stack.pop_back();
+        subtree.push_back(entity);
+        auto const& children = bp->get_component<Hierarchy>(entity).children;
+        stack.insert(stack.end(), children.begin(), children.end());
+    }
+    bp->destroy_entities(subtree);
+}
+
+ecs::entity_t World::merge_blueprints(ecs::registry const& staging, ecs::entity_t staging_root, ecs::entity_t parent) {
+    size_t const count = staging.get_entities().size();
+
+    auto bp = this->blueprints();
+    ecs::entity_t const first = bp->create_entities(count);
+    // Copy all components in bulk.
+    meta::for_each_component<detail::component_merge>(staging, bp.value, first);
+
+    // Translate entity references in the hierarchy and add missing components.
+    for (ecs::entity_t entity = first; entity < first + count; ++entity) {
+        auto& hierarchy = bp->get_component<Hierarchy>(entity);
+        hierarchy.this_entity = entity;
+        if (hierarchy.parent != ecs::no_entity) { hierarchy.parent += first; }
+        for (ecs::entity_t& child: hierarchy.children) {
+            child += first;
+        }
+
+        if (!bp->has_component<Transform>(entity)) {
+            bp->add_component<Transform>(entity);
+        }
+        if (!bp->has_component<Name>(entity)) {
+            bp->add_component<Name>(entity).name = "Blueprint " + std::to_string(entity);
+        }
+    }
+
+    // Attach the merged hierarchy to its new parent.
+    ecs::entity_t const root = staging_root + first;
+    bp->get_component<Hierarchy>(root).parent = parent;
+    bp->get_component<Hierarchy>(parent).children.push_back(root);
+    return root;
+}
+
 void World::initialize_entity(ecs::entity_t entity, ecs::entity_t parent) {
     auto& hierarchy = entities.add_component<Hierarchy>(entity);
     hierarchy.parent = parent;
@@ -116,6 +284,8 @@ void World::initialize_entity(ecs::entity_t entity, ecs::entity_t parent) {
 
     // Additionally, add an identity transform to every constructed entity.
     entities.add_component<Transform>(entity);
+    // The world transform is filled in by the transform propagation system each frame.
+    entities.add_component<WorldTransform>(entity);
     entities.add_component<Name>(entity).name = "Entity " + std::to_string(entity);
 }
 